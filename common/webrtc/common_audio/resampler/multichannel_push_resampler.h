@@ -0,0 +1,41 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_AUDIO_RESAMPLER_MULTICHANNEL_PUSH_RESAMPLER_H_
+#define COMMON_AUDIO_RESAMPLER_MULTICHANNEL_PUSH_RESAMPLER_H_
+
+#include <stddef.h>
+
+#include "api/array_view.h"
+
+namespace webrtc {
+
+// Push-based sample-rate converter of several channels at the same rates,
+// converting one block of a fixed size per channel at a time.
+class MultiChannelPushResampler {
+ public:
+  virtual ~MultiChannelPushResampler() {}
+
+  // Resamples each channel of |source| into the same channel of
+  // |destination|. The channels are the first source.size() of the
+  // resampler; the others keep their history for a later call.
+  // |source_frames| must always equal the source block size given at
+  // construction and |destination_capacity| must be at least the destination
+  // block size. Returns the number of samples provided in each destination
+  // channel, which is always the destination block size.
+  virtual size_t Resample(rtc::ArrayView<const float* const> source,
+                          size_t source_frames,
+                          rtc::ArrayView<float* const> destination,
+                          size_t destination_capacity) = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_AUDIO_RESAMPLER_MULTICHANNEL_PUSH_RESAMPLER_H_
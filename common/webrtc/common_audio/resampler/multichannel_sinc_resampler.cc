@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// The buffer layout and the algorithm are those of SincResampler, see
+// sinc_resampler.cc, with one input buffer per channel.
+
+#include "common_audio/resampler/multichannel_sinc_resampler.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rtc_base/checks.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"  // kSSE2, WebRtc_G...
+
+namespace webrtc {
+
+namespace {
+
+constexpr size_t kKernelSize = SincResampler::kKernelSize;
+
+}  // namespace
+
+// If we know the minimum architecture at compile time, avoid CPU detection.
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(__SSE2__)
+#define CONVOLVE_FUNC SincResampler::Convolve_SSE
+#else
+#define CONVOLVE_FUNC convolve_proc_
+#endif
+#elif defined(WEBRTC_HAS_NEON)
+#define CONVOLVE_FUNC SincResampler::Convolve_NEON
+#else
+#define CONVOLVE_FUNC SincResampler::Convolve_C
+#endif
+
+MultiChannelSincResampler::MultiChannelSincResampler(
+    double io_sample_rate_ratio,
+    size_t request_frames,
+    size_t num_channels,
+    MultiChannelSincResamplerCallback* read_cb)
+    : io_sample_rate_ratio_(io_sample_rate_ratio),
+      read_cb_(read_cb),
+      request_frames_(request_frames),
+      num_channels_(num_channels),
+      input_buffer_size_(request_frames_ + kKernelSize),
+      channel_stride_((input_buffer_size_ + 3) / 4 * 4),
+      kernel_storage_(SincResampler::GetKernel(io_sample_rate_ratio)),
+      input_buffer_(static_cast<float*>(
+          AlignedMalloc(sizeof(float) * channel_stride_ * num_channels_, 16))),
+#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+      convolve_proc_(WebRtc_GetCPUInfo(kSSE2) ? SincResampler::Convolve_SSE
+                                              : SincResampler::Convolve_C),
+#endif
+      r0_channels_(num_channels_) {
+  RTC_DCHECK_GT(request_frames_, 0);
+  RTC_DCHECK_GT(num_channels_, 0);
+  Flush();
+  RTC_DCHECK_GT(block_size_, kKernelSize);
+}
+
+MultiChannelSincResampler::~MultiChannelSincResampler() {}
+
+void MultiChannelSincResampler::UpdateRegions(bool second_load) {
+  // Setup the region offsets as in SincResampler::UpdateRegions().
+  r0_ = second_load ? kKernelSize : kKernelSize / 2;
+  r3_ = r0_ + request_frames_ - kKernelSize;
+  r4_ = r0_ + request_frames_ - kKernelSize / 2;
+  block_size_ = r4_ - kKernelSize / 2;
+  for (size_t ch = 0; ch < num_channels_; ++ch) {
+    r0_channels_[ch] = input_buffer_.get() + ch * channel_stride_ + r0_;
+  }
+}
+
+void MultiChannelSincResampler::Resample(size_t frames,
+                                         size_t num_channels,
+                                         float* const* destination) {
+  RTC_DCHECK_LE(num_channels, num_channels_);
+  size_t remaining_frames = frames;
+  size_t output_idx = 0;
+
+  // Step (1) -- Prime the input buffer at the start of the input stream.
+  if (!buffer_primed_ && remaining_frames) {
+    read_cb_->Run(request_frames_, num_channels, r0_channels_.data());
+    buffer_primed_ = true;
+  }
+
+  // Step (2) -- Resample all channels at each position of the kernels.
+  const double current_io_ratio = io_sample_rate_ratio_;
+  const float* const kernel_ptr = kernel_storage_.get();
+  const float* const r1 = input_buffer_.get();
+  while (remaining_frames) {
+    for (int i = static_cast<int>(
+             ceil((block_size_ - virtual_source_idx_) / current_io_ratio));
+         i > 0; --i) {
+      RTC_DCHECK_LT(virtual_source_idx_, block_size_);
+
+      const int source_idx = static_cast<int>(virtual_source_idx_);
+      const double subsample_remainder = virtual_source_idx_ - source_idx;
+
+      const double virtual_offset_idx =
+          subsample_remainder * SincResampler::kKernelOffsetCount;
+      const int offset_idx = static_cast<int>(virtual_offset_idx);
+
+      const float* const k1 = kernel_ptr + offset_idx * kKernelSize;
+      const float* const k2 = k1 + kKernelSize;
+      RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k1) % 16);
+      RTC_DCHECK_EQ(0, reinterpret_cast<uintptr_t>(k2) % 16);
+
+      const double kernel_interpolation_factor =
+          virtual_offset_idx - offset_idx;
+      const float* input_ptr = r1 + source_idx;
+      for (size_t ch = 0; ch < num_channels;
+           ++ch, input_ptr += channel_stride_) {
+        destination[ch][output_idx] =
+            CONVOLVE_FUNC(input_ptr, k1, k2, kernel_interpolation_factor);
+      }
+      ++output_idx;
+
+      // Advance the virtual index.
+      virtual_source_idx_ += current_io_ratio;
+
+      if (!--remaining_frames)
+        return;
+    }
+
+    // Wrap back around to the start.
+    virtual_source_idx_ -= block_size_;
+
+    // Step (3) -- Copy r3_, r4_ to r1_, r2_ in every channel.
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+      float* const channel = input_buffer_.get() + ch * channel_stride_;
+      memcpy(channel, channel + r3_, sizeof(float) * kKernelSize);
+    }
+
+    // Step (4) -- Reinitialize regions if necessary.
+    if (r0_ == kKernelSize / 2)
+      UpdateRegions(true);
+
+    // Step (5) -- Refresh the buffers with more input.
+    read_cb_->Run(request_frames_, num_channels, r0_channels_.data());
+  }
+}
+
+#undef CONVOLVE_FUNC
+
+size_t MultiChannelSincResampler::ChunkSize() const {
+  return static_cast<size_t>(block_size_ / io_sample_rate_ratio_);
+}
+
+void MultiChannelSincResampler::Flush() {
+  virtual_source_idx_ = 0;
+  buffer_primed_ = false;
+  memset(input_buffer_.get(), 0,
+         sizeof(float) * channel_stride_ * num_channels_);
+  UpdateRegions(false);
+}
+
+}  // namespace webrtc
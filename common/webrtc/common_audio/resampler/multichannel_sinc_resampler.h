@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_AUDIO_RESAMPLER_MULTICHANNEL_SINC_RESAMPLER_H_
+#define COMMON_AUDIO_RESAMPLER_MULTICHANNEL_SINC_RESAMPLER_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "common_audio/resampler/sinc_resampler.h"
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/memory/aligned_malloc.h"
+#include "rtc_base/system/arch.h"
+
+namespace webrtc {
+
+// Callback class for providing more data into the multichannel resampler.
+// Expects |frames| of data for each of the first |num_channels| channels to be
+// rendered into |destination|.
+class MultiChannelSincResamplerCallback {
+ public:
+  virtual ~MultiChannelSincResamplerCallback() {}
+  virtual void Run(size_t frames,
+                   size_t num_channels,
+                   float* const* destination) = 0;
+};
+
+// Sample-rate converter for several channels at the same rate. The channels
+// share the kernel of SincResampler::GetKernel() and the position in the
+// input, so that each pair of kernels is applied to all channels before
+// moving on to the next output sample. Every channel is resampled exactly as
+// by a SincResampler with the same ratio and request size.
+class MultiChannelSincResampler {
+ public:
+  // As for SincResampler, with |num_channels| channels to resample.
+  MultiChannelSincResampler(double io_sample_rate_ratio,
+                            size_t request_frames,
+                            size_t num_channels,
+                            MultiChannelSincResamplerCallback* read_cb);
+  ~MultiChannelSincResampler();
+
+  // Resamples |frames| of data of the first |num_channels| channels from
+  // |read_cb_| into |destination|. The input history of the channels that are
+  // left out is not updated.
+  void Resample(size_t frames, size_t num_channels, float* const* destination);
+
+  // The maximum size in frames that guarantees Resample() will only make a
+  // single call to |read_cb_| for more data.
+  size_t ChunkSize() const;
+
+  size_t request_frames() const { return request_frames_; }
+  size_t num_channels() const { return num_channels_; }
+
+  // Flush all buffered data and reset internal indices.
+  void Flush();
+
+ private:
+  void UpdateRegions(bool second_load);
+
+  // The ratio of input / output sample rates.
+  const double io_sample_rate_ratio_;
+
+  // An index on the source input buffer with sub-sample precision.
+  double virtual_source_idx_;
+
+  // The buffer is primed once at the very beginning of processing.
+  bool buffer_primed_;
+
+  // Source of data for resampling.
+  MultiChannelSincResamplerCallback* read_cb_;
+
+  // The size (in samples) to request from each |read_cb_| execution.
+  const size_t request_frames_;
+
+  const size_t num_channels_;
+
+  // The number of source frames processed per pass.
+  size_t block_size_;
+
+  // The size (in samples) of the input buffer of one channel, and the
+  // distance between the buffers of consecutive channels, which keeps each
+  // of them 16 byte aligned.
+  const size_t input_buffer_size_;
+  const size_t channel_stride_;
+
+  const std::shared_ptr<const float> kernel_storage_;
+
+  // The input buffers of all channels, one after the other.
+  std::unique_ptr<float[], AlignedFreeDeleter> input_buffer_;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+  typedef float (*ConvolveProc)(const float*,
+                                const float*,
+                                const float*,
+                                double);
+  ConvolveProc convolve_proc_;
+#endif
+
+  // The regions of SincResampler, as offsets into the buffer of each
+  // channel; r1_ is at offset 0 and r2_ at kKernelSize / 2.
+  size_t r0_;
+  size_t r3_;
+  size_t r4_;
+
+  // The start of r0_ in the buffer of every channel.
+  std::vector<float*> r0_channels_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(MultiChannelSincResampler);
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_AUDIO_RESAMPLER_MULTICHANNEL_SINC_RESAMPLER_H_
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Output sample n of a block is centered kKernelSize / 2 input samples before
+// the input position n * source_frames_ / destination_frames_, as in
+// PushSincResampler. With |input_step_| M when downsampling and |num_phases_|
+// L when upsampling, output n = m * L + p is computed from the kKernelSize
+// input samples starting at m * M - kKernelSize with the kernel of sub-sample
+// offset p / L. When downsampling, SincResampler also ends up a further
+// (source_frames - kKernelSize / 2) % M input samples behind after priming its
+// buffer, and so does this resampler. Each channel buffer keeps the last
+// |history_size_| input samples of the previous block in front of the current
+// one, so that the window of output m always starts at m * M in the buffer.
+
+#include "common_audio/resampler/polyphase_resampler.h"
+
+#include <string.h>
+
+#include "rtc_base/checks.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"  // kSSE2, WebRtc_G...
+
+namespace webrtc {
+
+// If we know the minimum architecture at compile time, avoid CPU detection.
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(__SSE2__)
+#define CONVOLVE_FUNC Convolve_SSE
+#else
+#define CONVOLVE_FUNC convolve_proc_
+#endif
+#else
+#define CONVOLVE_FUNC Convolve_C
+#endif
+
+constexpr size_t PolyphaseResampler::kKernelSize;
+
+bool PolyphaseResampler::SupportsRatio(size_t source_frames,
+                                       size_t destination_frames) {
+  if (source_frames == 0 || destination_frames == 0 ||
+      source_frames == destination_frames) {
+    return false;
+  }
+  return source_frames > destination_frames
+             ? source_frames % destination_frames == 0
+             : destination_frames % source_frames == 0;
+}
+
+PolyphaseResampler::PolyphaseResampler(size_t source_frames,
+                                       size_t destination_frames,
+                                       size_t num_channels)
+    : source_frames_(source_frames),
+      destination_frames_(destination_frames),
+      num_channels_(num_channels),
+      input_step_(source_frames > destination_frames
+                      ? source_frames / destination_frames
+                      : 1),
+      num_phases_(destination_frames > source_frames
+                      ? destination_frames / source_frames
+                      : 1),
+      kernels_(static_cast<float*>(
+          AlignedMalloc(sizeof(float) * kKernelSize * num_phases_, 16))),
+      history_size_(kKernelSize +
+                    (source_frames - kKernelSize / 2) % input_step_),
+      channel_stride_((history_size_ + source_frames + 3) / 4 * 4),
+      input_buffer_(static_cast<float*>(
+          AlignedMalloc(sizeof(float) * channel_stride_ * num_channels, 16)))
+#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+      ,
+      convolve_proc_(WebRtc_GetCPUInfo(kSSE2) ? Convolve_SSE : Convolve_C)
+#endif
+{
+  RTC_DCHECK(SupportsRatio(source_frames, destination_frames));
+  RTC_DCHECK_GE(source_frames_, history_size_);
+  RTC_DCHECK_GT(num_channels_, 0);
+  const double io_sample_rate_ratio =
+      source_frames * 1.0 / destination_frames;
+  for (size_t p = 0; p < num_phases_; ++p) {
+    SincResampler::ComputeKernel(io_sample_rate_ratio,
+                                 static_cast<float>(p) / num_phases_,
+                                 kernels_.get() + p * kKernelSize);
+  }
+  memset(input_buffer_.get(), 0,
+         sizeof(float) * channel_stride_ * num_channels_);
+}
+
+PolyphaseResampler::~PolyphaseResampler() {}
+
+size_t PolyphaseResampler::Resample(rtc::ArrayView<const float* const> source,
+                                    size_t source_frames,
+                                    rtc::ArrayView<float* const> destination,
+                                    size_t destination_capacity) {
+  RTC_CHECK_EQ(source_frames, source_frames_);
+  RTC_CHECK_GE(destination_capacity, destination_frames_);
+  RTC_DCHECK_EQ(source.size(), destination.size());
+  RTC_DCHECK_LE(source.size(), num_channels_);
+
+  const size_t num_inputs = destination_frames_ / num_phases_;
+  for (size_t ch = 0; ch < source.size(); ++ch) {
+    float* const buffer = input_buffer_.get() + ch * channel_stride_;
+    memcpy(buffer + history_size_, source[ch], source_frames_ * sizeof(float));
+
+    float* output = destination[ch];
+    for (size_t m = 0; m < num_inputs; ++m) {
+      const float* const input_ptr = buffer + m * input_step_;
+      for (size_t p = 0; p < num_phases_; ++p) {
+        *output++ = CONVOLVE_FUNC(input_ptr, kernels_.get() + p * kKernelSize);
+      }
+    }
+
+    // Keep the last input samples for the next block.
+    memcpy(buffer, buffer + source_frames_, history_size_ * sizeof(float));
+  }
+  return destination_frames_;
+}
+
+#undef CONVOLVE_FUNC
+
+float PolyphaseResampler::ConvolveForTesting(bool optimized,
+                                             const float* input_ptr,
+                                             const float* kernel) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (optimized) {
+    return Convolve_SSE(input_ptr, kernel);
+  }
+#endif
+  return Convolve_C(input_ptr, kernel);
+}
+
+float PolyphaseResampler::Convolve_C(const float* input_ptr,
+                                     const float* kernel) {
+  float sum = 0;
+  size_t n = kKernelSize;
+  while (n--) {
+    sum += *input_ptr++ * *kernel++;
+  }
+  return sum;
+}
+
+}  // namespace webrtc
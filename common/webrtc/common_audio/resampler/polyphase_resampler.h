@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_AUDIO_RESAMPLER_POLYPHASE_RESAMPLER_H_
+#define COMMON_AUDIO_RESAMPLER_POLYPHASE_RESAMPLER_H_
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "api/array_view.h"
+#include "common_audio/resampler/multichannel_push_resampler.h"
+#include "common_audio/resampler/sinc_resampler.h"
+#include "rtc_base/constructor_magic.h"
+#include "rtc_base/memory/aligned_malloc.h"
+#include "rtc_base/system/arch.h"
+
+namespace webrtc {
+
+// Push-based sample-rate converter for an integer ratio between the rates,
+// such as 48 kHz to 16 kHz or 16 kHz to 32 kHz. Every output sample is a
+// single kKernelSize tap convolution with one of a fixed set of polyphase
+// kernels, the windowed sincs of SincResampler at the exact sub-sample
+// offsets of the ratio. There is no interpolation between kernels, which
+// makes it half the work of SincResampler, and no accumulated position: when
+// downsampling and when upsampling by two the output is the same as that of
+// PushSincResampler, and otherwise it only differs by the interpolation of
+// the latter. The delay is that of PushSincResampler, see the .cc file.
+class PolyphaseResampler : public MultiChannelPushResampler {
+ public:
+  // Whether the rates of |source_frames| and |destination_frames| per block
+  // differ by an integer factor.
+  static bool SupportsRatio(size_t source_frames, size_t destination_frames);
+
+  // Provide the size of the source and destination blocks in samples, which
+  // must satisfy SupportsRatio(), and the number of channels.
+  PolyphaseResampler(size_t source_frames,
+                     size_t destination_frames,
+                     size_t num_channels);
+  ~PolyphaseResampler() override;
+
+  // Implements MultiChannelPushResampler.
+  size_t Resample(rtc::ArrayView<const float* const> source,
+                  size_t source_frames,
+                  rtc::ArrayView<float* const> destination,
+                  size_t destination_capacity) override;
+
+  size_t num_channels() const { return num_channels_; }
+
+  // Computes one output sample with the generic C convolution or, if
+  // |optimized| is true, with the SIMD one of the platform, for checking that
+  // the two agree. |kernel| must be 16 byte aligned.
+  static float ConvolveForTesting(bool optimized,
+                                  const float* input_ptr,
+                                  const float* kernel);
+
+ private:
+  static constexpr size_t kKernelSize = SincResampler::kKernelSize;
+
+  // Computes the dot product of the kKernelSize samples from |input_ptr| with
+  // |kernel|, summed in the order of SincResampler.
+  static float Convolve_C(const float* input_ptr, const float* kernel);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  static float Convolve_SSE(const float* input_ptr, const float* kernel);
+#endif
+
+  const size_t source_frames_;
+  const size_t destination_frames_;
+  const size_t num_channels_;
+
+  // The decimation factor when downsampling, otherwise 1.
+  const size_t input_step_;
+  // The number of kernels: the interpolation factor when upsampling,
+  // otherwise 1.
+  const size_t num_phases_;
+
+  // |num_phases_| kernels of kKernelSize taps back-to-back, 16 byte aligned.
+  std::unique_ptr<float[], AlignedFreeDeleter> kernels_;
+
+  // The input of each channel, after the last |history_size_| samples of the
+  // previous block. Consecutive channels are |channel_stride_| apart.
+  const size_t history_size_;
+  const size_t channel_stride_;
+  std::unique_ptr<float[], AlignedFreeDeleter> input_buffer_;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+  typedef float (*ConvolveProc)(const float*, const float*);
+  ConvolveProc convolve_proc_;
+#endif
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(PolyphaseResampler);
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_AUDIO_RESAMPLER_POLYPHASE_RESAMPLER_H_
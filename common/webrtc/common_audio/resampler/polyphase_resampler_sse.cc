@@ -0,0 +1,35 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stddef.h>
+#include <xmmintrin.h>
+
+#include "common_audio/resampler/polyphase_resampler.h"
+
+namespace webrtc {
+
+float PolyphaseResampler::Convolve_SSE(const float* input_ptr,
+                                       const float* kernel) {
+  // The lanes and the final sum are those of SincResampler::Convolve_SSE(),
+  // which gives the same result for a kernel interpolation factor of 0.
+  __m128 m_sums = _mm_setzero_ps();
+  for (size_t i = 0; i < kKernelSize; i += 4) {
+    m_sums = _mm_add_ps(
+        m_sums, _mm_mul_ps(_mm_loadu_ps(input_ptr + i),
+                           _mm_load_ps(kernel + i)));
+  }
+
+  float result;
+  m_sums = _mm_add_ps(_mm_movehl_ps(m_sums, m_sums), m_sums);
+  _mm_store_ss(&result, _mm_add_ss(m_sums, _mm_shuffle_ps(m_sums, m_sums, 1)));
+  return result;
+}
+
+}  // namespace webrtc
@@ -22,6 +22,7 @@ PushSincResampler::PushSincResampler(size_t source_frames,
     : resampler_(new SincResampler(source_frames * 1.0 / destination_frames,
                                    source_frames,
                                    this)),
+      float_buffer_(new float[destination_frames]),
       source_ptr_(nullptr),
       source_ptr_int_(nullptr),
       destination_frames_(destination_frames),
@@ -34,9 +35,6 @@ size_t PushSincResampler::Resample(const int16_t* source,
                                    size_t source_length,
                                    int16_t* destination,
                                    size_t destination_capacity) {
-  if (!float_buffer_.get())
-    float_buffer_.reset(new float[destination_frames_]);
-
   source_ptr_int_ = source;
   // Pass nullptr as the float source to have Run() read from the int16 source.
   Resample(nullptr, source_length, float_buffer_.get(), destination_frames_);
@@ -99,4 +97,62 @@ void PushSincResampler::Run(size_t frames, float* destination) {
   source_available_ -= frames;
 }
 
+MultiChannelPushSincResampler::MultiChannelPushSincResampler(
+    size_t source_frames,
+    size_t destination_frames,
+    size_t num_channels)
+    : resampler_(source_frames * 1.0 / destination_frames,
+                 source_frames,
+                 num_channels,
+                 this),
+      source_ptrs_(nullptr),
+      destination_frames_(destination_frames),
+      first_pass_(true),
+      source_available_(0) {}
+
+MultiChannelPushSincResampler::~MultiChannelPushSincResampler() {}
+
+size_t MultiChannelPushSincResampler::Resample(
+    rtc::ArrayView<const float* const> source,
+    size_t source_length,
+    rtc::ArrayView<float* const> destination,
+    size_t destination_capacity) {
+  RTC_CHECK_EQ(source_length, resampler_.request_frames());
+  RTC_CHECK_GE(destination_capacity, destination_frames_);
+  RTC_DCHECK_EQ(source.size(), destination.size());
+  RTC_DCHECK_LE(source.size(), resampler_.num_channels());
+  source_ptrs_ = source.data();
+  source_available_ = source_length;
+
+  // Prime the buffers with dummy input on the first pass, see
+  // PushSincResampler::Resample().
+  if (first_pass_)
+    resampler_.Resample(resampler_.ChunkSize(), source.size(),
+                        destination.data());
+
+  resampler_.Resample(destination_frames_, source.size(), destination.data());
+  source_ptrs_ = nullptr;
+  return destination_frames_;
+}
+
+void MultiChannelPushSincResampler::Run(size_t frames,
+                                        size_t num_channels,
+                                        float* const* destination) {
+  RTC_CHECK_EQ(source_available_, frames);
+
+  if (first_pass_) {
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+      std::memset(destination[ch], 0, frames * sizeof(*destination[ch]));
+    }
+    first_pass_ = false;
+    return;
+  }
+
+  for (size_t ch = 0; ch < num_channels; ++ch) {
+    std::memcpy(destination[ch], source_ptrs_[ch],
+                frames * sizeof(*destination[ch]));
+  }
+  source_available_ -= frames;
+}
+
 }  // namespace webrtc
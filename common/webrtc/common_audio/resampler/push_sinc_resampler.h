@@ -16,6 +16,9 @@
 
 #include <memory>
 
+#include "api/array_view.h"
+#include "common_audio/resampler/multichannel_push_resampler.h"
+#include "common_audio/resampler/multichannel_sinc_resampler.h"
 #include "common_audio/resampler/sinc_resampler.h"
 #include "rtc_base/constructor_magic.h"
 
@@ -76,6 +79,44 @@ class PushSincResampler : public SincResamplerCallback {
   RTC_DISALLOW_COPY_AND_ASSIGN(PushSincResampler);
 };
 
+// Push-based interface to MultiChannelSincResampler, with the same delay and
+// output per channel as one PushSincResampler per channel, and a single
+// kernel for all channels.
+class MultiChannelPushSincResampler : public MultiChannelPushResampler,
+                                      public MultiChannelSincResamplerCallback {
+ public:
+  // As for PushSincResampler, for up to |num_channels| channels.
+  MultiChannelPushSincResampler(size_t source_frames,
+                                size_t destination_frames,
+                                size_t num_channels);
+  ~MultiChannelPushSincResampler() override;
+
+  // Implements MultiChannelPushResampler.
+  size_t Resample(rtc::ArrayView<const float* const> source,
+                  size_t source_frames,
+                  rtc::ArrayView<float* const> destination,
+                  size_t destination_capacity) override;
+
+ protected:
+  // Implements MultiChannelSincResamplerCallback.
+  void Run(size_t frames,
+           size_t num_channels,
+           float* const* destination) override;
+
+ private:
+  MultiChannelSincResampler resampler_;
+  const float* const* source_ptrs_;
+  const size_t destination_frames_;
+
+  // True on the first call to Resample(), to prime the resampler buffers.
+  bool first_pass_;
+
+  // Used to assert we are only requested for as much data as is available.
+  size_t source_available_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(MultiChannelPushSincResampler);
+};
+
 }  // namespace webrtc
 
 #endif  // COMMON_AUDIO_RESAMPLER_PUSH_SINC_RESAMPLER_H_
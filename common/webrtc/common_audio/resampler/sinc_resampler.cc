@@ -92,6 +92,8 @@
 #include <string.h>
 
 #include <limits>
+#include <map>
+#include <mutex>
 
 #include "rtc_base/checks.h"
 #include "rtc_base/system/arch.h"
@@ -117,6 +119,21 @@ double SincScaleFactor(double io_ratio) {
   return sinc_scale_factor;
 }
 
+// Computes the kernels for |io_sample_rate_ratio| into |kernel|.
+void InitializeKernel(double io_sample_rate_ratio, float* kernel) {
+  constexpr size_t kKernelSize = SincResampler::kKernelSize;
+  constexpr size_t kKernelOffsetCount = SincResampler::kKernelOffsetCount;
+
+  // Generates a set of windowed sinc() kernels.
+  // We generate a range of sub-sample offsets from 0.0 to 1.0.
+  for (size_t offset_idx = 0; offset_idx <= kKernelOffsetCount; ++offset_idx) {
+    SincResampler::ComputeKernel(
+        io_sample_rate_ratio,
+        static_cast<float>(offset_idx) / kKernelOffsetCount,
+        kernel + offset_idx * kKernelSize);
+  }
+}
+
 }  // namespace
 
 const size_t SincResampler::kKernelSize;
@@ -152,13 +169,11 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
       read_cb_(read_cb),
       request_frames_(request_frames),
       input_buffer_size_(request_frames_ + kKernelSize),
-      // Create input buffers with a 16-byte alignment for SSE optimizations.
+      shared_kernel_storage_(GetKernel(io_sample_rate_ratio)),
       kernel_storage_(static_cast<float*>(
           AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
-      kernel_pre_sinc_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
-      kernel_window_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+      kernel_(shared_kernel_storage_.get()),
+      // Create input buffers with a 16-byte alignment for SSE optimizations.
       input_buffer_(static_cast<float*>(
           AlignedMalloc(sizeof(float) * input_buffer_size_, 16))),
 #if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
@@ -173,15 +188,6 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
   RTC_DCHECK_GT(request_frames_, 0);
   Flush();
   RTC_DCHECK_GT(block_size_, kKernelSize);
-
-  memset(kernel_storage_.get(), 0,
-         sizeof(*kernel_storage_.get()) * kKernelStorageSize);
-  memset(kernel_pre_sinc_storage_.get(), 0,
-         sizeof(*kernel_pre_sinc_storage_.get()) * kKernelStorageSize);
-  memset(kernel_window_storage_.get(), 0,
-         sizeof(*kernel_window_storage_.get()) * kKernelStorageSize);
-
-  InitializeKernel();
 }
 
 SincResampler::~SincResampler() {}
@@ -202,41 +208,49 @@ void SincResampler::UpdateRegions(bool second_load) {
   RTC_DCHECK_LT(r2_, r3_);
 }
 
-void SincResampler::InitializeKernel() {
+void SincResampler::ComputeKernel(double io_sample_rate_ratio,
+                                  float subsample_offset,
+                                  float* kernel) {
   // Blackman window parameters.
   static const double kAlpha = 0.16;
   static const double kA0 = 0.5 * (1.0 - kAlpha);
   static const double kA1 = 0.5;
   static const double kA2 = 0.5 * kAlpha;
 
-  // Generates a set of windowed sinc() kernels.
-  // We generate a range of sub-sample offsets from 0.0 to 1.0.
-  const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio_);
-  for (size_t offset_idx = 0; offset_idx <= kKernelOffsetCount; ++offset_idx) {
-    const float subsample_offset =
-        static_cast<float>(offset_idx) / kKernelOffsetCount;
-
-    for (size_t i = 0; i < kKernelSize; ++i) {
-      const size_t idx = i + offset_idx * kKernelSize;
-      const float pre_sinc = static_cast<float>(
-          M_PI * (static_cast<int>(i) - static_cast<int>(kKernelSize / 2) -
-                  subsample_offset));
-      kernel_pre_sinc_storage_[idx] = pre_sinc;
-
-      // Compute Blackman window, matching the offset of the sinc().
-      const float x = (i - subsample_offset) / kKernelSize;
-      const float window = static_cast<float>(kA0 - kA1 * cos(2.0 * M_PI * x) +
-                                              kA2 * cos(4.0 * M_PI * x));
-      kernel_window_storage_[idx] = window;
-
-      // Compute the sinc with offset, then window the sinc() function and store
-      // at the correct offset.
-      kernel_storage_[idx] = static_cast<float>(
-          window * ((pre_sinc == 0)
-                        ? sinc_scale_factor
-                        : (sin(sinc_scale_factor * pre_sinc) / pre_sinc)));
-    }
+  const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio);
+  for (size_t i = 0; i < kKernelSize; ++i) {
+    const float pre_sinc = static_cast<float>(
+        M_PI * (static_cast<int>(i) - static_cast<int>(kKernelSize / 2) -
+                subsample_offset));
+
+    // Compute Blackman window, matching the offset of the sinc().
+    const float x = (i - subsample_offset) / kKernelSize;
+    const float window = static_cast<float>(kA0 - kA1 * cos(2.0 * M_PI * x) +
+                                            kA2 * cos(4.0 * M_PI * x));
+
+    // Compute the sinc with offset, then window the sinc() function.
+    kernel[i] = static_cast<float>(
+        window * ((pre_sinc == 0)
+                      ? sinc_scale_factor
+                      : (sin(sinc_scale_factor * pre_sinc) / pre_sinc)));
+  }
+}
+
+std::shared_ptr<const float> SincResampler::GetKernel(
+    double io_sample_rate_ratio) {
+  // Never destroyed, so that resamplers in static objects can outlive it.
+  static std::mutex* const mutex = new std::mutex;
+  static auto* const kernels =
+      new std::map<double, std::shared_ptr<const float>>;
+  std::lock_guard<std::mutex> lock(*mutex);
+  std::shared_ptr<const float>& kernel = (*kernels)[io_sample_rate_ratio];
+  if (!kernel) {
+    float* storage = static_cast<float*>(
+        AlignedMalloc(sizeof(float) * kKernelStorageSize, 16));
+    InitializeKernel(io_sample_rate_ratio, storage);
+    kernel.reset(storage, AlignedFreeDeleter());
   }
+  return kernel;
 }
 
 void SincResampler::SetRatio(double io_sample_rate_ratio) {
@@ -246,22 +260,8 @@ void SincResampler::SetRatio(double io_sample_rate_ratio) {
   }
 
   io_sample_rate_ratio_ = io_sample_rate_ratio;
-
-  // Optimize reinitialization by reusing values which are independent of
-  // |sinc_scale_factor|.  Provides a 3x speedup.
-  const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio_);
-  for (size_t offset_idx = 0; offset_idx <= kKernelOffsetCount; ++offset_idx) {
-    for (size_t i = 0; i < kKernelSize; ++i) {
-      const size_t idx = i + offset_idx * kKernelSize;
-      const float window = kernel_window_storage_[idx];
-      const float pre_sinc = kernel_pre_sinc_storage_[idx];
-
-      kernel_storage_[idx] = static_cast<float>(
-          window * ((pre_sinc == 0)
-                        ? sinc_scale_factor
-                        : (sin(sinc_scale_factor * pre_sinc) / pre_sinc)));
-    }
-  }
+  InitializeKernel(io_sample_rate_ratio_, kernel_storage_.get());
+  kernel_ = kernel_storage_.get();
 }
 
 void SincResampler::Resample(size_t frames, float* destination) {
@@ -276,7 +276,7 @@ void SincResampler::Resample(size_t frames, float* destination) {
   // Step (2) -- Resample!  const what we can outside of the loop for speed.  It
   // actually has an impact on ARM performance.  See inner loop comment below.
   const double current_io_ratio = io_sample_rate_ratio_;
-  const float* const kernel_ptr = kernel_storage_.get();
+  const float* const kernel_ptr = kernel_;
   while (remaining_frames) {
     // |i| may be negative if the last Resample() call ended on an iteration
     // that put |virtual_source_idx_| over the limit.
@@ -353,6 +353,21 @@ void SincResampler::Flush() {
   UpdateRegions(false);
 }
 
+float SincResampler::ConvolveForTesting(bool optimized,
+                                        const float* input_ptr,
+                                        const float* k1,
+                                        const float* k2,
+                                        double kernel_interpolation_factor) {
+  if (optimized) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    return Convolve_SSE(input_ptr, k1, k2, kernel_interpolation_factor);
+#elif defined(WEBRTC_HAS_NEON)
+    return Convolve_NEON(input_ptr, k1, k2, kernel_interpolation_factor);
+#endif
+  }
+  return Convolve_C(input_ptr, k1, k2, kernel_interpolation_factor);
+}
+
 float SincResampler::Convolve_C(const float* input_ptr,
                                 const float* k1,
                                 const float* k2,
@@ -78,20 +78,45 @@ class SincResampler {
   void Flush();
 
   // Update |io_sample_rate_ratio_|.  SetRatio() will cause a reconstruction of
-  // the kernels used for resampling.  Not thread safe, do not call while
+  // the kernels used for resampling, into storage owned by the resampler, so
+  // it neither locks nor allocates.  Not thread safe, do not call while
   // Resample() is in progress.
   //
   // TODO(ajm): Use this in PushSincResampler rather than reconstructing
   // SincResampler.  We would also need a way to update |request_frames_|.
   void SetRatio(double io_sample_rate_ratio);
 
-  float* get_kernel_for_testing() { return kernel_storage_.get(); }
+  // Computes into |kernel| the kKernelSize taps of the windowed sinc for
+  // |io_sample_rate_ratio| shifted by |subsample_offset| in [0, 1] samples.
+  static void ComputeKernel(double io_sample_rate_ratio,
+                            float subsample_offset,
+                            float* kernel);
+
+  // Returns the kernels for |io_sample_rate_ratio|: kKernelOffsetCount + 1
+  // kernels back-to-back, 16 byte aligned. They are computed on the first
+  // request for a ratio and then shared by every resampler in the process
+  // with that ratio, and kept for the lifetime of the process. Only the
+  // constructors use it, so the cache holds one entry per ratio that
+  // resamplers are constructed with; ratios set with SetRatio() are not
+  // cached.
+  static std::shared_ptr<const float> GetKernel(double io_sample_rate_ratio);
+
+  const float* get_kernel_for_testing() const { return kernel_; }
+
+  // Computes one output sample with the generic C convolution or, if
+  // |optimized| is true, with the SIMD one of the platform, for checking that
+  // the two agree. |k1| and |k2| must be 16 byte aligned.
+  static float ConvolveForTesting(bool optimized,
+                                  const float* input_ptr,
+                                  const float* k1,
+                                  const float* k2,
+                                  double kernel_interpolation_factor);
 
  private:
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, Convolve);
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, ConvolveBenchmark);
+  friend class MultiChannelSincResampler;
 
-  void InitializeKernel();
   void UpdateRegions(bool second_load);
 
   // Selects runtime specific CPU features like SSE.  Must be called before
@@ -141,12 +166,18 @@ class SincResampler {
   // The size (in samples) of the internal buffer used by the resampler.
   const size_t input_buffer_size_;
 
+  // The kernels of the ratio given to the constructor, shared with the other
+  // resamplers of that ratio, see GetKernel().
+  std::shared_ptr<const float> shared_kernel_storage_;
+
+  // The kernels of the ratio given to SetRatio().
+  std::unique_ptr<float[], AlignedFreeDeleter> kernel_storage_;
+
   // Contains kKernelOffsetCount kernels back-to-back, each of size kKernelSize.
   // The kernel offsets are sub-sample shifts of a windowed sinc shifted from
-  // 0.0 to 1.0 sample.
-  std::unique_ptr<float[], AlignedFreeDeleter> kernel_storage_;
-  std::unique_ptr<float[], AlignedFreeDeleter> kernel_pre_sinc_storage_;
-  std::unique_ptr<float[], AlignedFreeDeleter> kernel_window_storage_;
+  // 0.0 to 1.0 sample. Points into |shared_kernel_storage_| until the first
+  // SetRatio() and into |kernel_storage_| from then on.
+  const float* kernel_;
 
   // Data from the source is copied into this buffer for each processing pass.
   std::unique_ptr<float[], AlignedFreeDeleter> input_buffer_;
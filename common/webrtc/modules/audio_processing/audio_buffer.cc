@@ -13,21 +13,21 @@
 #include <string.h>
 
 #include <cstdint>
-#include <array>
 
 
 #include "common_audio/channel_buffer.h"
 #include "common_audio/include/audio_util.h"
+#include "common_audio/resampler/polyphase_resampler.h"
 #include "common_audio/resampler/push_sinc_resampler.h"
 #include "modules/audio_processing/splitting_filter.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/denormal_disabler.h"
 
 namespace webrtc {
 namespace {
 
 constexpr size_t kSamplesPer32kHzChannel = 320;
 constexpr size_t kSamplesPer48kHzChannel = 480;
-constexpr size_t kMaxSamplesPerChannel = AudioBuffer::kMaxSampleRate / 100;
 
 size_t NumBandsFromFramesPerChannel(size_t num_frames) {
   if (num_frames == kSamplesPer32kHzChannel) {
@@ -39,6 +39,42 @@ size_t NumBandsFromFramesPerChannel(size_t num_frames) {
   return 1;
 }
 
+// Uses the polyphase resampler when the rates differ by an integer factor,
+// such as 48 kHz to 16 kHz, and the sinc resampler otherwise.
+std::unique_ptr<MultiChannelPushResampler> CreateResampler(
+    size_t source_frames,
+    size_t destination_frames,
+    size_t num_channels) {
+  if (PolyphaseResampler::SupportsRatio(source_frames, destination_frames)) {
+    return std::unique_ptr<MultiChannelPushResampler>(new PolyphaseResampler(
+        source_frames, destination_frames, num_channels));
+  }
+  return std::unique_ptr<MultiChannelPushResampler>(
+      new MultiChannelPushSincResampler(source_frames, destination_frames,
+                                        num_channels));
+}
+
+size_t NumBandsFromRate(size_t sample_rate_hz) {
+  if (sample_rate_hz == 32000) {
+    return 2;
+  }
+  if (sample_rate_hz == 48000) {
+    return 3;
+  }
+  return 1;
+}
+
+// The rate must give a whole number of frames per chunk: the resampler ratios
+// follow from the frame counts, so a truncated count, e.g. 110 frames for
+// 10 ms at 11.025 kHz, would resample the audio to a slightly wrong rate.
+// Such rates need longer chunks, see NsChunkSizeMs().
+size_t NumFramesFromRate(size_t sample_rate_hz, size_t chunk_size_ms) {
+  RTC_CHECK_EQ(0, sample_rate_hz * chunk_size_ms % 1000)
+      << "Unsupported rate " << sample_rate_hz << " Hz for " << chunk_size_ms
+      << " ms chunks";
+  return sample_rate_hz * chunk_size_ms / 1000;
+}
+
 }  // namespace
 
 AudioBuffer::AudioBuffer(size_t input_rate,
@@ -46,12 +82,19 @@ AudioBuffer::AudioBuffer(size_t input_rate,
                          size_t buffer_rate,
                          size_t buffer_num_channels,
                          size_t output_rate,
-                         size_t output_num_channels)
-    : AudioBuffer(static_cast<int>(input_rate) / 100,
+                         size_t output_num_channels,
+                         size_t chunk_size_ms)
+    : AudioBuffer(NumFramesFromRate(input_rate, chunk_size_ms),
                   input_num_channels,
-                  static_cast<int>(buffer_rate) / 100,
+                  NumFramesFromRate(buffer_rate, chunk_size_ms),
                   buffer_num_channels,
-                  static_cast<int>(output_rate) / 100) {}
+                  NumFramesFromRate(output_rate, chunk_size_ms)) {
+  // The number of bands cannot be inferred from the number of frames for
+  // chunks other than 10 ms.
+  if (NumBandsFromRate(buffer_rate) != num_bands_) {
+    SetNumBands(NumBandsFromRate(buffer_rate));
+  }
+}
 
 AudioBuffer::AudioBuffer(size_t input_num_frames,
                          size_t input_num_channels,
@@ -65,8 +108,6 @@ AudioBuffer::AudioBuffer(size_t input_num_frames,
       output_num_frames_(output_num_frames),
       output_num_channels_(0),
       num_channels_(buffer_num_channels),
-      num_bands_(NumBandsFromFramesPerChannel(buffer_num_frames_)),
-      num_split_frames_(rtc::CheckedDivExact(buffer_num_frames_, num_bands_)),
       data_(
           new ChannelBuffer<float>(buffer_num_frames_, buffer_num_channels_)) {
   RTC_DCHECK_GT(input_num_frames_, 0);
@@ -80,19 +121,26 @@ AudioBuffer::AudioBuffer(size_t input_num_frames,
   const bool output_resampling_needed =
       output_num_frames_ != buffer_num_frames_;
   if (input_resampling_needed) {
-    for (size_t i = 0; i < buffer_num_channels_; ++i) {
-      input_resamplers_.push_back(std::unique_ptr<PushSincResampler>(
-          new PushSincResampler(input_num_frames_, buffer_num_frames_)));
-    }
+    input_resampling_buffer_.reset(
+        new ChannelBuffer<float>(input_num_frames_, buffer_num_channels_));
+    input_resampler_ = CreateResampler(input_num_frames_, buffer_num_frames_,
+                                       buffer_num_channels_);
   }
 
   if (output_resampling_needed) {
-    for (size_t i = 0; i < buffer_num_channels_; ++i) {
-      output_resamplers_.push_back(std::unique_ptr<PushSincResampler>(
-          new PushSincResampler(buffer_num_frames_, output_num_frames_)));
-    }
+    output_channels_.resize(buffer_num_channels_);
+    output_resampler_ = CreateResampler(buffer_num_frames_, output_num_frames_,
+                                        buffer_num_channels_);
   }
 
+  SetNumBands(NumBandsFromFramesPerChannel(buffer_num_frames_));
+}
+
+void AudioBuffer::SetNumBands(size_t num_bands) {
+  num_bands_ = num_bands;
+  num_split_frames_ = rtc::CheckedDivExact(buffer_num_frames_, num_bands_);
+  split_data_.reset();
+  splitting_filter_.reset();
   if (num_bands_ > 1) {
     split_data_.reset(new ChannelBuffer<float>(
         buffer_num_frames_, buffer_num_channels_, num_bands_));
@@ -114,15 +162,16 @@ void AudioBuffer::set_downmixing_by_averaging() {
 }
 
 void AudioBuffer::CopyTo(AudioBuffer* buffer) const {
+  DenormalDisabler denormal_disabler;
   RTC_DCHECK_EQ(buffer->num_frames(), output_num_frames_);
 
   const bool resampling_needed = output_num_frames_ != buffer_num_frames_;
   if (resampling_needed) {
-    for (size_t i = 0; i < num_channels_; ++i) {
-      output_resamplers_[i]->Resample(data_->channels()[i], buffer_num_frames_,
-                                      buffer->channels()[i],
-                                      buffer->num_frames());
-    }
+    output_resampler_->Resample(
+        rtc::ArrayView<const float* const>(data_->channels(), num_channels_),
+        buffer_num_frames_,
+        rtc::ArrayView<float* const>(buffer->channels(), num_channels_),
+        buffer->num_frames());
   } else {
     for (size_t i = 0; i < num_channels_; ++i) {
       memcpy(buffer->channels()[i], data_->channels()[i],
@@ -154,10 +203,12 @@ void AudioBuffer::set_num_channels(size_t num_channels) {
 }
 
 void AudioBuffer::SplitIntoFrequencyBands() {
+  DenormalDisabler denormal_disabler;
   splitting_filter_->Analysis(data_.get(), split_data_.get());
 }
 
 void AudioBuffer::MergeFrequencyBands() {
+  DenormalDisabler denormal_disabler;
   splitting_filter_->Synthesis(split_data_.get(), data_.get());
 }
 
@@ -189,6 +240,7 @@ void AudioBuffer::ImportSplitChannelData(
 
 // The resampler is only for supporting 48kHz to 16kHz in the reverse stream.
 void AudioBuffer::CopyFrom(const VAFrameFlt* frame) {
+  DenormalDisabler denormal_disabler;
   RTC_DCHECK_EQ(frame->getNumChannels(), input_num_channels_);
   RTC_DCHECK_EQ(frame->getNumSamplesPerChannel(), input_num_frames_);
   RestoreNumChannels();
@@ -200,18 +252,20 @@ void AudioBuffer::CopyFrom(const VAFrameFlt* frame) {
     const float* interleaved = &afbufs[0][0];
     if (input_num_channels_ == 1) {
       if (resampling_required) {
-        input_resamplers_[0]->Resample(interleaved, input_num_frames_,
-                                       data_->channels()[0],
-                                       buffer_num_frames_);
+        input_resampler_->Resample(
+            rtc::ArrayView<const float* const>(&interleaved, 1),
+            input_num_frames_,
+            rtc::ArrayView<float* const>(data_->channels(), 1),
+            buffer_num_frames_);
         FloatToFloatS16(data_->channels()[0], buffer_num_frames_,
                                       data_->channels()[0]);
       } else {
         FloatToFloatS16(interleaved, input_num_frames_, data_->channels()[0]);
       }
     } else {
-      std::array<float, kMaxSamplesPerChannel> float_buffer;
-      float* downmixed_data =
-          resampling_required ? float_buffer.data() : data_->channels()[0];
+      float* downmixed_data = resampling_required
+                                  ? input_resampling_buffer_->channels()[0]
+                                  : data_->channels()[0];
 
       if (downmix_by_averaging_) {
         for (size_t j = 0, k = 0; j < input_num_frames_; ++j) {
@@ -229,9 +283,12 @@ void AudioBuffer::CopyFrom(const VAFrameFlt* frame) {
       }
 
       if (resampling_required) {
-        input_resamplers_[0]->Resample(downmixed_data, input_num_frames_,
-                                       data_->channels()[0],
-                                       buffer_num_frames_);
+        input_resampler_->Resample(
+            rtc::ArrayView<const float* const>(
+                input_resampling_buffer_->channels(), 1),
+            input_num_frames_,
+            rtc::ArrayView<float* const>(data_->channels(), 1),
+            buffer_num_frames_);
       }
       FloatToFloatS16(data_->channels()[0], buffer_num_frames_,
                                     data_->channels()[0]);
@@ -246,15 +303,17 @@ void AudioBuffer::CopyFrom(const VAFrameFlt* frame) {
     };
 
     if (resampling_required) {
-      std::array<float, kMaxSamplesPerChannel> float_buffer;
       for (size_t i = 0; i < num_channels_; ++i) {
         const float* interleaved = &afbufs[i][0];
         copy_channel(i, num_channels_, input_num_frames_, interleaved,
-                             float_buffer.data());
-        input_resamplers_[i]->Resample(float_buffer.data(), input_num_frames_,
-                                       data_->channels()[i],
-                                       buffer_num_frames_);
+                             input_resampling_buffer_->channels()[i]);
       }
+      input_resampler_->Resample(
+          rtc::ArrayView<const float* const>(
+              input_resampling_buffer_->channels(), num_channels_),
+          input_num_frames_,
+          rtc::ArrayView<float* const>(data_->channels(), num_channels_),
+          buffer_num_frames_);
     } else {
       for (size_t i = 0; i < num_channels_; ++i) {
         const float* interleaved = &afbufs[i][0];
@@ -265,7 +324,49 @@ void AudioBuffer::CopyFrom(const VAFrameFlt* frame) {
   }
 }
 
+void AudioBuffer::CopyFrom(const float* const* data) {
+  DenormalDisabler denormal_disabler;
+  RestoreNumChannels();
+  RTC_DCHECK_EQ(input_num_channels_, num_channels_);
+
+  const bool resampling_required = input_num_frames_ != buffer_num_frames_;
+  if (resampling_required) {
+    input_resampler_->Resample(
+        rtc::ArrayView<const float* const>(data, num_channels_),
+        input_num_frames_,
+        rtc::ArrayView<float* const>(data_->channels(), num_channels_),
+        buffer_num_frames_);
+  }
+  for (size_t i = 0; i < num_channels_; ++i) {
+    if (resampling_required) {
+      FloatToFloatS16(data_->channels()[i], buffer_num_frames_,
+                      data_->channels()[i]);
+    } else {
+      FloatToFloatS16(data[i], input_num_frames_, data_->channels()[i]);
+    }
+  }
+}
+
+void AudioBuffer::CopyTo(float* const* data) const {
+  DenormalDisabler denormal_disabler;
+  const bool resampling_required = buffer_num_frames_ != output_num_frames_;
+  if (resampling_required) {
+    output_resampler_->Resample(
+        rtc::ArrayView<const float* const>(data_->channels(), num_channels_),
+        buffer_num_frames_, rtc::ArrayView<float* const>(data, num_channels_),
+        output_num_frames_);
+  }
+  for (size_t i = 0; i < num_channels_; ++i) {
+    if (resampling_required) {
+      FloatS16ToFloat(data[i], output_num_frames_, data[i]);
+    } else {
+      FloatS16ToFloat(data_->channels()[i], buffer_num_frames_, data[i]);
+    }
+  }
+}
+
 void AudioBuffer::CopyTo(VAFrameFlt* frame) const {
+  DenormalDisabler denormal_disabler;
   RTC_DCHECK(frame->getNumChannels() == num_channels_ || num_channels_ == 1);
   RTC_DCHECK_EQ(frame->getNumSamplesPerChannel(), output_num_frames_);
 
@@ -273,14 +374,18 @@ void AudioBuffer::CopyTo(VAFrameFlt* frame) const {
 
   AudioFileFlt::AudioBuffer &afbufs = frame->buf;
   if (num_channels_ == 1) {
-    std::array<float, kMaxSamplesPerChannel> float_buffer;
-
+    // When resampling, the first output channel holds the resampled data
+    // until it is converted in place.
     if (resampling_required) {
-      output_resamplers_[0]->Resample(data_->channels()[0], buffer_num_frames_,
-                                      float_buffer.data(), output_num_frames_);
+      output_channels_[0] = &afbufs[0][0];
+      output_resampler_->Resample(
+          rtc::ArrayView<const float* const>(data_->channels(), 1),
+          buffer_num_frames_,
+          rtc::ArrayView<float* const>(output_channels_.data(), 1),
+          output_num_frames_);
     }
     const float* deinterleaved =
-        resampling_required ? float_buffer.data() : data_->channels()[0];
+        resampling_required ? &afbufs[0][0] : data_->channels()[0];
 
     if (frame->getNumChannels() == 1) {
       float* interleaved = &afbufs[0][0];
@@ -305,14 +410,18 @@ void AudioBuffer::CopyTo(VAFrameFlt* frame) const {
     };
 
     if (resampling_required) {
+      for (size_t i = 0; i < num_channels_; ++i) {
+        output_channels_[i] = &afbufs[i][0];
+      }
+      output_resampler_->Resample(
+          rtc::ArrayView<const float* const>(data_->channels(), num_channels_),
+          buffer_num_frames_,
+          rtc::ArrayView<float* const>(output_channels_.data(), num_channels_),
+          output_num_frames_);
       for (size_t i = 0; i < num_channels_; ++i) {
         float* interleaved = &afbufs[i][0];
-        std::array<float, kMaxSamplesPerChannel> float_buffer;
-        output_resamplers_[i]->Resample(data_->channels()[i],
-                                        buffer_num_frames_, float_buffer.data(),
-                                        output_num_frames_);
         copy_channel(i, frame->getNumChannels(), output_num_frames_,
-                           float_buffer.data(), interleaved);
+                           interleaved, interleaved);
       }
     } else {
       for (size_t i = 0; i < num_channels_; ++i) {
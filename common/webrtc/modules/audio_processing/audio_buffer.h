@@ -21,7 +21,7 @@
 #include "VAFrame/VAFrame.h"
 
 namespace webrtc {
-class PushSincResampler;
+class MultiChannelPushResampler;
 class SplittingFilter;
 
 enum Band { kBand0To8kHz = 0, kBand8To16kHz = 1, kBand16To24kHz = 2 };
@@ -31,14 +31,20 @@ enum Band { kBand0To8kHz = 0, kBand8To16kHz = 1, kBand16To24kHz = 2 };
 // operate on it in a controlled manner.
 class AudioBuffer {
  public:
+  // Number of samples per band for the default 10 ms chunks.
   static const int kSplitBandSize = 160;
   static const size_t kMaxSampleRate = 384000;
+  static const size_t kDefaultChunkSizeMs = 10;
+
+  // Creates a buffer holding |chunk_size_ms| of audio per channel. Chunks
+  // shorter than 10 ms are used by the low-latency noise suppressor.
   AudioBuffer(size_t input_rate,
               size_t input_num_channels,
               size_t buffer_rate,
               size_t buffer_num_channels,
               size_t output_rate,
-              size_t output_num_channels);
+              size_t output_num_channels,
+              size_t chunk_size_ms = kDefaultChunkSizeMs);
 
   // The constructor below will be deprecated.
   AudioBuffer(size_t input_num_frames,
@@ -110,10 +116,19 @@ class AudioBuffer {
   // Copies data into the buffer.
   void CopyFrom(const VAFrameFlt *frame);
 
+  // Copies deinterleaved float data in [-1, 1] into the buffer, resampling it
+  // from the input rate. |data| holds one pointer per input channel, and the
+  // input must have as many channels as the buffer.
+  void CopyFrom(const float* const* data);
+
   // Copies data from the buffer.
   void CopyTo(AudioBuffer *buffer) const;
   void CopyTo(VAFrameFlt *frame) const;
 
+  // Copies the buffer data to deinterleaved float data in [-1, 1] at the
+  // output rate. |data| holds one pointer per buffer channel.
+  void CopyTo(float* const* data) const;
+
   // Splits the buffer data into frequency bands.
   void SplitIntoFrequencyBands();
 
@@ -145,6 +160,8 @@ class AudioBuffer {
  private:
   FRIEND_TEST_ALL_PREFIXES(AudioBufferTest,
                            SetNumChannelsSetsChannelBuffersNumChannels);
+  // Sets the number of bands and allocates the band-split data.
+  void SetNumBands(size_t num_bands);
   void RestoreNumChannels();
 
   const size_t input_num_frames_;
@@ -161,8 +178,15 @@ class AudioBuffer {
   std::unique_ptr<ChannelBuffer<float>> data_;
   std::unique_ptr<ChannelBuffer<float>> split_data_;
   std::unique_ptr<SplittingFilter> splitting_filter_;
-  std::vector<std::unique_ptr<PushSincResampler>> input_resamplers_;
-  std::vector<std::unique_ptr<PushSincResampler>> output_resamplers_;
+  // One resampler for all channels in each direction: polyphase for integer
+  // rate ratios, sinc otherwise.
+  std::unique_ptr<MultiChannelPushResampler> input_resampler_;
+  std::unique_ptr<MultiChannelPushResampler> output_resampler_;
+  // Holds the input channels before resampling, so that no frame-sized buffer
+  // is needed on the stack.
+  std::unique_ptr<ChannelBuffer<float>> input_resampling_buffer_;
+  // The output channels of a frame being resampled into.
+  mutable std::vector<float*> output_channels_;
   bool downmix_by_averaging_ = true;
   size_t channel_for_downmixing_ = 0;
 };
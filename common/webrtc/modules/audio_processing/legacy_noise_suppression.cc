@@ -12,6 +12,7 @@
 
 #include "modules/audio_processing/audio_buffer.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/denormal_disabler.h"
 #if defined(WEBRTC_NS_FLOAT)
 #include "modules/audio_processing/legacy_ns/noise_suppression.h"
 
@@ -84,6 +85,7 @@ NoiseSuppression::~NoiseSuppression() {}
 void NoiseSuppression::AnalyzeCaptureAudio(AudioBuffer* audio) {
   RTC_DCHECK(audio);
 #if defined(WEBRTC_NS_FLOAT)
+  DenormalDisabler denormal_disabler;
   RTC_DCHECK_GE(160, audio->num_frames_per_band());
   RTC_DCHECK_EQ(suppressors_.size(), audio->num_channels());
   for (size_t i = 0; i < suppressors_.size(); i++) {
@@ -95,6 +97,7 @@ void NoiseSuppression::AnalyzeCaptureAudio(AudioBuffer* audio) {
 
 void NoiseSuppression::ProcessCaptureAudio(AudioBuffer* audio) {
   RTC_DCHECK(audio);
+  DenormalDisabler denormal_disabler;
   RTC_DCHECK_GE(160, audio->num_frames_per_band());
   RTC_DCHECK_EQ(suppressors_.size(), audio->num_channels());
   for (size_t i = 0; i < suppressors_.size(); i++) {
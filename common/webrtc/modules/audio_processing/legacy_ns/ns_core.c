@@ -19,6 +19,8 @@
 #include "modules/audio_processing/legacy_ns/ns_core.h"
 #include "modules/audio_processing/legacy_ns/windows_private.h"
 
+static void InitFunctions(void);
+
 // Set Feature Extraction Parameters.
 static void set_feature_extraction_parameters(NoiseSuppressionC* self) {
   // Bin size of histogram.
@@ -211,14 +213,17 @@ int WebRtcNs_InitCore(NoiseSuppressionC* self, uint32_t fs) {
   // Default mode.
   WebRtcNs_set_policy_core(self, 0);
 
+  // Initialize function pointers.
+  InitFunctions();
+
   self->initFlag = 1;
   return 0;
 }
 
 // Estimate noise.
-static void NoiseEstimation(NoiseSuppressionC* self,
-                            float* magn,
-                            float* noise) {
+static void NoiseEstimationC(NoiseSuppressionC* self,
+                             float* magn,
+                             float* noise) {
   size_t i, s, offset;
   float lmagn[HALF_ANAL_BLOCKL], delta;
 
@@ -522,8 +527,8 @@ static void FeatureParameterExtraction(NoiseSuppressionC* self, int flag) {
 // Compute spectral flatness on input spectrum.
 // |magnIn| is the magnitude spectrum.
 // Spectral flatness is returned in self->featureData[0].
-static void ComputeSpectralFlatness(NoiseSuppressionC* self,
-                                    const float* magnIn) {
+static void ComputeSpectralFlatnessC(NoiseSuppressionC* self,
+                                     const float* magnIn) {
   size_t i;
   size_t shiftLP = 1;  // Option to remove first bin(s) from spectral measures.
   float avgSpectralFlatnessNum, avgSpectralFlatnessDen, spectralTmp;
@@ -565,11 +570,11 @@ static void ComputeSpectralFlatness(NoiseSuppressionC* self,
 // Outputs:
 //   * |snrLocPrior| is the computed prior SNR.
 //   * |snrLocPost| is the computed post SNR.
-static void ComputeSnr(const NoiseSuppressionC* self,
-                       const float* magn,
-                       const float* noise,
-                       float* snrLocPrior,
-                       float* snrLocPost) {
+static void ComputeSnrC(const NoiseSuppressionC* self,
+                        const float* magn,
+                        const float* noise,
+                        float* snrLocPrior,
+                        float* snrLocPost) {
   size_t i;
 
   for (i = 0; i < self->magnLen; i++) {
@@ -594,8 +599,8 @@ static void ComputeSnr(const NoiseSuppressionC* self,
 // |magnIn| is the input spectrum.
 // The reference/template spectrum is self->magnAvgPause[i].
 // Returns (normalized) spectral difference in self->featureData[4].
-static void ComputeSpectralDifference(NoiseSuppressionC* self,
-                                      const float* magnIn) {
+static void ComputeSpectralDifferenceC(NoiseSuppressionC* self,
+                                       const float* magnIn) {
   // avgDiffNormMagn = var(magnIn) - cov(magnIn, magnAvgPause)^2 /
   // var(magnAvgPause)
   size_t i;
@@ -635,22 +640,14 @@ static void ComputeSpectralDifference(NoiseSuppressionC* self,
       SPECT_DIFF_TAVG * (avgDiffNormMagn - self->featureData[4]);
 }
 
-// Compute speech/noise probability.
-// Speech/noise probability is returned in |probSpeechFinal|.
-// |magn| is the input magnitude spectrum.
-// |noise| is the noise spectrum.
-// |snrLocPrior| is the prior SNR for each frequency.
-// |snrLocPost| is the post SNR for each frequency.
-static void SpeechNoiseProb(NoiseSuppressionC* self,
-                            float* probSpeechFinal,
-                            const float* snrLocPrior,
-                            const float* snrLocPost) {
-  size_t i;
+// Updates the prior speech probability from the features in
+// self->featureData and returns the gain that combines it with the LRT of each
+// frequency into the speech probability.
+float WebRtcNs_UpdatePriorSpeechProb(NoiseSuppressionC* self) {
   int sgnMap;
-  float invLrt, gainPrior, indPrior;
-  float logLrtTimeAvgKsum, besselTmp;
+  float indPrior;
   float indicator0, indicator1, indicator2;
-  float tmpFloat1, tmpFloat2;
+  float tmpFloat1;
   float weightIndPrior0, weightIndPrior1, weightIndPrior2;
   float threshPrior0, threshPrior1, threshPrior2;
   float widthPrior, widthPrior0, widthPrior1, widthPrior2;
@@ -673,32 +670,17 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
   weightIndPrior1 = self->priorModelPars[5];
   weightIndPrior2 = self->priorModelPars[6];
 
-  // Compute feature based on average LR factor.
-  // This is the average over all frequencies of the smooth log LRT.
-  logLrtTimeAvgKsum = 0.0;
-  for (i = 0; i < self->magnLen; i++) {
-    tmpFloat1 = 1.f + 2.f * snrLocPrior[i];
-    tmpFloat2 = 2.f * snrLocPrior[i] / (tmpFloat1 + 0.0001f);
-    besselTmp = (snrLocPost[i] + 1.f) * tmpFloat2;
-    self->logLrtTimeAvg[i] +=
-        LRT_TAVG * (besselTmp - (float)log(tmpFloat1) - self->logLrtTimeAvg[i]);
-    logLrtTimeAvgKsum += self->logLrtTimeAvg[i];
-  }
-  logLrtTimeAvgKsum = (float)logLrtTimeAvgKsum / (self->magnLen);
-  self->featureData[3] = logLrtTimeAvgKsum;
-  // Done with computation of LR factor.
-
   // Compute the indicator functions.
   // Average LRT feature.
   widthPrior = widthPrior0;
   // Use larger width in tanh map for pause regions.
-  if (logLrtTimeAvgKsum < threshPrior0) {
+  if (self->featureData[3] < threshPrior0) {
     widthPrior = widthPrior1;
   }
   // Compute indicator function: sigmoid map.
   indicator0 =
       0.5f *
-      ((float)tanh(widthPrior * (logLrtTimeAvgKsum - threshPrior0)) + 1.f);
+      ((float)tanh(widthPrior * (self->featureData[3] - threshPrior0)) + 1.f);
 
   // Spectral flatness feature.
   tmpFloat1 = self->featureData[0];
@@ -742,8 +724,40 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
     self->priorSpeechProb = 0.01f;
   }
 
+  return (1.f - self->priorSpeechProb) / (self->priorSpeechProb + 0.0001f);
+}
+
+// Compute speech/noise probability.
+// Speech/noise probability is returned in |probSpeechFinal|.
+// |snrLocPrior| is the prior SNR for each frequency.
+// |snrLocPost| is the post SNR for each frequency.
+static void SpeechNoiseProbC(NoiseSuppressionC* self,
+                             float* probSpeechFinal,
+                             const float* snrLocPrior,
+                             const float* snrLocPost) {
+  size_t i;
+  float invLrt, gainPrior;
+  float logLrtTimeAvgKsum, besselTmp;
+  float tmpFloat1, tmpFloat2;
+
+  // Compute feature based on average LR factor.
+  // This is the average over all frequencies of the smooth log LRT.
+  logLrtTimeAvgKsum = 0.0;
+  for (i = 0; i < self->magnLen; i++) {
+    tmpFloat1 = 1.f + 2.f * snrLocPrior[i];
+    tmpFloat2 = 2.f * snrLocPrior[i] / (tmpFloat1 + 0.0001f);
+    besselTmp = (snrLocPost[i] + 1.f) * tmpFloat2;
+    self->logLrtTimeAvg[i] +=
+        LRT_TAVG * (besselTmp - (float)log(tmpFloat1) - self->logLrtTimeAvg[i]);
+    logLrtTimeAvgKsum += self->logLrtTimeAvg[i];
+  }
+  logLrtTimeAvgKsum = (float)logLrtTimeAvgKsum / (self->magnLen);
+  self->featureData[3] = logLrtTimeAvgKsum;
+  // Done with computation of LR factor.
+
+  gainPrior = WebRtcNs_UpdatePriorSpeechProb(self);
+
   // Final speech probability: combine prior model with LR factor:.
-  gainPrior = (1.f - self->priorSpeechProb) / (self->priorSpeechProb + 0.0001f);
   for (i = 0; i < self->magnLen; i++) {
     invLrt = (float)exp(-self->logLrtTimeAvg[i]);
     invLrt = (float)gainPrior * invLrt;
@@ -759,9 +773,9 @@ static void FeatureUpdate(NoiseSuppressionC* self,
                           const float* magn,
                           int updateParsFlag) {
   // Compute spectral flatness on input spectrum.
-  ComputeSpectralFlatness(self, magn);
+  WebRtcNs_ComputeSpectralFlatness(self, magn);
   // Compute difference of input spectrum with learned/estimated noise spectrum.
-  ComputeSpectralDifference(self, magn);
+  WebRtcNs_ComputeSpectralDifference(self, magn);
   // Compute histograms for parameter decisions (thresholds and weights for
   // features).
   // Parameters are extracted once every window time.
@@ -800,11 +814,11 @@ static void FeatureUpdate(NoiseSuppressionC* self,
 //   * |snrLocPost| is the post SNR.
 // Output:
 //   * |noise| is the updated noise magnitude spectrum estimate.
-static void UpdateNoiseEstimate(NoiseSuppressionC* self,
-                                const float* magn,
-                                const float* snrLocPrior,
-                                const float* snrLocPost,
-                                float* noise) {
+static void UpdateNoiseEstimateC(NoiseSuppressionC* self,
+                                 const float* magn,
+                                 const float* snrLocPrior,
+                                 const float* snrLocPost,
+                                 float* noise) {
   size_t i;
   float probSpeech, probNonSpeech;
   // Time-avg parameter for noise update.
@@ -951,7 +965,7 @@ static void IFFT(NoiseSuppressionC* self,
 //   * |buffer| is the buffer over which the energy is calculated.
 //   * |length| is the length of the buffer.
 // Returns the calculated energy.
-static float Energy(const float* buffer, size_t length) {
+static float EnergyC(const float* buffer, size_t length) {
   size_t i;
   float energy = 0.f;
 
@@ -969,10 +983,10 @@ static float Energy(const float* buffer, size_t length) {
 //   * |length| is the length of the window and data.
 // Output:
 //   * |data_windowed| is the windowed data.
-static void Windowing(const float* window,
-                      const float* data,
-                      size_t length,
-                      float* data_windowed) {
+static void WindowingC(const float* window,
+                       const float* data,
+                       size_t length,
+                       float* data_windowed) {
   size_t i;
 
   for (i = 0; i < length; ++i) {
@@ -985,9 +999,9 @@ static void Windowing(const float* window,
 //   * |magn| is the signal magnitude spectrum estimate.
 // Output:
 //   * |theFilter| is the frequency response of the computed Wiener filter.
-static void ComputeDdBasedWienerFilter(const NoiseSuppressionC* self,
-                                       const float* magn,
-                                       float* theFilter) {
+static void ComputeDdBasedWienerFilterC(const NoiseSuppressionC* self,
+                                        const float* magn,
+                                        float* theFilter) {
   size_t i;
   float snrPrior, previousEstimateStsa, currentEstimateStsa;
 
@@ -1009,6 +1023,59 @@ static void ComputeDdBasedWienerFilter(const NoiseSuppressionC* self,
   }  // End of loop over frequencies.
 }
 
+// Declare function pointers.
+NsNoiseEstimation WebRtcNs_NoiseEstimation;
+NsComputeSpectralFlatness WebRtcNs_ComputeSpectralFlatness;
+NsComputeSnr WebRtcNs_ComputeSnr;
+NsComputeSpectralDifference WebRtcNs_ComputeSpectralDifference;
+NsSpeechNoiseProb WebRtcNs_SpeechNoiseProb;
+NsUpdateNoiseEstimate WebRtcNs_UpdateNoiseEstimate;
+NsComputeDdBasedWienerFilter WebRtcNs_ComputeDdBasedWienerFilter;
+NsWindowing WebRtcNs_Windowing;
+NsEnergy WebRtcNs_Energy;
+
+// Whether the SIMD functions are selected where available.
+static int simd_enabled = 1;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+// Initialize function pointers for x86 platforms with SSE2.
+static void WebRtcNs_InitSse2(void) {
+  WebRtcNs_NoiseEstimation = WebRtcNs_NoiseEstimationSse2;
+  WebRtcNs_ComputeSpectralFlatness = WebRtcNs_ComputeSpectralFlatnessSse2;
+  WebRtcNs_ComputeSnr = WebRtcNs_ComputeSnrSse2;
+  WebRtcNs_ComputeSpectralDifference = WebRtcNs_ComputeSpectralDifferenceSse2;
+  WebRtcNs_SpeechNoiseProb = WebRtcNs_SpeechNoiseProbSse2;
+  WebRtcNs_UpdateNoiseEstimate = WebRtcNs_UpdateNoiseEstimateSse2;
+  WebRtcNs_ComputeDdBasedWienerFilter =
+      WebRtcNs_ComputeDdBasedWienerFilterSse2;
+  WebRtcNs_Windowing = WebRtcNs_WindowingSse2;
+  WebRtcNs_Energy = WebRtcNs_EnergySse2;
+}
+#endif
+
+static void InitFunctions(void) {
+  WebRtcNs_NoiseEstimation = NoiseEstimationC;
+  WebRtcNs_ComputeSpectralFlatness = ComputeSpectralFlatnessC;
+  WebRtcNs_ComputeSnr = ComputeSnrC;
+  WebRtcNs_ComputeSpectralDifference = ComputeSpectralDifferenceC;
+  WebRtcNs_SpeechNoiseProb = SpeechNoiseProbC;
+  WebRtcNs_UpdateNoiseEstimate = UpdateNoiseEstimateC;
+  WebRtcNs_ComputeDdBasedWienerFilter = ComputeDdBasedWienerFilterC;
+  WebRtcNs_Windowing = WindowingC;
+  WebRtcNs_Energy = EnergyC;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  if (simd_enabled) {
+    WebRtcNs_InitSse2();
+  }
+#endif
+}
+
+void WebRtcNs_EnableSimd(int enable) {
+  simd_enabled = enable;
+  InitFunctions();
+}
+
 // Changes the aggressiveness of the noise suppression method.
 // |mode| = 0 is mild (6dB), |mode| = 1 is medium (10dB) and |mode| = 2 is
 // aggressive (15dB).
@@ -1070,8 +1137,8 @@ void WebRtcNs_AnalyzeCore(NoiseSuppressionC* self, const float* speechFrame) {
   // Update analysis buffer for L band.
   UpdateBuffer(speechFrame, self->blockLen, self->anaLen, self->analyzeBuf);
 
-  Windowing(self->window, self->analyzeBuf, self->anaLen, winData);
-  energy = Energy(winData, self->anaLen);
+  WebRtcNs_Windowing(self->window, self->analyzeBuf, self->anaLen, winData);
+  energy = WebRtcNs_Energy(winData, self->anaLen);
   if (energy == 0.0) {
     // We want to avoid updating statistics in this case:
     // Updating feature statistics when we have zeros only will cause
@@ -1108,7 +1175,7 @@ void WebRtcNs_AnalyzeCore(NoiseSuppressionC* self, const float* speechFrame) {
   self->sumMagn = sumMagn;
 
   // Quantile noise estimate.
-  NoiseEstimation(self, magn, noise);
+  WebRtcNs_NoiseEstimation(self, magn, noise);
   // Compute simplified noise model during startup.
   if (self->blockInd < END_STARTUP_SHORT) {
     // Estimate White noise.
@@ -1173,11 +1240,11 @@ void WebRtcNs_AnalyzeCore(NoiseSuppressionC* self, const float* speechFrame) {
   }
 
   // Post and prior SNR needed for SpeechNoiseProb.
-  ComputeSnr(self, magn, noise, snrLocPrior, snrLocPost);
+  WebRtcNs_ComputeSnr(self, magn, noise, snrLocPrior, snrLocPost);
 
   FeatureUpdate(self, magn, updateParsFlag);
-  SpeechNoiseProb(self, self->speechProb, snrLocPrior, snrLocPost);
-  UpdateNoiseEstimate(self, magn, snrLocPrior, snrLocPost, noise);
+  WebRtcNs_SpeechNoiseProb(self, self->speechProb, snrLocPrior, snrLocPost);
+  WebRtcNs_UpdateNoiseEstimate(self, magn, snrLocPrior, snrLocPost, noise);
 
   // Keep track of noise spectrum for next frame.
   memcpy(self->noise, noise, sizeof(*noise) * self->magnLen);
@@ -1238,8 +1305,8 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
     }
   }
 
-  Windowing(self->window, self->dataBuf, self->anaLen, winData);
-  energy1 = Energy(winData, self->anaLen);
+  WebRtcNs_Windowing(self->window, self->dataBuf, self->anaLen, winData);
+  energy1 = WebRtcNs_Energy(winData, self->anaLen);
   if (energy1 == 0.0 || self->signalEnergy == 0) {
     // Synthesize the special case of zero input.
     // Read out fully processed segment.
@@ -1275,7 +1342,7 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
     }
   }
 
-  ComputeDdBasedWienerFilter(self, magn, theFilter);
+  WebRtcNs_ComputeDdBasedWienerFilter(self, magn, theFilter);
 
   for (i = 0; i < self->magnLen; i++) {
     // Flooring bottom.
@@ -1321,7 +1388,7 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
     factor1 = 1.f;
     factor2 = 1.f;
 
-    energy2 = Energy(winData, self->anaLen);
+    energy2 = WebRtcNs_Energy(winData, self->anaLen);
     gain = (float)sqrt(energy2 / (energy1 + 1.f));
 
     // Scaling for new version.
@@ -1345,7 +1412,7 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
              (1.f - self->priorSpeechProb) * factor2;
   }  // Out of self->gainmap == 1.
 
-  Windowing(self->window, winData, self->anaLen, winData);
+  WebRtcNs_Windowing(self->window, winData, self->anaLen, winData);
 
   // Synthesis.
   for (i = 0; i < self->anaLen; i++) {
@@ -11,7 +11,11 @@
 #ifndef MODULES_AUDIO_PROCESSING_LEGACY_NS_NS_CORE_H_
 #define MODULES_AUDIO_PROCESSING_LEGACY_NS_NS_CORE_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "modules/audio_processing/legacy_ns/defines.h"
+#include "rtc_base/system/arch.h"
 
 typedef struct NSParaExtract_ {
   // Bin size of histogram.
@@ -182,6 +186,117 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
                           size_t num_bands,
                           float* const* outFrame);
 
+/****************************************************************************
+ * WebRtcNs_EnableSimd
+ *
+ * Selects the SIMD versions of the per-frequency functions below where they
+ * are available (the default), or the generic C versions if |enable| is 0.
+ * The selection is shared by all instances. Intended for testing.
+ */
+void WebRtcNs_EnableSimd(int enable);
+
+/****************************************************************************
+ * Some function pointers, for internal functions shared by SSE2 and generic C
+ * code. They are set by WebRtcNs_InitCore().
+ */
+// Quantile noise estimation.
+typedef void (*NsNoiseEstimation)(NoiseSuppressionC* self,
+                                  float* magn,
+                                  float* noise);
+extern NsNoiseEstimation WebRtcNs_NoiseEstimation;
+
+// Spectral flatness feature, updated in self->featureData[0].
+typedef void (*NsComputeSpectralFlatness)(NoiseSuppressionC* self,
+                                          const float* magnIn);
+extern NsComputeSpectralFlatness WebRtcNs_ComputeSpectralFlatness;
+
+// Prior and post SNR of each frequency.
+typedef void (*NsComputeSnr)(const NoiseSuppressionC* self,
+                             const float* magn,
+                             const float* noise,
+                             float* snrLocPrior,
+                             float* snrLocPost);
+extern NsComputeSnr WebRtcNs_ComputeSnr;
+
+// Spectral difference feature, updated in self->featureData[4].
+typedef void (*NsComputeSpectralDifference)(NoiseSuppressionC* self,
+                                            const float* magnIn);
+extern NsComputeSpectralDifference WebRtcNs_ComputeSpectralDifference;
+
+// Speech probability of each frequency.
+typedef void (*NsSpeechNoiseProb)(NoiseSuppressionC* self,
+                                  float* probSpeechFinal,
+                                  const float* snrLocPrior,
+                                  const float* snrLocPost);
+extern NsSpeechNoiseProb WebRtcNs_SpeechNoiseProb;
+
+// Noise spectrum update from the speech probability.
+typedef void (*NsUpdateNoiseEstimate)(NoiseSuppressionC* self,
+                                      const float* magn,
+                                      const float* snrLocPrior,
+                                      const float* snrLocPost,
+                                      float* noise);
+extern NsUpdateNoiseEstimate WebRtcNs_UpdateNoiseEstimate;
+
+// Decision-directed Wiener filter.
+typedef void (*NsComputeDdBasedWienerFilter)(const NoiseSuppressionC* self,
+                                             const float* magn,
+                                             float* theFilter);
+extern NsComputeDdBasedWienerFilter WebRtcNs_ComputeDdBasedWienerFilter;
+
+// Multiplies |data| by |window|; may be done in place.
+typedef void (*NsWindowing)(const float* window,
+                            const float* data,
+                            size_t length,
+                            float* data_windowed);
+extern NsWindowing WebRtcNs_Windowing;
+
+// Energy of a buffer.
+typedef float (*NsEnergy)(const float* buffer, size_t length);
+extern NsEnergy WebRtcNs_Energy;
+
+// Updates the prior speech probability from the features and returns the gain
+// that combines it with the LRT of each frequency.
+// Intended to be private.
+float WebRtcNs_UpdatePriorSpeechProb(NoiseSuppressionC* self);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+// For the above function pointers, functions for generic platforms are declared
+// and defined as static in file ns_core.c, while those for SSE2 are declared
+// below and defined in file ns_core_sse2.c. The SSE2 versions use approximate
+// logarithms and exponentials and sum in a different order, so their output is
+// close to but not bit-exact with the generic versions.
+void WebRtcNs_NoiseEstimationSse2(NoiseSuppressionC* self,
+                                  float* magn,
+                                  float* noise);
+void WebRtcNs_ComputeSpectralFlatnessSse2(NoiseSuppressionC* self,
+                                          const float* magnIn);
+void WebRtcNs_ComputeSnrSse2(const NoiseSuppressionC* self,
+                             const float* magn,
+                             const float* noise,
+                             float* snrLocPrior,
+                             float* snrLocPost);
+void WebRtcNs_ComputeSpectralDifferenceSse2(NoiseSuppressionC* self,
+                                            const float* magnIn);
+void WebRtcNs_SpeechNoiseProbSse2(NoiseSuppressionC* self,
+                                  float* probSpeechFinal,
+                                  const float* snrLocPrior,
+                                  const float* snrLocPost);
+void WebRtcNs_UpdateNoiseEstimateSse2(NoiseSuppressionC* self,
+                                      const float* magn,
+                                      const float* snrLocPrior,
+                                      const float* snrLocPost,
+                                      float* noise);
+void WebRtcNs_ComputeDdBasedWienerFilterSse2(const NoiseSuppressionC* self,
+                                             const float* magn,
+                                             float* theFilter);
+void WebRtcNs_WindowingSse2(const float* window,
+                            const float* data,
+                            size_t length,
+                            float* data_windowed);
+float WebRtcNs_EnergySse2(const float* buffer, size_t length);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,548 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/legacy_ns/ns_core.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+
+#include <emmintrin.h>
+#include <math.h>
+#include <string.h>
+
+// Natural logarithm of four positive, normal floats, with the Cephes single
+// precision polynomial. The relative error is within a few ulp.
+static __m128 LogSse2(__m128 x) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128i kExponentMask = _mm_set1_epi32(0x7f800000);
+  const __m128i kHalf = _mm_set1_epi32(0x3f000000);
+  __m128i bits = _mm_castps_si128(x);
+  __m128 e, m, mask, z, y;
+
+  // x = m * 2^e with m in [0.5, 1).
+  e = _mm_cvtepi32_ps(_mm_sub_epi32(
+      _mm_srli_epi32(_mm_and_si128(bits, kExponentMask), 23),
+      _mm_set1_epi32(126)));
+  m = _mm_castsi128_ps(
+      _mm_or_si128(_mm_andnot_si128(kExponentMask, bits), kHalf));
+
+  // Move m to [sqrt(0.5), sqrt(2)) and subtract one.
+  mask = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+  e = _mm_sub_ps(e, _mm_and_ps(kOne, mask));
+  m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(m, mask)), kOne);
+
+  z = _mm_mul_ps(m, m);
+  y = _mm_set1_ps(7.0376836292e-2f);
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+  y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+  y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+  y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+  return _mm_add_ps(_mm_add_ps(m, y),
+                    _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+}
+
+// Exponential of four floats, with the Cephes single precision polynomial.
+// Inputs are clamped to [-88.37, 88]; the smallest ones give zero.
+static __m128 ExpSse2(__m128 x) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  __m128 n, t, y, z;
+
+  x = _mm_min_ps(x, _mm_set1_ps(88.f));
+  x = _mm_max_ps(x, _mm_set1_ps(-88.3762626647949f));
+
+  // n = round(x / ln(2)), with the floor done by truncation and correction.
+  n = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)),
+                 _mm_set1_ps(0.5f));
+  t = _mm_cvtepi32_ps(_mm_cvttps_epi32(n));
+  n = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, n), kOne));
+
+  x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+  x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+  z = _mm_mul_ps(x, x);
+  y = _mm_set1_ps(1.9875691500e-4f);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+  y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), kOne);
+
+  // Multiply by 2^n.
+  return _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(
+                           _mm_add_epi32(_mm_cvttps_epi32(n),
+                                         _mm_set1_epi32(127)),
+                           23)));
+}
+
+static float HorizontalSum(__m128 x) {
+  x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+  x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+  return _mm_cvtss_f32(x);
+}
+
+// |out| = exp(|in|) for |length| values.
+static void ExpArray(const float* in, size_t length, float* out) {
+  size_t i;
+  for (i = 0; i + 4 <= length; i += 4) {
+    _mm_storeu_ps(&out[i], ExpSse2(_mm_loadu_ps(&in[i])));
+  }
+  for (; i < length; i++) {
+    out[i] = (float)exp(in[i]);
+  }
+}
+
+void WebRtcNs_NoiseEstimationSse2(NoiseSuppressionC* self,
+                                  float* magn,
+                                  float* noise) {
+  size_t i, s, offset = 0;
+  float lmagn[HALF_ANAL_BLOCKL], delta;
+
+  if (self->updates < END_STARTUP_LONG) {
+    self->updates++;
+  }
+
+  for (i = 0; i + 4 <= self->magnLen; i += 4) {
+    _mm_storeu_ps(&lmagn[i], LogSse2(_mm_loadu_ps(&magn[i])));
+  }
+  for (; i < self->magnLen; i++) {
+    lmagn[i] = (float)log(magn[i]);
+  }
+
+  // Loop over simultaneous estimates.
+  for (s = 0; s < SIMULT; s++) {
+    const float counter = (float)self->counter[s];
+    const float counter_plus_one = (float)(self->counter[s] + 1);
+    const __m128 kCounter = _mm_set1_ps(counter);
+    const __m128 kCounterPlusOne = _mm_set1_ps(counter_plus_one);
+    const __m128 kFactor = _mm_set1_ps(FACTOR);
+    const __m128 kOne = _mm_set1_ps(1.f);
+    float* lquantile;
+    float* density;
+    offset = s * self->magnLen;
+    lquantile = &self->lquantile[offset];
+    density = &self->density[offset];
+
+    // newquantest(...)
+    for (i = 0; i + 4 <= self->magnLen; i += 4) {
+      const __m128 lm = _mm_loadu_ps(&lmagn[i]);
+      __m128 lq = _mm_loadu_ps(&lquantile[i]);
+      __m128 d = _mm_loadu_ps(&density[i]);
+      __m128 mask, v_delta, step_up, step_down, new_d;
+
+      // Compute delta.
+      mask = _mm_cmpgt_ps(d, kOne);
+      v_delta = _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(kFactor, d)),
+                          _mm_andnot_ps(mask, kFactor));
+
+      // Update log quantile estimate.
+      step_up = _mm_div_ps(_mm_mul_ps(_mm_set1_ps(QUANTILE), v_delta),
+                           kCounterPlusOne);
+      step_down =
+          _mm_div_ps(_mm_mul_ps(_mm_set1_ps(1.f - QUANTILE), v_delta),
+                     kCounterPlusOne);
+      mask = _mm_cmpgt_ps(lm, lq);
+      lq = _mm_or_ps(_mm_and_ps(mask, _mm_add_ps(lq, step_up)),
+                     _mm_andnot_ps(mask, _mm_sub_ps(lq, step_down)));
+      _mm_storeu_ps(&lquantile[i], lq);
+
+      // Update density estimate.
+      mask = _mm_cmplt_ps(
+          _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_sub_ps(lm, lq)),
+          _mm_set1_ps(WIDTH));
+      new_d = _mm_div_ps(_mm_add_ps(_mm_mul_ps(kCounter, d),
+                                    _mm_set1_ps(1.f / (2.f * WIDTH))),
+                         kCounterPlusOne);
+      d = _mm_or_ps(_mm_and_ps(mask, new_d), _mm_andnot_ps(mask, d));
+      _mm_storeu_ps(&density[i], d);
+    }
+    for (; i < self->magnLen; i++) {
+      if (density[i] > 1.0) {
+        delta = FACTOR * 1.f / density[i];
+      } else {
+        delta = FACTOR;
+      }
+      if (lmagn[i] > lquantile[i]) {
+        lquantile[i] += QUANTILE * delta / counter_plus_one;
+      } else {
+        lquantile[i] -= (1.f - QUANTILE) * delta / counter_plus_one;
+      }
+      if (fabs(lmagn[i] - lquantile[i]) < WIDTH) {
+        density[i] =
+            (counter * density[i] + 1.f / (2.f * WIDTH)) / counter_plus_one;
+      }
+    }  // End loop over magnitude spectrum.
+
+    if (self->counter[s] >= END_STARTUP_LONG) {
+      self->counter[s] = 0;
+      if (self->updates >= END_STARTUP_LONG) {
+        ExpArray(lquantile, self->magnLen, self->quantile);
+      }
+    }
+
+    self->counter[s]++;
+  }  // End loop over simultaneous estimates.
+
+  // Sequentially update the noise during startup.
+  if (self->updates < END_STARTUP_LONG) {
+    // Use the last "s" to get noise during startup that differ from zero.
+    ExpArray(&self->lquantile[offset], self->magnLen, self->quantile);
+  }
+
+  memcpy(noise, self->quantile, sizeof(*noise) * self->magnLen);
+}
+
+void WebRtcNs_ComputeSpectralFlatnessSse2(NoiseSuppressionC* self,
+                                          const float* magnIn) {
+  const size_t shiftLP = 1;  // Remove the first bin from spectral measures.
+  size_t i;
+  float avgSpectralFlatnessNum, avgSpectralFlatnessDen, spectralTmp;
+  __m128 sum = _mm_setzero_ps();
+  __m128 non_positive = _mm_setzero_ps();
+  int has_zero = 0;
+
+  avgSpectralFlatnessDen = self->sumMagn - magnIn[0];
+  // Compute log of ratio of the geometric to arithmetic mean: check for log(0)
+  // case.
+  for (i = shiftLP; i + 4 <= self->magnLen; i += 4) {
+    const __m128 m = _mm_loadu_ps(&magnIn[i]);
+    non_positive = _mm_or_ps(non_positive, _mm_cmple_ps(m, _mm_setzero_ps()));
+    sum = _mm_add_ps(sum, LogSse2(m));
+  }
+  avgSpectralFlatnessNum = HorizontalSum(sum);
+  has_zero = _mm_movemask_ps(non_positive) != 0;
+  for (; i < self->magnLen && !has_zero; i++) {
+    if (magnIn[i] > 0.0) {
+      avgSpectralFlatnessNum += (float)log(magnIn[i]);
+    } else {
+      has_zero = 1;
+    }
+  }
+  if (has_zero) {
+    self->featureData[0] -= SPECT_FL_TAVG * self->featureData[0];
+    return;
+  }
+  // Normalize.
+  avgSpectralFlatnessDen = avgSpectralFlatnessDen / self->magnLen;
+  avgSpectralFlatnessNum = avgSpectralFlatnessNum / self->magnLen;
+
+  // Ratio and inverse log: check for case of log(0).
+  spectralTmp = (float)exp(avgSpectralFlatnessNum) / avgSpectralFlatnessDen;
+
+  // Time-avg update of spectral flatness feature.
+  self->featureData[0] += SPECT_FL_TAVG * (spectralTmp - self->featureData[0]);
+}
+
+void WebRtcNs_ComputeSnrSse2(const NoiseSuppressionC* self,
+                             const float* magn,
+                             const float* noise,
+                             float* snrLocPrior,
+                             float* snrLocPost) {
+  const __m128 kEpsilon = _mm_set1_ps(0.0001f);
+  const __m128 kOne = _mm_set1_ps(1.f);
+  size_t i;
+
+  for (i = 0; i + 4 <= self->magnLen; i += 4) {
+    const __m128 m = _mm_loadu_ps(&magn[i]);
+    const __m128 n = _mm_loadu_ps(&noise[i]);
+    // Previous estimate: based on previous frame with gain filter.
+    const __m128 previous = _mm_mul_ps(
+        _mm_div_ps(_mm_loadu_ps(&self->magnPrevAnalyze[i]),
+                   _mm_add_ps(_mm_loadu_ps(&self->noisePrev[i]), kEpsilon)),
+        _mm_loadu_ps(&self->smooth[i]));
+    // Post SNR.
+    const __m128 post = _mm_and_ps(
+        _mm_cmpgt_ps(m, n),
+        _mm_sub_ps(_mm_div_ps(m, _mm_add_ps(n, kEpsilon)), kOne));
+    _mm_storeu_ps(&snrLocPost[i], post);
+    // Directed decision update of snrPrior.
+    _mm_storeu_ps(&snrLocPrior[i],
+                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(DD_PR_SNR), previous),
+                             _mm_mul_ps(_mm_set1_ps(1.f - DD_PR_SNR), post)));
+  }
+  for (; i < self->magnLen; i++) {
+    float previousEstimateStsa = self->magnPrevAnalyze[i] /
+        (self->noisePrev[i] + 0.0001f) * self->smooth[i];
+    snrLocPost[i] = 0.f;
+    if (magn[i] > noise[i]) {
+      snrLocPost[i] = magn[i] / (noise[i] + 0.0001f) - 1.f;
+    }
+    snrLocPrior[i] =
+        DD_PR_SNR * previousEstimateStsa + (1.f - DD_PR_SNR) * snrLocPost[i];
+  }
+}
+
+void WebRtcNs_ComputeSpectralDifferenceSse2(NoiseSuppressionC* self,
+                                            const float* magnIn) {
+  size_t i;
+  float avgPause, avgMagn, covMagnPause, varPause, varMagn, avgDiffNormMagn;
+  __m128 sum = _mm_setzero_ps();
+  __m128 cov, var_pause, var_magn, avg_pause, avg_magn;
+
+  // Compute average quantities.
+  for (i = 0; i + 4 <= self->magnLen; i += 4) {
+    sum = _mm_add_ps(sum, _mm_loadu_ps(&self->magnAvgPause[i]));
+  }
+  avgPause = HorizontalSum(sum);
+  for (; i < self->magnLen; i++) {
+    avgPause += self->magnAvgPause[i];
+  }
+  avgPause /= self->magnLen;
+  avgMagn = self->sumMagn / self->magnLen;
+
+  // Compute variance and covariance quantities.
+  avg_pause = _mm_set1_ps(avgPause);
+  avg_magn = _mm_set1_ps(avgMagn);
+  cov = _mm_setzero_ps();
+  var_pause = _mm_setzero_ps();
+  var_magn = _mm_setzero_ps();
+  for (i = 0; i + 4 <= self->magnLen; i += 4) {
+    const __m128 dm = _mm_sub_ps(_mm_loadu_ps(&magnIn[i]), avg_magn);
+    const __m128 dp =
+        _mm_sub_ps(_mm_loadu_ps(&self->magnAvgPause[i]), avg_pause);
+    cov = _mm_add_ps(cov, _mm_mul_ps(dm, dp));
+    var_pause = _mm_add_ps(var_pause, _mm_mul_ps(dp, dp));
+    var_magn = _mm_add_ps(var_magn, _mm_mul_ps(dm, dm));
+  }
+  covMagnPause = HorizontalSum(cov);
+  varPause = HorizontalSum(var_pause);
+  varMagn = HorizontalSum(var_magn);
+  for (; i < self->magnLen; i++) {
+    covMagnPause += (magnIn[i] - avgMagn) * (self->magnAvgPause[i] - avgPause);
+    varPause +=
+        (self->magnAvgPause[i] - avgPause) * (self->magnAvgPause[i] - avgPause);
+    varMagn += (magnIn[i] - avgMagn) * (magnIn[i] - avgMagn);
+  }
+  covMagnPause /= self->magnLen;
+  varPause /= self->magnLen;
+  varMagn /= self->magnLen;
+  // Update of average magnitude spectrum.
+  self->featureData[6] += self->signalEnergy;
+
+  avgDiffNormMagn =
+      varMagn - (covMagnPause * covMagnPause) / (varPause + 0.0001f);
+  // Normalize and compute time-avg update of difference feature.
+  avgDiffNormMagn = (float)(avgDiffNormMagn / (self->featureData[5] + 0.0001f));
+  self->featureData[4] +=
+      SPECT_DIFF_TAVG * (avgDiffNormMagn - self->featureData[4]);
+}
+
+void WebRtcNs_SpeechNoiseProbSse2(NoiseSuppressionC* self,
+                                  float* probSpeechFinal,
+                                  const float* snrLocPrior,
+                                  const float* snrLocPost) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kTwo = _mm_set1_ps(2.f);
+  size_t i;
+  float logLrtTimeAvgKsum, gainPrior;
+  __m128 sum = _mm_setzero_ps();
+  __m128 gain;
+
+  // Compute feature based on average LR factor.
+  for (i = 0; i + 4 <= self->magnLen; i += 4) {
+    const __m128 prior = _mm_loadu_ps(&snrLocPrior[i]);
+    const __m128 tmp1 = _mm_add_ps(kOne, _mm_mul_ps(kTwo, prior));
+    const __m128 tmp2 = _mm_div_ps(_mm_mul_ps(kTwo, prior),
+                                   _mm_add_ps(tmp1, _mm_set1_ps(0.0001f)));
+    const __m128 bessel =
+        _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&snrLocPost[i]), kOne), tmp2);
+    __m128 lrt = _mm_loadu_ps(&self->logLrtTimeAvg[i]);
+    lrt = _mm_add_ps(
+        lrt, _mm_mul_ps(_mm_set1_ps(LRT_TAVG),
+                        _mm_sub_ps(_mm_sub_ps(bessel, LogSse2(tmp1)), lrt)));
+    _mm_storeu_ps(&self->logLrtTimeAvg[i], lrt);
+    sum = _mm_add_ps(sum, lrt);
+  }
+  logLrtTimeAvgKsum = HorizontalSum(sum);
+  for (; i < self->magnLen; i++) {
+    float tmpFloat1 = 1.f + 2.f * snrLocPrior[i];
+    float tmpFloat2 = 2.f * snrLocPrior[i] / (tmpFloat1 + 0.0001f);
+    float besselTmp = (snrLocPost[i] + 1.f) * tmpFloat2;
+    self->logLrtTimeAvg[i] +=
+        LRT_TAVG * (besselTmp - (float)log(tmpFloat1) - self->logLrtTimeAvg[i]);
+    logLrtTimeAvgKsum += self->logLrtTimeAvg[i];
+  }
+  self->featureData[3] = logLrtTimeAvgKsum / self->magnLen;
+
+  gainPrior = WebRtcNs_UpdatePriorSpeechProb(self);
+
+  // Final speech probability: combine prior model with LR factor.
+  gain = _mm_set1_ps(gainPrior);
+  for (i = 0; i + 4 <= self->magnLen; i += 4) {
+    const __m128 inv_lrt = _mm_mul_ps(
+        gain, ExpSse2(_mm_sub_ps(_mm_setzero_ps(),
+                                 _mm_loadu_ps(&self->logLrtTimeAvg[i]))));
+    _mm_storeu_ps(&probSpeechFinal[i],
+                  _mm_div_ps(kOne, _mm_add_ps(kOne, inv_lrt)));
+  }
+  for (; i < self->magnLen; i++) {
+    float invLrt = gainPrior * (float)exp(-self->logLrtTimeAvg[i]);
+    probSpeechFinal[i] = 1.f / (1.f + invLrt);
+  }
+}
+
+void WebRtcNs_UpdateNoiseEstimateSse2(NoiseSuppressionC* self,
+                                      const float* magn,
+                                      const float* snrLocPrior,
+                                      const float* snrLocPost,
+                                      float* noise) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kProbRange = _mm_set1_ps(PROB_RANGE);
+  const __m128 kNoiseUpdate = _mm_set1_ps(NOISE_UPDATE);
+  const __m128 kSpeechUpdate = _mm_set1_ps(SPEECH_UPDATE);
+  const float* probSpeech = self->speechProb;
+  size_t i;
+
+  // The time constant of each frequency is chosen from the speech
+  // probability of the frequency below it, so it is computed from the
+  // probabilities shifted by one.
+  for (i = 0; i + 4 <= self->magnLen; i += 4) {
+    const __m128 p = _mm_loadu_ps(&probSpeech[i]);
+    const __m128 p_below =
+        i == 0 ? _mm_setr_ps(0.f, probSpeech[0], probSpeech[1], probSpeech[2])
+               : _mm_loadu_ps(&probSpeech[i - 1]);
+    const __m128 m = _mm_loadu_ps(&magn[i]);
+    const __m128 noise_prev = _mm_loadu_ps(&self->noisePrev[i]);
+    // Noise update target, weighted by the speech probability.
+    const __m128 target =
+        _mm_add_ps(_mm_mul_ps(_mm_sub_ps(kOne, p), m),
+                   _mm_mul_ps(p, noise_prev));
+    __m128 mask, gamma_old, gamma, update_old, update, pause;
+
+    mask = _mm_cmpgt_ps(p_below, kProbRange);
+    gamma_old = _mm_or_ps(_mm_and_ps(mask, kSpeechUpdate),
+                          _mm_andnot_ps(mask, kNoiseUpdate));
+    mask = _mm_cmpgt_ps(p, kProbRange);
+    gamma = _mm_or_ps(_mm_and_ps(mask, kSpeechUpdate),
+                      _mm_andnot_ps(mask, kNoiseUpdate));
+
+    // Conservative noise update.
+    mask = _mm_cmplt_ps(p, kProbRange);
+    pause = _mm_loadu_ps(&self->magnAvgPause[i]);
+    pause = _mm_add_ps(
+        pause, _mm_and_ps(mask, _mm_mul_ps(_mm_set1_ps(GAMMA_PAUSE),
+                                           _mm_sub_ps(m, pause))));
+    _mm_storeu_ps(&self->magnAvgPause[i], pause);
+
+    // Noise update, only allowed downwards when the time constant changes.
+    update_old = _mm_add_ps(_mm_mul_ps(gamma_old, noise_prev),
+                            _mm_mul_ps(_mm_sub_ps(kOne, gamma_old), target));
+    update = _mm_add_ps(_mm_mul_ps(gamma, noise_prev),
+                        _mm_mul_ps(_mm_sub_ps(kOne, gamma), target));
+    mask = _mm_cmpeq_ps(gamma, gamma_old);
+    _mm_storeu_ps(&noise[i],
+                  _mm_or_ps(_mm_and_ps(mask, update_old),
+                            _mm_andnot_ps(mask, _mm_min_ps(update_old,
+                                                           update))));
+  }
+  for (; i < self->magnLen; i++) {
+    const float p = probSpeech[i];
+    const float gammaOld =
+        i > 0 && probSpeech[i - 1] > PROB_RANGE ? SPEECH_UPDATE : NOISE_UPDATE;
+    const float gamma = p > PROB_RANGE ? SPEECH_UPDATE : NOISE_UPDATE;
+    const float target = (1.f - p) * magn[i] + p * self->noisePrev[i];
+    const float noiseUpdateTmp =
+        gammaOld * self->noisePrev[i] + (1.f - gammaOld) * target;
+    if (p < PROB_RANGE) {
+      self->magnAvgPause[i] += GAMMA_PAUSE * (magn[i] - self->magnAvgPause[i]);
+    }
+    if (gamma == gammaOld) {
+      noise[i] = noiseUpdateTmp;
+    } else {
+      noise[i] = gamma * self->noisePrev[i] + (1.f - gamma) * target;
+      if (noiseUpdateTmp < noise[i]) {
+        noise[i] = noiseUpdateTmp;
+      }
+    }
+  }
+}
+
+void WebRtcNs_ComputeDdBasedWienerFilterSse2(const NoiseSuppressionC* self,
+                                             const float* magn,
+                                             float* theFilter) {
+  const __m128 kEpsilon = _mm_set1_ps(0.0001f);
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 overdrive = _mm_set1_ps(self->overdrive);
+  size_t i;
+
+  for (i = 0; i + 4 <= self->magnLen; i += 4) {
+    const __m128 m = _mm_loadu_ps(&magn[i]);
+    const __m128 n = _mm_loadu_ps(&self->noise[i]);
+    // Previous estimate: based on previous frame with gain filter.
+    const __m128 previous = _mm_mul_ps(
+        _mm_div_ps(_mm_loadu_ps(&self->magnPrevProcess[i]),
+                   _mm_add_ps(_mm_loadu_ps(&self->noisePrev[i]), kEpsilon)),
+        _mm_loadu_ps(&self->smooth[i]));
+    // Post and prior SNR.
+    const __m128 current = _mm_and_ps(
+        _mm_cmpgt_ps(m, n),
+        _mm_sub_ps(_mm_div_ps(m, _mm_add_ps(n, kEpsilon)), kOne));
+    const __m128 snr_prior =
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(DD_PR_SNR), previous),
+                   _mm_mul_ps(_mm_set1_ps(1.f - DD_PR_SNR), current));
+    // Gain filter.
+    _mm_storeu_ps(&theFilter[i],
+                  _mm_div_ps(snr_prior, _mm_add_ps(overdrive, snr_prior)));
+  }
+  for (; i < self->magnLen; i++) {
+    float previousEstimateStsa = self->magnPrevProcess[i] /
+                                 (self->noisePrev[i] + 0.0001f) *
+                                 self->smooth[i];
+    float currentEstimateStsa = 0.f;
+    float snrPrior;
+    if (magn[i] > self->noise[i]) {
+      currentEstimateStsa = magn[i] / (self->noise[i] + 0.0001f) - 1.f;
+    }
+    snrPrior = DD_PR_SNR * previousEstimateStsa +
+               (1.f - DD_PR_SNR) * currentEstimateStsa;
+    theFilter[i] = snrPrior / (self->overdrive + snrPrior);
+  }
+}
+
+void WebRtcNs_WindowingSse2(const float* window,
+                            const float* data,
+                            size_t length,
+                            float* data_windowed) {
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    _mm_storeu_ps(&data_windowed[i], _mm_mul_ps(_mm_loadu_ps(&window[i]),
+                                                _mm_loadu_ps(&data[i])));
+  }
+  for (; i < length; ++i) {
+    data_windowed[i] = window[i] * data[i];
+  }
+}
+
+float WebRtcNs_EnergySse2(const float* buffer, size_t length) {
+  size_t i;
+  float energy;
+  __m128 sum = _mm_setzero_ps();
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    const __m128 x = _mm_loadu_ps(&buffer[i]);
+    sum = _mm_add_ps(sum, _mm_mul_ps(x, x));
+  }
+  energy = HorizontalSum(sum);
+  for (; i < length; ++i) {
+    energy += buffer[i] * buffer[i];
+  }
+
+  return energy;
+}
+
+#endif  // defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
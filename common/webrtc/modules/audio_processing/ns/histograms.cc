@@ -10,37 +10,60 @@
 
 #include "modules/audio_processing/ns/histograms.h"
 
+#include "rtc_base/checks.h"
+
 namespace webrtc {
 
+void FeatureHistogram::Clear() {
+  counts_.fill(0);
+  overflow_bin_ = kHistogramSize;
+  overflow_count_ = 0;
+}
+
+void FeatureHistogram::Add(size_t bin) {
+  RTC_DCHECK_LT(bin, kHistogramSize);
+  if (bin == overflow_bin_) {
+    ++overflow_count_;
+  } else if (counts_[bin] < 255) {
+    ++counts_[bin];
+  } else {
+    RTC_DCHECK_EQ(overflow_bin_, kHistogramSize);
+    overflow_bin_ = bin;
+    overflow_count_ = 256;
+  }
+}
+
 Histograms::Histograms() {
   Clear();
 }
 
 void Histograms::Clear() {
-  lrt_.fill(0);
-  spectral_flatness_.fill(0);
-  spectral_diff_.fill(0);
+  lrt_.Clear();
+  spectral_flatness_.Clear();
+  spectral_diff_.Clear();
 }
 
-void Histograms::Update(const SignalModel& features_) {
+void Histograms::Update(float lrt,
+                        float spectral_flatness,
+                        float spectral_diff) {
   // Update the histogram for the LRT.
   constexpr float kOneByBinSizeLrt = 1.f / kBinSizeLrt;
-  if (features_.lrt < kHistogramSize * kBinSizeLrt && features_.lrt >= 0.f) {
-    ++lrt_[kOneByBinSizeLrt * features_.lrt];
+  if (lrt < kHistogramSize * kBinSizeLrt && lrt >= 0.f) {
+    lrt_.Add(kOneByBinSizeLrt * lrt);
   }
 
   // Update histogram for the spectral flatness.
   constexpr float kOneByBinSizeSpecFlat = 1.f / kBinSizeSpecFlat;
-  if (features_.spectral_flatness < kHistogramSize * kBinSizeSpecFlat &&
-      features_.spectral_flatness >= 0.f) {
-    ++spectral_flatness_[features_.spectral_flatness * kOneByBinSizeSpecFlat];
+  if (spectral_flatness < kHistogramSize * kBinSizeSpecFlat &&
+      spectral_flatness >= 0.f) {
+    spectral_flatness_.Add(spectral_flatness * kOneByBinSizeSpecFlat);
   }
 
   // Update histogram for the spectral difference.
   constexpr float kOneByBinSizeSpecDiff = 1.f / kBinSizeSpecDiff;
-  if (features_.spectral_diff < kHistogramSize * kBinSizeSpecDiff &&
-      features_.spectral_diff >= 0.f) {
-    ++spectral_diff_[features_.spectral_diff * kOneByBinSizeSpecDiff];
+  if (spectral_diff < kHistogramSize * kBinSizeSpecDiff &&
+      spectral_diff >= 0.f) {
+    spectral_diff_.Add(spectral_diff * kOneByBinSizeSpecDiff);
   }
 }
 
@@ -11,16 +11,41 @@
 #ifndef MODULES_AUDIO_PROCESSING_NS_HISTOGRAMS_H_
 #define MODULES_AUDIO_PROCESSING_NS_HISTOGRAMS_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <array>
 
-#include "api/array_view.h"
 #include "modules/audio_processing/ns/ns_common.h"
-#include "modules/audio_processing/ns/signal_model.h"
 
 namespace webrtc {
 
 constexpr int kHistogramSize = 1000;
 
+// Histogram of the values of one feature over an update window of
+// kFeatureUpdateWindowSize frames. The bins hold 8 bit counts; a window is too
+// short for more than one bin to reach 256 counts, so the count of that bin is
+// kept separately. The histogram takes a quarter of the memory of int bins.
+class FeatureHistogram {
+ public:
+  FeatureHistogram() { Clear(); }
+
+  void Clear();
+
+  // Counts a value in |bin|.
+  void Add(size_t bin);
+
+  int operator[](size_t bin) const {
+    return bin == overflow_bin_ ? overflow_count_ : counts_[bin];
+  }
+
+ private:
+  std::array<uint8_t, kHistogramSize> counts_;
+  // The bin that reached 256 counts and its count, or kHistogramSize if none.
+  size_t overflow_bin_;
+  int overflow_count_;
+};
+
 // Class for handling the updating of histograms.
 class Histograms {
  public:
@@ -33,21 +58,19 @@ class Histograms {
 
   // Extracts thresholds for feature parameters and updates the corresponding
   // histogram.
-  void Update(const SignalModel& features_);
+  void Update(float lrt, float spectral_flatness, float spectral_diff);
 
   // Methods for accessing the histograms.
-  rtc::ArrayView<const int, kHistogramSize> get_lrt() const { return lrt_; }
-  rtc::ArrayView<const int, kHistogramSize> get_spectral_flatness() const {
+  const FeatureHistogram& get_lrt() const { return lrt_; }
+  const FeatureHistogram& get_spectral_flatness() const {
     return spectral_flatness_;
   }
-  rtc::ArrayView<const int, kHistogramSize> get_spectral_diff() const {
-    return spectral_diff_;
-  }
+  const FeatureHistogram& get_spectral_diff() const { return spectral_diff_; }
 
  private:
-  std::array<int, kHistogramSize> lrt_;
-  std::array<int, kHistogramSize> spectral_flatness_;
-  std::array<int, kHistogramSize> spectral_diff_;
+  FeatureHistogram lrt_;
+  FeatureHistogram spectral_flatness_;
+  FeatureHistogram spectral_diff_;
 };
 
 }  // namespace webrtc
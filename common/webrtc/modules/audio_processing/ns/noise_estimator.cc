@@ -11,6 +11,8 @@
 #include "modules/audio_processing/ns/noise_estimator.h"
 
 #include <algorithm>
+#include <limits>
+#include <vector>
 
 #include "modules/audio_processing/ns/fast_math.h"
 #include "rtc_base/checks.h"
@@ -19,8 +21,10 @@ namespace webrtc {
 
 namespace {
 
+constexpr float kMinNormalFloat = std::numeric_limits<float>::min();
+
 // Log(i).
-constexpr std::array<float, 129> log_table = {
+constexpr std::array<float, 513> log_table = {
     0.f,       0.f,       0.f,       0.f,       0.f,       1.609438f, 1.791759f,
     1.945910f, 2.079442f, 2.197225f, 2.302585f, 2.397895f, 2.484907f, 2.564949f,
     2.639057f, 2.708050f, 2.772589f, 2.833213f, 2.890372f, 2.944439f, 2.995732f,
@@ -39,11 +43,68 @@ constexpr std::array<float, 129> log_table = {
     4.653960f, 4.663439f, 4.672829f, 4.682131f, 4.691348f, 4.700480f, 4.709530f,
     4.718499f, 4.727388f, 4.736198f, 4.744932f, 4.753591f, 4.762174f, 4.770685f,
     4.779124f, 4.787492f, 4.795791f, 4.804021f, 4.812184f, 4.820282f, 4.828314f,
-    4.836282f, 4.844187f, 4.852030f};
+    4.836282f, 4.844187f, 4.852030f, 4.859812f, 4.867534f, 4.875197f, 4.882802f,
+    4.890349f, 4.897840f, 4.905275f, 4.912655f, 4.919981f, 4.927254f, 4.934474f,
+    4.941642f, 4.948760f, 4.955827f, 4.962845f, 4.969813f, 4.976734f, 4.983607f,
+    4.990433f, 4.997212f, 5.003946f, 5.010635f, 5.017280f, 5.023881f, 5.030438f,
+    5.036953f, 5.043425f, 5.049856f, 5.056246f, 5.062595f, 5.068904f, 5.075174f,
+    5.081404f, 5.087596f, 5.093750f, 5.099866f, 5.105945f, 5.111988f, 5.117994f,
+    5.123964f, 5.129899f, 5.135798f, 5.141664f, 5.147494f, 5.153292f, 5.159055f,
+    5.164786f, 5.170484f, 5.176150f, 5.181784f, 5.187386f, 5.192957f, 5.198497f,
+    5.204007f, 5.209486f, 5.214936f, 5.220356f, 5.225747f, 5.231109f, 5.236442f,
+    5.241747f, 5.247024f, 5.252273f, 5.257495f, 5.262690f, 5.267858f, 5.273000f,
+    5.278115f, 5.283204f, 5.288267f, 5.293305f, 5.298317f, 5.303305f, 5.308268f,
+    5.313206f, 5.318120f, 5.323010f, 5.327876f, 5.332719f, 5.337538f, 5.342334f,
+    5.347108f, 5.351858f, 5.356586f, 5.361292f, 5.365976f, 5.370638f, 5.375278f,
+    5.379897f, 5.384495f, 5.389072f, 5.393628f, 5.398163f, 5.402677f, 5.407172f,
+    5.411646f, 5.416100f, 5.420535f, 5.424950f, 5.429346f, 5.433722f, 5.438079f,
+    5.442418f, 5.446737f, 5.451038f, 5.455321f, 5.459586f, 5.463832f, 5.468060f,
+    5.472271f, 5.476464f, 5.480639f, 5.484797f, 5.488938f, 5.493061f, 5.497168f,
+    5.501258f, 5.505332f, 5.509388f, 5.513429f, 5.517453f, 5.521461f, 5.525453f,
+    5.529429f, 5.533389f, 5.537334f, 5.541264f, 5.545177f, 5.549076f, 5.552960f,
+    5.556828f, 5.560682f, 5.564520f, 5.568345f, 5.572154f, 5.575949f, 5.579730f,
+    5.583496f, 5.587249f, 5.590987f, 5.594711f, 5.598422f, 5.602119f, 5.605802f,
+    5.609472f, 5.613128f, 5.616771f, 5.620401f, 5.624018f, 5.627621f, 5.631212f,
+    5.634790f, 5.638355f, 5.641907f, 5.645447f, 5.648974f, 5.652489f, 5.655992f,
+    5.659482f, 5.662960f, 5.666427f, 5.669881f, 5.673323f, 5.676754f, 5.680173f,
+    5.683580f, 5.686975f, 5.690359f, 5.693732f, 5.697093f, 5.700444f, 5.703782f,
+    5.707110f, 5.710427f, 5.713733f, 5.717028f, 5.720312f, 5.723585f, 5.726848f,
+    5.730100f, 5.733341f, 5.736572f, 5.739793f, 5.743003f, 5.746203f, 5.749393f,
+    5.752573f, 5.755742f, 5.758902f, 5.762051f, 5.765191f, 5.768321f, 5.771441f,
+    5.774552f, 5.777652f, 5.780744f, 5.783825f, 5.786897f, 5.789960f, 5.793014f,
+    5.796058f, 5.799093f, 5.802118f, 5.805135f, 5.808142f, 5.811141f, 5.814131f,
+    5.817111f, 5.820083f, 5.823046f, 5.826000f, 5.828946f, 5.831882f, 5.834811f,
+    5.837730f, 5.840642f, 5.843544f, 5.846439f, 5.849325f, 5.852202f, 5.855072f,
+    5.857933f, 5.860786f, 5.863631f, 5.866468f, 5.869297f, 5.872118f, 5.874931f,
+    5.877736f, 5.880533f, 5.883322f, 5.886104f, 5.888878f, 5.891644f, 5.894403f,
+    5.897154f, 5.899897f, 5.902633f, 5.905362f, 5.908083f, 5.910797f, 5.913503f,
+    5.916202f, 5.918894f, 5.921578f, 5.924256f, 5.926926f, 5.929589f, 5.932245f,
+    5.934894f, 5.937536f, 5.940171f, 5.942799f, 5.945421f, 5.948035f, 5.950643f,
+    5.953243f, 5.955837f, 5.958425f, 5.961005f, 5.963579f, 5.966147f, 5.968708f,
+    5.971262f, 5.973810f, 5.976351f, 5.978886f, 5.981414f, 5.983936f, 5.986452f,
+    5.988961f, 5.991465f, 5.993961f, 5.996452f, 5.998937f, 6.001415f, 6.003887f,
+    6.006353f, 6.008813f, 6.011267f, 6.013715f, 6.016157f, 6.018593f, 6.021023f,
+    6.023448f, 6.025866f, 6.028279f, 6.030685f, 6.033086f, 6.035481f, 6.037871f,
+    6.040255f, 6.042633f, 6.045005f, 6.047372f, 6.049733f, 6.052089f, 6.054439f,
+    6.056784f, 6.059123f, 6.061457f, 6.063785f, 6.066108f, 6.068426f, 6.070738f,
+    6.073045f, 6.075346f, 6.077642f, 6.079933f, 6.082219f, 6.084499f, 6.086775f,
+    6.089045f, 6.091310f, 6.093570f, 6.095825f, 6.098074f, 6.100319f, 6.102559f,
+    6.104793f, 6.107023f, 6.109248f, 6.111467f, 6.113682f, 6.115892f, 6.118097f,
+    6.120297f, 6.122493f, 6.124683f, 6.126869f, 6.129050f, 6.131226f, 6.133398f,
+    6.135565f, 6.137727f, 6.139885f, 6.142037f, 6.144186f, 6.146329f, 6.148468f,
+    6.150603f, 6.152733f, 6.154858f, 6.156979f, 6.159095f, 6.161207f, 6.163315f,
+    6.165418f, 6.167516f, 6.169611f, 6.171701f, 6.173786f, 6.175867f, 6.177944f,
+    6.180017f, 6.182085f, 6.184149f, 6.186209f, 6.188264f, 6.190315f, 6.192362f,
+    6.194405f, 6.196444f, 6.198479f, 6.200509f, 6.202536f, 6.204558f, 6.206576f,
+    6.208590f, 6.210600f, 6.212606f, 6.214608f, 6.216606f, 6.218600f, 6.220590f,
+    6.222576f, 6.224558f, 6.226537f, 6.228511f, 6.230481f, 6.232448f, 6.234411f,
+    6.236370f, 6.238325f};
 
 }  // namespace
 
-NoiseEstimator::NoiseEstimator(const SuppressionParams& suppression_params)
+template <typename Layout>
+NoiseEstimator<Layout>::NoiseEstimator(
+    const SuppressionParams& suppression_params)
     : suppression_params_(suppression_params) {
   noise_spectrum_.fill(0.f);
   prev_noise_spectrum_.fill(0.f);
@@ -51,15 +112,18 @@ NoiseEstimator::NoiseEstimator(const SuppressionParams& suppression_params)
   parametric_noise_spectrum_.fill(0.f);
 }
 
-void NoiseEstimator::PrepareAnalysis() {
+template <typename Layout>
+void NoiseEstimator<Layout>::PrepareAnalysis() {
   std::copy(noise_spectrum_.begin(), noise_spectrum_.end(),
             prev_noise_spectrum_.begin());
 }
 
-void NoiseEstimator::PreUpdate(
+template <typename Layout>
+void NoiseEstimator<Layout>::PreUpdate(
     int32_t num_analyzed_frames,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum,
     float signal_spectral_sum) {
+  static_assert(kFftSizeBy2Plus1 <= log_table.size(), "Log table too short");
   quantile_noise_estimator_.Estimate(signal_spectrum, noise_spectrum_);
 
   if (num_analyzed_frames < kShortStartupPhaseBlocks) {
@@ -146,7 +210,8 @@ void NoiseEstimator::PreUpdate(
   }
 }
 
-void NoiseEstimator::PostUpdate(
+template <typename Layout>
+void NoiseEstimator<Layout>::PostUpdate(
     rtc::ArrayView<const float> speech_probability,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum) {
   // Time-avg parameter for noise_spectrum update.
@@ -175,6 +240,11 @@ void NoiseEstimator::PostUpdate(
     if (prob_speech < kProbRange) {
       conservative_noise_spectrum_[i] +=
           0.05f * (signal_spectrum[i] - conservative_noise_spectrum_[i]);
+      // In digital silence this decays geometrically with no floor and would
+      // settle on a denormal, where the update no longer changes it.
+      if (conservative_noise_spectrum_[i] < kMinNormalFloat) {
+        conservative_noise_spectrum_[i] = 0.f;
+      }
     }
 
     // Noise_spectrum update.
@@ -192,4 +262,34 @@ void NoiseEstimator::PostUpdate(
   }
 }
 
+template <typename Layout>
+void NoiseEstimator<Layout>::InitializeFromAverage(
+    rtc::ArrayView<const NoiseEstimator* const> estimators) {
+  RTC_DCHECK(!estimators.empty());
+  const float scale = 1.f / estimators.size();
+  white_noise_level_ = pink_noise_numerator_ = pink_noise_exp_ = 0.f;
+  noise_spectrum_.fill(0.f);
+  conservative_noise_spectrum_.fill(0.f);
+  parametric_noise_spectrum_.fill(0.f);
+  std::vector<const QuantileNoiseEstimator<Layout>*> quantile_estimators;
+  for (const NoiseEstimator* e : estimators) {
+    white_noise_level_ += scale * e->white_noise_level_;
+    pink_noise_numerator_ += scale * e->pink_noise_numerator_;
+    pink_noise_exp_ += scale * e->pink_noise_exp_;
+    for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+      noise_spectrum_[i] += scale * e->noise_spectrum_[i];
+      conservative_noise_spectrum_[i] +=
+          scale * e->conservative_noise_spectrum_[i];
+      parametric_noise_spectrum_[i] += scale * e->parametric_noise_spectrum_[i];
+    }
+    quantile_estimators.push_back(&e->quantile_noise_estimator_);
+  }
+  prev_noise_spectrum_ = noise_spectrum_;
+  quantile_noise_estimator_.InitializeFromAverage(quantile_estimators);
+}
+
+template class NoiseEstimator<Ns10msLayout>;
+template class NoiseEstimator<Ns5msLayout>;
+template class NoiseEstimator<Ns48kFullBandLayout>;
+
 }  // namespace webrtc
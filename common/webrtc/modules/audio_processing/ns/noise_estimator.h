@@ -22,8 +22,11 @@ namespace webrtc {
 
 // Class for estimating the spectral characteristics of the noise in an incoming
 // signal.
+template <typename Layout>
 class NoiseEstimator {
  public:
+  static constexpr size_t kFftSizeBy2Plus1 = Layout::kFftSizeBy2Plus1;
+
   explicit NoiseEstimator(const SuppressionParams& suppression_params);
 
   // Prepare the estimator for analysis of a new frame.
@@ -39,6 +42,11 @@ class NoiseEstimator {
       rtc::ArrayView<const float> speech_probability,
       rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum);
 
+  // Sets the estimates to the average of those of |estimators|, which have
+  // analyzed other parts of the same signal.
+  void InitializeFromAverage(
+      rtc::ArrayView<const NoiseEstimator* const> estimators);
+
   // Returns the noise spectral estimate.
   rtc::ArrayView<const float, kFftSizeBy2Plus1> get_noise_spectrum() const {
     return noise_spectrum_;
@@ -65,11 +73,15 @@ class NoiseEstimator {
   float white_noise_level_ = 0.f;
   float pink_noise_numerator_ = 0.f;
   float pink_noise_exp_ = 0.f;
-  std::array<float, kFftSizeBy2Plus1> prev_noise_spectrum_;
-  std::array<float, kFftSizeBy2Plus1> conservative_noise_spectrum_;
-  std::array<float, kFftSizeBy2Plus1> parametric_noise_spectrum_;
-  std::array<float, kFftSizeBy2Plus1> noise_spectrum_;
-  QuantileNoiseEstimator quantile_noise_estimator_;
+  alignas(kNsStateAlignment)
+      std::array<float, kFftSizeBy2Plus1> prev_noise_spectrum_;
+  alignas(kNsStateAlignment)
+      std::array<float, kFftSizeBy2Plus1> conservative_noise_spectrum_;
+  alignas(kNsStateAlignment)
+      std::array<float, kFftSizeBy2Plus1> parametric_noise_spectrum_;
+  alignas(kNsStateAlignment)
+      std::array<float, kFftSizeBy2Plus1> noise_spectrum_;
+  QuantileNoiseEstimator<Layout> quantile_noise_estimator_;
 };
 
 }  // namespace webrtc
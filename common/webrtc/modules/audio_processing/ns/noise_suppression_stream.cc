@@ -0,0 +1,226 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/ns/noise_suppression_stream.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "common_audio/include/audio_util.h"
+#include "common_audio/resampler/push_sinc_resampler.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+namespace {
+
+size_t GreatestCommonDivisor(size_t a, size_t b) {
+  while (b != 0) {
+    const size_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Returns the number of frames of silence that the output needs to start with
+// for every Process() call to be able to return as many frames as it was
+// given. With a varying chunk size, up to block_size - 1 frames can be waiting
+// for the block to complete.
+size_t ComputeLatencyFrames(size_t block_size, size_t chunk_size) {
+  if (chunk_size == 0) {
+    return block_size - 1;
+  }
+  return block_size - GreatestCommonDivisor(chunk_size, block_size);
+}
+
+}  // namespace
+
+NoiseSuppressionStream::NoiseSuppressionStream(const NsConfig& config,
+                                               size_t sample_rate_hz,
+                                               size_t num_channels,
+                                               size_t chunk_size_frames)
+    : sample_rate_hz_(sample_rate_hz),
+      processing_rate_hz_(
+          NsProcessingRateHz(sample_rate_hz, config.processing_rate)),
+      num_channels_(num_channels),
+      block_size_(sample_rate_hz * NsChunkSizeMs(sample_rate_hz) / 1000),
+      latency_frames_(ComputeLatencyFrames(block_size_, chunk_size_frames)),
+      suppressor_(config, sample_rate_hz, num_channels),
+      audio_(sample_rate_hz,
+             num_channels,
+             processing_rate_hz_,
+             num_channels,
+             sample_rate_hz,
+             num_channels,
+             NsChunkSizeMs(sample_rate_hz)),
+      wrapped_block_(block_size_ * num_channels) {
+  RTC_DCHECK_LT(0, num_channels_);
+  if (processing_rate_hz_ != sample_rate_hz_) {
+    input_block_.reset(new ChannelBuffer<float>(block_size_, num_channels_));
+    output_block_.reset(new ChannelBuffer<float>(block_size_, num_channels_));
+  }
+
+  // Room for the initial silence and two blocks, which is what Process()
+  // needs in steady state.
+  output_fifo_.resize((latency_frames_ + 2 * block_size_) * num_channels_);
+  output_size_ = latency_frames_ * num_channels_;
+}
+
+NoiseSuppressionStream::~NoiseSuppressionStream() = default;
+
+float NoiseSuppressionStream::resampling_delay_seconds() const {
+  if (processing_rate_hz_ == sample_rate_hz_) {
+    return 0.f;
+  }
+  return PushSincResampler::AlgorithmicDelaySeconds(sample_rate_hz_) +
+         PushSincResampler::AlgorithmicDelaySeconds(processing_rate_hz_);
+}
+
+void NoiseSuppressionStream::Push(rtc::ArrayView<const float> input) {
+  RTC_DCHECK_EQ(0, input.size() % num_channels_);
+  while (!input.empty()) {
+    const size_t consumed = FillBlock(input);
+    input = input.subview(consumed * num_channels_);
+    if (block_fill_ == block_size_) {
+      ProcessBlock();
+      WriteBlockToFifo();
+    }
+  }
+}
+
+size_t NoiseSuppressionStream::Pull(rtc::ArrayView<float> output) {
+  RTC_DCHECK_EQ(0, output.size() % num_channels_);
+  const size_t num_samples = std::min(output.size(), output_size_);
+  const size_t capacity = output_fifo_.size();
+
+  const size_t first = std::min(num_samples, capacity - output_read_);
+  memcpy(output.data(), &output_fifo_[output_read_], first * sizeof(float));
+  memcpy(output.data() + first, output_fifo_.data(),
+         (num_samples - first) * sizeof(float));
+
+  output_read_ = (output_read_ + num_samples) % capacity;
+  output_size_ -= num_samples;
+  return num_samples / num_channels_;
+}
+
+void NoiseSuppressionStream::Process(rtc::ArrayView<const float> input,
+                                     rtc::ArrayView<float> output) {
+  RTC_DCHECK_EQ(input.size(), output.size());
+  RTC_DCHECK_EQ(0, input.size() % num_channels_);
+
+  // With nothing buffered on either side, whole blocks go straight from the
+  // caller's input to the caller's output.
+  const size_t block_samples = block_size_ * num_channels_;
+  while (output_size_ == 0 && block_fill_ == 0 &&
+         input.size() >= block_samples) {
+    FillBlock(input);
+    ProcessBlock();
+    ReadBlock(output.data());
+    input = input.subview(block_samples);
+    output = output.subview(block_samples);
+  }
+
+  Push(input);
+  const size_t num_frames = Pull(output);
+  RTC_DCHECK_EQ(output.size(), num_frames * num_channels_)
+      << "Chunk size differs from the one given at construction.";
+}
+
+size_t NoiseSuppressionStream::FillBlock(rtc::ArrayView<const float> input) {
+  const size_t num_frames =
+      std::min(block_size_ - block_fill_, input.size() / num_channels_);
+  if (input_block_) {
+    // Scaled to the S16 range by AudioBuffer::CopyFrom().
+    float* const* channels = input_block_->channels();
+    for (size_t ch = 0; ch < num_channels_; ++ch) {
+      float* block = channels[ch] + block_fill_;
+      for (size_t k = 0; k < num_frames; ++k) {
+        block[k] = input[k * num_channels_ + ch];
+      }
+    }
+  } else {
+    float* const* channels = audio_.channels();
+    for (size_t ch = 0; ch < num_channels_; ++ch) {
+      float* block = channels[ch] + block_fill_;
+      for (size_t k = 0; k < num_frames; ++k) {
+        block[k] = FloatToFloatS16(input[k * num_channels_ + ch]);
+      }
+    }
+  }
+  block_fill_ += num_frames;
+  return num_frames;
+}
+
+void NoiseSuppressionStream::ProcessBlock() {
+  RTC_DCHECK_EQ(block_size_, block_fill_);
+  if (input_block_) {
+    audio_.CopyFrom(input_block_->channels());
+  }
+  suppressor_.ProcessChunk(&audio_);
+  if (output_block_) {
+    audio_.CopyTo(output_block_->channels());
+  }
+  block_fill_ = 0;
+}
+
+void NoiseSuppressionStream::ReadBlock(float* output) const {
+  if (output_block_) {
+    const float* const* channels = output_block_->channels();
+    for (size_t ch = 0; ch < num_channels_; ++ch) {
+      const float* block = channels[ch];
+      for (size_t k = 0; k < block_size_; ++k) {
+        output[k * num_channels_ + ch] = block[k];
+      }
+    }
+  } else {
+    const float* const* channels = audio_.channels_const();
+    for (size_t ch = 0; ch < num_channels_; ++ch) {
+      const float* block = channels[ch];
+      for (size_t k = 0; k < block_size_; ++k) {
+        output[k * num_channels_ + ch] = FloatS16ToFloat(block[k]);
+      }
+    }
+  }
+}
+
+void NoiseSuppressionStream::WriteBlockToFifo() {
+  const size_t block_samples = block_size_ * num_channels_;
+  if (output_size_ + block_samples > output_fifo_.size()) {
+    GrowFifo(output_size_ + block_samples);
+  }
+
+  const size_t capacity = output_fifo_.size();
+  const size_t write = (output_read_ + output_size_) % capacity;
+  if (write + block_samples <= capacity) {
+    ReadBlock(&output_fifo_[write]);
+  } else {
+    // The block wraps around the end of the ring.
+    ReadBlock(wrapped_block_.data());
+    const size_t first = capacity - write;
+    memcpy(&output_fifo_[write], wrapped_block_.data(), first * sizeof(float));
+    memcpy(output_fifo_.data(), wrapped_block_.data() + first,
+           (block_samples - first) * sizeof(float));
+  }
+  output_size_ += block_samples;
+}
+
+// Only reached when the caller pushes more than it pulls.
+void NoiseSuppressionStream::GrowFifo(size_t min_capacity) {
+  std::vector<float> fifo(std::max(min_capacity, 2 * output_fifo_.size()));
+  const size_t size = output_size_;
+  Pull(fifo);
+  output_fifo_.swap(fifo);
+  output_size_ = size;
+  output_read_ = 0;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_NS_NOISE_SUPPRESSION_STREAM_H_
+#define MODULES_AUDIO_PROCESSING_NS_NOISE_SUPPRESSION_STREAM_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "api/array_view.h"
+#include "common_audio/channel_buffer.h"
+#include "modules/audio_processing/audio_buffer.h"
+#include "modules/audio_processing/ns/noise_suppressor_for_rate.h"
+#include "modules/audio_processing/ns/ns_config.h"
+
+namespace webrtc {
+
+// Streaming front end for the noise suppressor. It accepts interleaved float
+// audio in [-1, 1] in chunks of any size, rebuffers it into the 10 ms blocks
+// that the suppressor operates on, and hands back the processed audio as soon
+// as it is ready. The audio is resampled to the rate that
+// NsConfig::processing_rate selects and back when that differs from the
+// stream rate. At rates that are not a multiple of 100 Hz, such as 11.025 and
+// 22.05 kHz, the blocks are NsChunkSizeMs() long instead, 40 and 20 ms, so
+// that they hold a whole number of samples.
+//
+// Without resampling, input is deinterleaved straight into the block that is
+// being filled, so no intermediate copy is made. When Process() is used with
+// chunks that are a multiple of the block size, the output is also written
+// straight to the caller's buffer.
+class NoiseSuppressionStream {
+ public:
+  // |chunk_size_frames| is the number of frames per channel that the caller
+  // passes to each Process() call, or zero if it varies. It only affects the
+  // latency that Process() needs; Push() and Pull() accept any size.
+  NoiseSuppressionStream(const NsConfig& config,
+                         size_t sample_rate_hz,
+                         size_t num_channels,
+                         size_t chunk_size_frames = 0);
+  NoiseSuppressionStream(const NoiseSuppressionStream&) = delete;
+  NoiseSuppressionStream& operator=(const NoiseSuppressionStream&) = delete;
+  ~NoiseSuppressionStream();
+
+  // Appends interleaved samples to the stream and processes every block that
+  // they complete. The size must be a multiple of the number of channels.
+  void Push(rtc::ArrayView<const float> input);
+
+  // Copies up to output.size() / num_channels frames of processed
+  // interleaved audio to |output| and returns the number of frames copied.
+  size_t Pull(rtc::ArrayView<float> output);
+
+  // Pushes |input| and pulls the same number of frames into |output|. The
+  // output is always complete and lags the input by latency_frames().
+  void Process(rtc::ArrayView<const float> input, rtc::ArrayView<float> output);
+
+  // Returns the number of processed frames that Pull() can return.
+  size_t num_frames_available() const { return output_size_ / num_channels_; }
+
+  // Returns the delay that the rebuffering adds, in frames at the stream
+  // rate: the first latency_frames() frames produced are silence. This is
+  // block_size_frames() - 1 for varying chunk sizes and
+  // block_size_frames() - gcd(chunk size, block size) for a fixed chunk
+  // size. The suppressor itself adds NoiseSuppressor::kFilterbankDelaySamples
+  // of delay at the split-band rate on top of this, or
+  // FullBandNoiseSuppressor::kFilterbankDelaySamples at 48 kHz on the full
+  // band, see suppressor(), plus the delay of the band-split filters at 32
+  // and 48 kHz and resampling_delay_seconds().
+  size_t latency_frames() const { return latency_frames_; }
+
+  // Returns the delay of the resampling to the processing rate and back, or
+  // zero when the stream is processed at its own rate.
+  float resampling_delay_seconds() const;
+
+  // Returns the number of frames per channel in a processing block.
+  size_t block_size_frames() const { return block_size_; }
+
+  // Returns the rate that the suppressor runs at.
+  size_t processing_rate_hz() const { return processing_rate_hz_; }
+
+  const NoiseSuppressorForRate& suppressor() const { return suppressor_; }
+
+  size_t num_channels() const { return num_channels_; }
+
+ private:
+  // Deinterleaves up to a block's worth of |input| into the block being
+  // filled and returns the number of frames consumed.
+  size_t FillBlock(rtc::ArrayView<const float> input);
+  // Runs the suppressor on the filled block.
+  void ProcessBlock();
+  // Interleaves the processed block into |output|.
+  void ReadBlock(float* output) const;
+  // Appends the processed block to the output FIFO.
+  void WriteBlockToFifo();
+  void GrowFifo(size_t min_capacity);
+
+  const size_t sample_rate_hz_;
+  const size_t processing_rate_hz_;
+  const size_t num_channels_;
+  const size_t block_size_;
+  const size_t latency_frames_;
+  NoiseSuppressorForRate suppressor_;
+  AudioBuffer audio_;
+  // Blocks at the stream rate, used when resampling.
+  std::unique_ptr<ChannelBuffer<float>> input_block_;
+  std::unique_ptr<ChannelBuffer<float>> output_block_;
+  // Number of frames in the block being filled.
+  size_t block_fill_ = 0;
+  // Holds a block that wraps around the end of the output FIFO.
+  std::vector<float> wrapped_block_;
+
+  // Interleaved FIFO of processed samples, used as a ring buffer.
+  std::vector<float> output_fifo_;
+  size_t output_read_ = 0;
+  size_t output_size_ = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_NOISE_SUPPRESSION_STREAM_H_
@@ -11,6 +11,9 @@
 #ifndef MODULES_AUDIO_PROCESSING_NS_NOISE_SUPPRESSOR_H_
 #define MODULES_AUDIO_PROCESSING_NS_NOISE_SUPPRESSOR_H_
 
+#include <stdint.h>
+
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -20,45 +23,210 @@
 #include "modules/audio_processing/ns/ns_common.h"
 #include "modules/audio_processing/ns/ns_config.h"
 #include "modules/audio_processing/ns/ns_fft.h"
+#include "modules/audio_processing/ns/ns_thread_pool.h"
 #include "modules/audio_processing/ns/speech_probability_estimator.h"
 #include "modules/audio_processing/ns/wiener_filter.h"
+#include "rtc_base/memory/aligned_malloc.h"
 
 namespace webrtc {
 
-// Class for suppressing noise in a signal.
-class NoiseSuppressor {
+// Class for suppressing noise in a signal. The block layout sets the frame
+// size, the FFT size and the band rate of the filterbank; see NoiseSuppressor,
+// LowLatencyNoiseSuppressor and FullBandNoiseSuppressor below.
+template <typename Layout>
+class BasicNoiseSuppressor {
  public:
-  NoiseSuppressor(const NsConfig& config,
-                  size_t sample_rate_hz,
-                  size_t num_channels);
-  NoiseSuppressor(const NoiseSuppressor&) = delete;
-  NoiseSuppressor& operator=(const NoiseSuppressor&) = delete;
+  static constexpr size_t kNsFrameSize = Layout::kNsFrameSize;
+  static constexpr size_t kFftSize = Layout::kFftSize;
+  static constexpr size_t kFftSizeBy2Plus1 = Layout::kFftSizeBy2Plus1;
+  static constexpr size_t kOverlapSize = Layout::kOverlapSize;
+  static constexpr size_t kBandRateHz = Layout::kBandRateHz;
+
+  // Algorithmic delay of the filterbank, in samples at kBandRateHz.
+  // Callers that buffer their input into frames add kNsFrameSize samples of
+  // blocking delay on top of this.
+  static constexpr size_t kFilterbankDelaySamples = kOverlapSize;
+
+  // Creates a suppressor that uses the generic processing path, which
+  // supports any number of channels and bands.
+  BasicNoiseSuppressor(const NsConfig& config,
+                       size_t sample_rate_hz,
+                       size_t num_channels);
+  BasicNoiseSuppressor(const BasicNoiseSuppressor&) = delete;
+  BasicNoiseSuppressor& operator=(const BasicNoiseSuppressor&) = delete;
+  ~BasicNoiseSuppressor();
+
+  // Creates a suppressor that uses processing specialized at compile time for
+  // the number of channels and bands, when such a specialization exists
+  // (currently mono 16 kHz and stereo 48 kHz), and the generic path otherwise.
+  static std::unique_ptr<BasicNoiseSuppressor> Create(const NsConfig& config,
+                                                      size_t sample_rate_hz,
+                                                      size_t num_channels);
+
+  // Returns whether a compile-time specialization is used for the processing.
+  bool is_specialized() const {
+    return specialization_ != Specialization::kGeneric;
+  }
 
   // Analyses the signal (typically applied before the AEC to avoid analyzing
   // any comfort noise signal).
   void Analyze(const AudioBuffer& audio);
 
+  // Analyses the signal given as 16 bit split-band frames. The frames are
+  // indexed as split_bands[ch * num_bands + band] and each holds kNsFrameSize
+  // samples.
+  void Analyze(rtc::ArrayView<const int16_t* const> split_bands);
+
   // Applies noise suppression.
   void Process(AudioBuffer* audio);
 
+  // Applies noise suppression to 16 bit split-band frames laid out as for
+  // Analyze. The output is saturated to the 16 bit range and may alias the
+  // input.
+  void Process(rtc::ArrayView<const int16_t* const> input,
+               rtc::ArrayView<int16_t* const> output);
+
+  // Analyzes and processes |num_frames| consecutive frames, with the same
+  // output as calling Analyze and Process on each frame in turn. The signals
+  // are laid out as the split-band frames of Analyze, each holding
+  // num_frames * kNsFrameSize samples, and the output may alias the input.
+  // For offline processing; the frames are processed back to back without the
+  // per-frame dispatch and AudioBuffer copies. With more than two channels the
+  // call allocates the frame pointers.
+  void ProcessBlock(rtc::ArrayView<const float* const> input,
+                    rtc::ArrayView<float* const> output,
+                    size_t num_frames);
+  void ProcessBlock(rtc::ArrayView<const int16_t* const> input,
+                    rtc::ArrayView<int16_t* const> output,
+                    size_t num_frames);
+
+  // Analyzes |num_frames| consecutive frames laid out as for ProcessBlock,
+  // with the same state as calling Analyze on each frame in turn.
+  void AnalyzeBlock(rtc::ArrayView<const float* const> input,
+                    size_t num_frames);
+  void AnalyzeBlock(rtc::ArrayView<const int16_t* const> input,
+                    size_t num_frames);
+
+  // Initializes the noise and speech estimates of every channel to the
+  // average of those of |analyzers|, suppressors with the same configuration
+  // that have analyzed parts of a signal, e.g. in parallel with AnalyzeBlock.
+  // Processing the signal afterwards applies the profile learned over all of
+  // it from the first frame on, instead of adapting during the first few
+  // seconds. The filterbank memories are kept.
+  void InitializeFromAnalyses(
+      rtc::ArrayView<const BasicNoiseSuppressor* const> analyzers);
+
+  // Spectral-domain versions of Analyze and Process, for callers that already
+  // run a filterbank with the frame and FFT sizes of the layout on the lowest
+  // band, e.g. one shared with an echo canceller. They save the FFT and the
+  // inverse FFT of every channel and frame. The spectra are given per channel
+  // as the first kFftSizeBy2Plus1 bins, real[ch] and imag[ch], of the
+  // kFftSize point transform of the windowed frame in the S16 range, with the
+  // sign convention and scaling of NrFft. FilterBankWindow() returns the
+  // window of the time-domain path.
+  //
+  // AnalyzeSpectrum updates the noise and speech estimates as Analyze does,
+  // except that frames are skipped as silent based on their windowed energy.
+  void AnalyzeSpectrum(rtc::ArrayView<const float* const> real,
+                       rtc::ArrayView<const float* const> imag);
+
+  // Computes the suppression gains as Process does, including the overall
+  // scaling of the filter, writes them to |gains| and multiplies the spectra
+  // by them in place. Returns the gain for the bands above the first, which
+  // the caller applies after delaying those bands to match its filterbank.
+  // The bypass of NsConfig::Bypass does not apply.
+  float ProcessSpectrum(rtc::ArrayView<float* const> real,
+                        rtc::ArrayView<float* const> imag,
+                        rtc::ArrayView<float, kFftSizeBy2Plus1> gains);
+
+  // Returns the window that the filterbank applies before the FFT and after
+  // the inverse FFT.
+  static std::array<float, kFftSize> FilterBankWindow();
+
+  // Returns the fraction of the frames given to Process that bypassed the
+  // spectral processing, see NsConfig::Bypass.
+  float bypassed_fraction() const {
+    return num_processed_frames_ > 0
+               ? static_cast<float>(num_bypassed_frames_) /
+                     num_processed_frames_
+               : 0.f;
+  }
+
+  // Returns the memory used by the suppressor in bytes: the object, the
+  // channel states and the FFT tables, and the scratch buffers allocated for
+  // more than two channels.
+  size_t MemoryUsage() const;
+
+  // Runs the per-channel work of Analyze and Process on |thread_pool|, or
+  // serially on the calling thread if it is null. The channels only
+  // synchronize where their filters and gains are aggregated. The pool is not
+  // owned and can be shared by suppressors that are not run concurrently.
+  void SetThreadPool(NsThreadPool* thread_pool) { thread_pool_ = thread_pool; }
+
  private:
+  // Channel and band configurations with specialized processing.
+  enum class Specialization { kGeneric, kMono1Band, kStereo3Bands };
+
+  // Reason for bypassing the spectral processing of a frame.
+  enum class BypassMode { kNone, kSilence, kUnityGain };
+
+  BasicNoiseSuppressor(const NsConfig& config,
+                       size_t sample_rate_hz,
+                       size_t num_channels,
+                       Specialization specialization);
+
   const size_t num_bands_;
   const size_t num_channels_;
+  const Specialization specialization_;
   const SuppressionParams suppression_params_;
   int32_t num_analyzed_frames_ = -1;
-  NrFft fft_;
+  NrFft<Layout> fft_;
+
+  // Bypass configuration, with the silence levels as mean squares of
+  // samples in the S16 range.
+  const NsConfig::Bypass bypass_config_;
+  const float silence_threshold_;
+  const float silence_release_threshold_;
+  BypassMode bypass_mode_ = BypassMode::kNone;
+  int num_silent_frames_ = 0;
+  int num_unity_gain_frames_ = 0;
+  int num_frames_since_unity_check_ = 0;
+  int64_t num_processed_frames_ = 0;
+  int64_t num_bypassed_frames_ = 0;
+  NsThreadPool* thread_pool_ = nullptr;
+
+  // Decimation of the estimator updates, see NsConfig::Complexity: the
+  // estimators are updated on one frame in |estimator_update_interval_|, and
+  // with |reuse_wiener_filter_| the Wiener filters only on those frames.
+  // |estimator_update_frame_| tells whether the last analyzed frame was one.
+  const int estimator_update_interval_;
+  const bool reuse_wiener_filter_;
+  int estimator_update_phase_ = 0;
+  bool estimator_update_frame_ = true;
 
+  // State of one channel. The members are ordered as Analyze and Process
+  // access them, and the per-bin arrays are cache-line aligned.
   struct ChannelState {
-    ChannelState(const SuppressionParams& suppression_params, size_t num_bands);
-
-    SpeechProbabilityEstimator speech_probability_estimator;
-    WienerFilter wiener_filter;
-    NoiseEstimator noise_estimator;
-    std::array<float, kFftSizeBy2Plus1> prev_analysis_signal_spectrum;
-    std::array<float, kFftSize - kNsFrameSize> analyze_analysis_memory;
-    std::array<float, kOverlapSize> process_analysis_memory;
-    std::array<float, kOverlapSize> process_synthesis_memory;
-    std::vector<std::array<float, kOverlapSize>> process_delay_memory;
+    explicit ChannelState(const SuppressionParams& suppression_params);
+
+    alignas(kNsStateAlignment)
+        std::array<float, kOverlapSize> analyze_analysis_memory;
+    NoiseEstimator<Layout> noise_estimator;
+    WienerFilter<Layout> wiener_filter;
+    alignas(kNsStateAlignment)
+        std::array<float, kFftSizeBy2Plus1> prev_analysis_signal_spectrum;
+    SpeechProbabilityEstimator<Layout> speech_probability_estimator;
+    alignas(kNsStateAlignment)
+        std::array<float, kOverlapSize> process_analysis_memory;
+    alignas(kNsStateAlignment)
+        std::array<float, kOverlapSize> process_synthesis_memory;
+    // Delay lines for the bands above the first, each alternating between
+    // two buffers so that the frame can be delayed in place in one pass.
+    // |process_delay_slot| is the buffer holding the delayed samples.
+    alignas(kNsStateAlignment) std::array<
+        std::array<std::array<float, kOverlapSize>, 2>,
+        AudioBuffer::kMaxNumBands - 1> process_delay_memory;
+    size_t process_delay_slot = 0;
   };
 
   struct FilterBankState {
@@ -71,13 +239,130 @@ class NoiseSuppressor {
   std::vector<float> upper_band_gains_heap_;
   std::vector<float> energies_before_filtering_heap_;
   std::vector<float> gain_adjustments_heap_;
-  std::vector<std::unique_ptr<ChannelState>> channels_;
+  // The channel states, constructed in one contiguous kNsStateAlignment
+  // aligned block of memory.
+  std::unique_ptr<ChannelState, AlignedFreeDeleter> channel_arena_;
+  ChannelState* const channels_;
+
+  // Calls f(ch) for every channel, in parallel if a thread pool is set.
+  template <typename F>
+  void ForEachChannel(size_t num_channels, const F& f) {
+    if (thread_pool_ && num_channels > 1) {
+      thread_pool_->ParallelFor(num_channels, f);
+    } else {
+      for (size_t ch = 0; ch < num_channels; ++ch) {
+        f(ch);
+      }
+    }
+  }
 
   // Aggregates the Wiener filters into a single filter to use.
+  template <size_t kNumChannels>
   void AggregateWienerFilters(
       rtc::ArrayView<float, kFftSizeBy2Plus1> filter) const;
+
+  // Advances the estimator update phase by a frame and returns whether the
+  // estimators are updated on the frame.
+  bool AdvanceEstimatorUpdatePhase();
+
+  // Updates the estimators of channel |ch| with the spectrum of its frame to
+  // analyze.
+  void AnalyzeChannel(size_t ch,
+                      rtc::ArrayView<const float> real,
+                      rtc::ArrayView<const float> imag);
+
+  // Updates the Wiener filter of channel |ch| with the spectrum of its frame
+  // to process, unless it is reused on the frame. Returns the gain for the
+  // upper bands if there are any.
+  float UpdateChannelFilter(size_t ch,
+                            size_t num_bands,
+                            rtc::ArrayView<const float> real,
+                            rtc::ArrayView<const float> imag);
+
+  // Forwards the calls to the implementation selected by |specialization_|.
+  template <typename T>
+  void AnalyzeSpecialized(rtc::ArrayView<const T* const> split_bands);
+  template <typename T>
+  void ProcessSpecialized(rtc::ArrayView<const T* const> input,
+                          rtc::ArrayView<T* const> output);
+  template <typename T>
+  void ProcessBlockSpecialized(rtc::ArrayView<const T* const> input,
+                               rtc::ArrayView<T* const> output,
+                               size_t num_frames);
+
+  // Sample format agnostic implementations of Analyze and Process. Non-zero
+  // values of kNumChannels and kNumBands fix the number of channels and bands
+  // at compile time; zero means that they are given by the configuration.
+  template <typename T, size_t kNumChannels, size_t kNumBands>
+  void AnalyzeInternal(rtc::ArrayView<const T* const> split_bands);
+  template <typename T, size_t kNumChannels, size_t kNumBands>
+  void ProcessInternal(rtc::ArrayView<const T* const> input,
+                       rtc::ArrayView<T* const> output);
+  template <typename T, size_t kNumChannels, size_t kNumBands>
+  void ProcessBlockInternal(rtc::ArrayView<const T* const> input,
+                            rtc::ArrayView<T* const> output,
+                            size_t num_frames);
+
+  // Delays the upper bands of channel |ch| to match the filterbank and
+  // applies |gain|.
+  template <typename T>
+  void ProcessUpperBands(rtc::ArrayView<const T* const> input,
+                         rtc::ArrayView<T* const> output,
+                         size_t ch,
+                         size_t num_bands,
+                         float gain);
+
+  // Updates the bypass state for a frame to process and returns whether and
+  // why its spectral processing is bypassed.
+  template <typename T>
+  BypassMode SelectBypassMode(rtc::ArrayView<const T* const> input,
+                              size_t num_channels,
+                              size_t num_bands);
+
+  // Produces the output for a bypassed frame: the input with the filterbank
+  // delay, scaled by |gain|, and with the filterbank memories updated as if
+  // the frame had been processed with a flat filter.
+  template <typename T>
+  void BypassFrame(rtc::ArrayView<const T* const> input,
+                   rtc::ArrayView<T* const> output,
+                   size_t num_channels,
+                   size_t num_bands,
+                   float gain);
 };
 
+// Suppressor operating on 10 ms frames.
+using NoiseSuppressor = BasicNoiseSuppressor<Ns10msLayout>;
+
+// Suppressor operating on 5 ms frames, halving the blocking and filterbank
+// delays at the cost of a coarser frequency resolution.
+using LowLatencyNoiseSuppressor = BasicNoiseSuppressor<Ns5msLayout>;
+
+// Suppressor operating on 10 ms frames of 48 kHz audio as a single band, with
+// a 1024 point FFT over the full band instead of the band-split filters and
+// the scalar gain of the bands above 8 kHz. The frames are taken from
+// AudioBuffer::channels(), so SplitIntoFrequencyBands() and
+// MergeFrequencyBands() are not needed. The filterbank overlap is 288 samples,
+// the 6 ms of NoiseSuppressor, which gives the same delay without the delay
+// of the band-split filters.
+using FullBandNoiseSuppressor = BasicNoiseSuppressor<Ns48kFullBandLayout>;
+
+// Returns the rate that the suppressor should run at for audio at
+// |sample_rate_hz|, as selected by |processing_rate|; any other rate is
+// resampled to the returned one, e.g. by an AudioBuffer with this buffer rate.
+// Rates up to 16 kHz run at 16 kHz. Above that, ProcessingRate::k16kHz runs
+// 32 and 48 kHz natively with the band split and every other rate at 16 kHz,
+// and ProcessingRate::k48kHz runs every rate at 48 kHz on the full band, see
+// NsProcessesFullBand(). Rates that are not a multiple of 100 Hz, such as
+// 11.025 and 22.05 kHz, have no whole 10 ms frames and are resampled in longer
+// chunks, see NsChunkSizeMs().
+size_t NsProcessingRateHz(size_t sample_rate_hz,
+                          NsConfig::ProcessingRate processing_rate);
+
+// Returns whether audio at |sample_rate_hz| is processed by
+// FullBandNoiseSuppressor at 48 kHz rather than by NoiseSuppressor.
+bool NsProcessesFullBand(size_t sample_rate_hz,
+                         NsConfig::ProcessingRate processing_rate);
+
 }  // namespace webrtc
 
 #endif  // MODULES_AUDIO_PROCESSING_NS_NOISE_SUPPRESSOR_H_
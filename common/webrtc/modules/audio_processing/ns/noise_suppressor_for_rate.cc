@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/ns/noise_suppressor_for_rate.h"
+
+#include <string.h>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+size_t NsChunkSizeMs(size_t sample_rate_hz) {
+  RTC_DCHECK_LT(0, sample_rate_hz);
+  size_t chunk_size_ms = 10;
+  while (sample_rate_hz * chunk_size_ms % 1000 != 0) {
+    chunk_size_ms += 10;
+  }
+  return chunk_size_ms;
+}
+
+NoiseSuppressorForRate::NoiseSuppressorForRate(const NsConfig& config,
+                                               size_t sample_rate_hz,
+                                               size_t num_channels)
+    : processing_rate_hz_(
+          NsProcessingRateHz(sample_rate_hz, config.processing_rate)) {
+  if (NsProcessesFullBand(sample_rate_hz, config.processing_rate)) {
+    full_band_ = FullBandNoiseSuppressor::Create(config, processing_rate_hz_,
+                                                 num_channels);
+  } else {
+    split_band_ =
+        NoiseSuppressor::Create(config, processing_rate_hz_, num_channels);
+  }
+  if (NsChunkSizeMs(sample_rate_hz) > AudioBuffer::kDefaultChunkSizeMs) {
+    frame_.reset(new AudioBuffer(processing_rate_hz_, num_channels,
+                                 processing_rate_hz_, num_channels,
+                                 processing_rate_hz_, num_channels));
+  }
+}
+
+NoiseSuppressorForRate::~NoiseSuppressorForRate() = default;
+
+void NoiseSuppressorForRate::ProcessFrame(AudioBuffer* audio) {
+  if (full_band_) {
+    full_band_->Analyze(*audio);
+    full_band_->Process(audio);
+    return;
+  }
+  if (audio->num_bands() > 1) {
+    audio->SplitIntoFrequencyBands();
+  }
+  split_band_->Analyze(*audio);
+  split_band_->Process(audio);
+  if (audio->num_bands() > 1) {
+    audio->MergeFrequencyBands();
+  }
+}
+
+void NoiseSuppressorForRate::ProcessChunk(AudioBuffer* audio) {
+  if (!frame_) {
+    ProcessFrame(audio);
+    return;
+  }
+  const size_t frame_size = frame_->num_frames();
+  RTC_DCHECK_EQ(0, audio->num_frames() % frame_size);
+  RTC_DCHECK_EQ(frame_->num_channels(), audio->num_channels());
+  for (size_t i = 0; i < audio->num_frames(); i += frame_size) {
+    for (size_t ch = 0; ch < audio->num_channels(); ++ch) {
+      memcpy(frame_->channels()[ch], audio->channels_const()[ch] + i,
+             frame_size * sizeof(float));
+    }
+    ProcessFrame(frame_.get());
+    for (size_t ch = 0; ch < audio->num_channels(); ++ch) {
+      memcpy(audio->channels()[ch] + i, frame_->channels_const()[ch],
+             frame_size * sizeof(float));
+    }
+  }
+}
+
+float NoiseSuppressorForRate::filterbank_delay_seconds() const {
+  if (full_band_) {
+    return static_cast<float>(FullBandNoiseSuppressor::kFilterbankDelaySamples) /
+           FullBandNoiseSuppressor::kBandRateHz;
+  }
+  return static_cast<float>(NoiseSuppressor::kFilterbankDelaySamples) /
+         NoiseSuppressor::kBandRateHz;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_NS_NOISE_SUPPRESSOR_FOR_RATE_H_
+#define MODULES_AUDIO_PROCESSING_NS_NOISE_SUPPRESSOR_FOR_RATE_H_
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "modules/audio_processing/audio_buffer.h"
+#include "modules/audio_processing/ns/noise_suppressor.h"
+#include "modules/audio_processing/ns/ns_config.h"
+
+namespace webrtc {
+
+// Returns the length of the shortest chunk of whole 10 ms frames that holds a
+// whole number of samples at |sample_rate_hz|, and so can be resampled to the
+// processing rate: 10 ms for multiples of 100 Hz, 20 ms at 22.05 kHz and 40 ms
+// at 11.025 kHz.
+size_t NsChunkSizeMs(size_t sample_rate_hz);
+
+// The suppressor that NsConfig::processing_rate selects for audio at
+// |sample_rate_hz|: NoiseSuppressor at NsProcessingRateHz(), or
+// FullBandNoiseSuppressor where that selects full-band processing. It runs on
+// 10 ms AudioBuffers with NsProcessingRateHz() as the buffer rate, which
+// resample the audio when that differs from the input rate. Rates that are not
+// a multiple of 100 Hz are resampled in AudioBuffers of NsChunkSizeMs() and
+// processed with ProcessChunk().
+class NoiseSuppressorForRate {
+ public:
+  NoiseSuppressorForRate(const NsConfig& config,
+                         size_t sample_rate_hz,
+                         size_t num_channels);
+  NoiseSuppressorForRate(const NoiseSuppressorForRate&) = delete;
+  NoiseSuppressorForRate& operator=(const NoiseSuppressorForRate&) = delete;
+  ~NoiseSuppressorForRate();
+
+  // Analyzes and processes the frame in |audio|, with the band split and
+  // merge that the split-band suppressor needs at 32 and 48 kHz.
+  void ProcessFrame(AudioBuffer* audio);
+
+  // Processes |audio|, which holds NsChunkSizeMs() of audio at the processing
+  // rate, one 10 ms frame at a time. The frames are copied through a 10 ms
+  // buffer when the chunk is longer than a frame.
+  void ProcessChunk(AudioBuffer* audio);
+
+  size_t processing_rate_hz() const { return processing_rate_hz_; }
+  bool full_band() const { return full_band_ != nullptr; }
+
+  // Returns the delay of the filterbank of the suppressor, without that of
+  // the band-split filters and of the resampling.
+  float filterbank_delay_seconds() const;
+
+ private:
+  const size_t processing_rate_hz_;
+  std::unique_ptr<NoiseSuppressor> split_band_;
+  std::unique_ptr<FullBandNoiseSuppressor> full_band_;
+  // 10 ms buffer at the processing rate for ProcessChunk(), or null when the
+  // chunks are single frames.
+  std::unique_ptr<AudioBuffer> frame_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_NOISE_SUPPRESSOR_FOR_RATE_H_
@@ -15,10 +15,91 @@
 
 namespace webrtc {
 
-constexpr size_t kFftSize = 256;
-constexpr size_t kFftSizeBy2Plus1 = kFftSize / 2 + 1;
-constexpr size_t kNsFrameSize = 160;
-constexpr size_t kOverlapSize = kFftSize - kNsFrameSize;
+// Describes the block structure of the suppressor: the number of new samples
+// per frame (the hop size), the size of the FFT used by the filterbank, the
+// rate of the band that the filterbank runs on and the overlap between
+// consecutive frames. Input at higher rates is split into bands of that rate,
+// and the bands above the first bypass the filterbank. The windowed frame
+// spans kWindowSize = frame_size + overlap_size samples, and the FFT input is
+// zero-padded from there up to fft_size.
+template <size_t frame_size,
+          size_t fft_size,
+          size_t band_rate_hz = 16000,
+          size_t overlap_size = fft_size - frame_size>
+struct NsBlockLayout {
+  static_assert(overlap_size > 0, "The frames must overlap");
+  static_assert(frame_size + overlap_size <= fft_size,
+                "The FFT must cover the windowed frame");
+  static_assert(overlap_size <= frame_size, "The overlap must fit a frame");
+  static_assert((fft_size & (fft_size - 1)) == 0, "FFT size must be 2^n");
+
+  static constexpr size_t kNsFrameSize = frame_size;
+  static constexpr size_t kFftSize = fft_size;
+  static constexpr size_t kFftSizeBy2Plus1 = kFftSize / 2 + 1;
+  static constexpr size_t kOverlapSize = overlap_size;
+  static constexpr size_t kWindowSize = kNsFrameSize + kOverlapSize;
+  static constexpr size_t kBandRateHz = band_rate_hz;
+};
+
+template <size_t frame_size,
+          size_t fft_size,
+          size_t band_rate_hz,
+          size_t overlap_size>
+constexpr size_t
+    NsBlockLayout<frame_size, fft_size, band_rate_hz, overlap_size>::
+        kNsFrameSize;
+template <size_t frame_size,
+          size_t fft_size,
+          size_t band_rate_hz,
+          size_t overlap_size>
+constexpr size_t
+    NsBlockLayout<frame_size, fft_size, band_rate_hz, overlap_size>::
+        kFftSize;
+template <size_t frame_size,
+          size_t fft_size,
+          size_t band_rate_hz,
+          size_t overlap_size>
+constexpr size_t
+    NsBlockLayout<frame_size, fft_size, band_rate_hz, overlap_size>::
+        kFftSizeBy2Plus1;
+template <size_t frame_size,
+          size_t fft_size,
+          size_t band_rate_hz,
+          size_t overlap_size>
+constexpr size_t
+    NsBlockLayout<frame_size, fft_size, band_rate_hz, overlap_size>::
+        kOverlapSize;
+template <size_t frame_size,
+          size_t fft_size,
+          size_t band_rate_hz,
+          size_t overlap_size>
+constexpr size_t
+    NsBlockLayout<frame_size, fft_size, band_rate_hz, overlap_size>::
+        kWindowSize;
+template <size_t frame_size,
+          size_t fft_size,
+          size_t band_rate_hz,
+          size_t overlap_size>
+constexpr size_t
+    NsBlockLayout<frame_size, fft_size, band_rate_hz, overlap_size>::
+        kBandRateHz;
+
+// 10 ms frames with a 256 point FFT.
+using Ns10msLayout = NsBlockLayout<160, 256>;
+
+// 5 ms frames with a 128 point FFT, for low-latency applications.
+using Ns5msLayout = NsBlockLayout<80, 128>;
+
+// 10 ms frames of the full 48 kHz band with a 1024 point FFT, which replaces
+// the band-split filters and the scalar gain of the upper bands. The frames
+// overlap by 6 ms as in the 10 ms layout, and the 768 sample windowed frame
+// is zero-padded to the FFT size.
+using Ns48kFullBandLayout = NsBlockLayout<480, 1024, 48000, 288>;
+
+// Alignment of the per-bin arrays of the channel state: one cache line. Each
+// array starts on its own line and is thereby padded to a multiple of the SIMD
+// width (e.g. 129 bins take 144 floats).
+constexpr size_t kNsStateAlignment = 64;
 
 constexpr int kShortStartupPhaseBlocks = 50;
 constexpr int kLongStartupPhaseBlocks = 200;
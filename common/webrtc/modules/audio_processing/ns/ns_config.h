@@ -17,6 +17,52 @@ namespace webrtc {
 struct NsConfig {
   enum class SuppressionLevel { k6dB, k12dB, k18dB, k21dB };
   SuppressionLevel target_level = SuppressionLevel::k12dB;
+
+  // Speed/quality choice for the processing of input above 16 kHz; see
+  // NsProcessingRateHz(). k16kHz runs the spectral processing on the
+  // 0-8 kHz band only: 32 and 48 kHz input is band-split and the bands above
+  // take its gain, and input at other rates, e.g. 44.1 or 96 kHz, is
+  // resampled to 16 kHz and back, so that the output keeps only its 0-8 kHz
+  // band. k48kHz resamples any such input to 48 kHz and runs the spectral
+  // processing on the full band with FullBandNoiseSuppressor, at about three
+  // times the cost for input that k16kHz resamples to 16 kHz and about the
+  // cost of the band split at 48 kHz. Input up to 16 kHz is processed at
+  // 16 kHz with either.
+  enum class ProcessingRate { k16kHz, k48kHz };
+  ProcessingRate processing_rate = ProcessingRate::k16kHz;
+
+  // Bypass of the spectral processing for frames that it would not change
+  // much. Near-silent frames get the minimum attenuating gain and frames for
+  // which the suppression filter has converged to unity pass unchanged; both
+  // are only delayed like processed frames, so the output stays continuous.
+  struct Bypass {
+    bool enabled = false;
+    // Frames whose level in the lowest band is below this are near-silent.
+    float silence_threshold_dbfs = -60.f;
+    // Hysteresis: once bypassed, near-silence lasts until the level exceeds
+    // the threshold by this much.
+    float silence_release_db = 6.f;
+    // The filter is at unity when no bin, nor the overall and upper band
+    // gains, is further than this from 1.
+    float unity_gain_tolerance = 0.02f;
+    // Number of consecutive qualifying frames before the bypass starts.
+    int hold_frames = 5;
+    // While bypassing a unity filter, one frame in this many is processed
+    // to check that the filter is still at unity.
+    int unity_recheck_interval = 10;
+  } bypass;
+
+  // Complexity of the noise and speech estimation, which trades suppression
+  // quality for CPU, e.g. to fit more streams per core on a loaded server.
+  // Below kFull the quantile noise estimator, the signal model estimator and
+  // the speech probability are updated on one frame in 2 (kMedium) or 4
+  // (kLow). Their time constants count updates, so the estimates adapt that
+  // much slower, except for the feature histograms, which keep their window
+  // of frames and get one entry per update. The filterbank and the gains run
+  // on every frame; kLow also reuses the Wiener filter of the last update in
+  // between. The cost of each level is measured by "ns_bench complexity".
+  enum class Complexity { kFull, kMedium, kLow };
+  Complexity complexity = Complexity::kFull;
 };
 
 }  // namespace webrtc
@@ -10,11 +10,45 @@
 
 #include "modules/audio_processing/ns/ns_fft.h"
 
+#include <array>
+
 #include "common_audio/third_party/fft4g/fft4g.h"
 
 namespace webrtc {
+namespace {
+
+// Size of the work area WebRtc_rdft needs for an FFT of size fft_size: the two
+// table sizes followed by 2 + sqrt(fft_size / 2) entries that the bit reversal
+// rewrites on every transform.
+constexpr size_t BitReversalScratchSize(size_t fft_size) {
+  size_t root = 1;
+  while (root * root < fft_size / 2) {
+    ++root;
+  }
+  return 2 + root;
+}
+
+// Runs WebRtc_rdft with the initialized tables left untouched. The bit
+// reversal writes to its work area on every call, so each call gets its own
+// copy of the table sizes on the stack instead of using the shared one.
+template <size_t kFftSize>
+void Rdft(int isgn,
+          float* data,
+          const std::vector<size_t>& bit_reversal_state,
+          const std::vector<float>& tables) {
+  std::array<size_t, BitReversalScratchSize(kFftSize)> scratch;
+  scratch[0] = bit_reversal_state[0];
+  scratch[1] = bit_reversal_state[1];
+  // With the table sizes set, WebRtc_rdft only reads the tables.
+  WebRtc_rdft(kFftSize, isgn, data, scratch.data(),
+              const_cast<float*>(tables.data()));
+}
+
+}  // namespace
 
-NrFft::NrFft() : bit_reversal_state_(kFftSize / 2), tables_(kFftSize / 2) {
+template <typename Layout>
+NrFft<Layout>::NrFft()
+    : bit_reversal_state_(kFftSize / 2), tables_(kFftSize / 2) {
   // Initialize WebRtc_rdt (setting (bit_reversal_state_[0] to 0 triggers
   // initialization)
   bit_reversal_state_[0] = 0.f;
@@ -24,11 +58,11 @@ NrFft::NrFft() : bit_reversal_state_(kFftSize / 2), tables_(kFftSize / 2) {
               tables_.data());
 }
 
-void NrFft::Fft(rtc::ArrayView<float, kFftSize> time_data,
-                rtc::ArrayView<float, kFftSize> real,
-                rtc::ArrayView<float, kFftSize> imag) {
-  WebRtc_rdft(kFftSize, 1, time_data.data(), bit_reversal_state_.data(),
-              tables_.data());
+template <typename Layout>
+void NrFft<Layout>::Fft(rtc::ArrayView<float, kFftSize> time_data,
+                        rtc::ArrayView<float, kFftSize> real,
+                        rtc::ArrayView<float, kFftSize> imag) const {
+  Rdft<kFftSize>(1, time_data.data(), bit_reversal_state_, tables_);
 
   imag[0] = 0;
   real[0] = time_data[0];
@@ -42,17 +76,17 @@ void NrFft::Fft(rtc::ArrayView<float, kFftSize> time_data,
   }
 }
 
-void NrFft::Ifft(rtc::ArrayView<const float> real,
-                 rtc::ArrayView<const float> imag,
-                 rtc::ArrayView<float> time_data) {
+template <typename Layout>
+void NrFft<Layout>::Ifft(rtc::ArrayView<const float> real,
+                         rtc::ArrayView<const float> imag,
+                         rtc::ArrayView<float> time_data) const {
   time_data[0] = real[0];
   time_data[1] = real[kFftSizeBy2Plus1 - 1];
   for (size_t i = 1; i < kFftSizeBy2Plus1 - 1; ++i) {
     time_data[2 * i] = real[i];
     time_data[2 * i + 1] = imag[i];
   }
-  WebRtc_rdft(kFftSize, -1, time_data.data(), bit_reversal_state_.data(),
-              tables_.data());
+  Rdft<kFftSize>(-1, time_data.data(), bit_reversal_state_, tables_);
 
   // Scale the output
   constexpr float kScaling = 2.f / kFftSize;
@@ -61,4 +95,8 @@ void NrFft::Ifft(rtc::ArrayView<const float> real,
   }
 }
 
+template class NrFft<Ns10msLayout>;
+template class NrFft<Ns5msLayout>;
+template class NrFft<Ns48kFullBandLayout>;
+
 }  // namespace webrtc
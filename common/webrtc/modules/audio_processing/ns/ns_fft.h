@@ -18,9 +18,15 @@
 
 namespace webrtc {
 
-// Wrapper class providing 256 point FFT functionality.
+// Wrapper class providing FFT functionality of the size given by the block
+// layout. The tables are only read after construction, so one instance can be
+// shared by transforms running concurrently on different threads.
+template <typename Layout>
 class NrFft {
  public:
+  static constexpr size_t kFftSize = Layout::kFftSize;
+  static constexpr size_t kFftSizeBy2Plus1 = Layout::kFftSizeBy2Plus1;
+
   NrFft();
   NrFft(const NrFft&) = delete;
   NrFft& operator=(const NrFft&) = delete;
@@ -28,12 +34,18 @@ class NrFft {
   // Transforms the signal from time to frequency domain.
   void Fft(rtc::ArrayView<float, kFftSize> time_data,
            rtc::ArrayView<float, kFftSize> real,
-           rtc::ArrayView<float, kFftSize> imag);
+           rtc::ArrayView<float, kFftSize> imag) const;
 
   // Transforms the signal from frequency to time domain.
   void Ifft(rtc::ArrayView<const float> real,
             rtc::ArrayView<const float> imag,
-            rtc::ArrayView<float> time_data);
+            rtc::ArrayView<float> time_data) const;
+
+  // Returns the size of the FFT tables in bytes.
+  size_t MemoryUsage() const {
+    return bit_reversal_state_.capacity() * sizeof(size_t) +
+           tables_.capacity() * sizeof(float);
+  }
 
  private:
   std::vector<size_t> bit_reversal_state_;
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/ns/ns_frame_ring.h"
+
+#include <string.h>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+namespace {
+
+// Rounds the channel length up to whole cache lines so that every channel
+// starts on its own line.
+size_t AlignedChannelSize(size_t num_frames) {
+  constexpr size_t kFloatsPerLine = kNsStateAlignment / sizeof(float);
+  return (num_frames + kFloatsPerLine - 1) / kFloatsPerLine * kFloatsPerLine;
+}
+
+}  // namespace
+
+NsFrameRing::NsFrameRing(size_t num_frames_per_channel,
+                         size_t num_channels,
+                         size_t capacity)
+    : num_frames_(num_frames_per_channel),
+      num_channels_(num_channels),
+      capacity_(capacity),
+      samples_(AlignedMalloc<float>(capacity * num_channels *
+                                        AlignedChannelSize(num_frames_) *
+                                        sizeof(float),
+                                    kNsStateAlignment)),
+      channels_(capacity * num_channels) {
+  RTC_DCHECK_LT(0, num_frames_);
+  RTC_DCHECK_LT(0, num_channels_);
+  RTC_DCHECK_LT(0, capacity_);
+  const size_t channel_size = AlignedChannelSize(num_frames_);
+  memset(samples_.get(), 0,
+         capacity * num_channels * channel_size * sizeof(float));
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    channels_[i] = samples_.get() + i * channel_size;
+  }
+}
+
+NsFrameRing::~NsFrameRing() = default;
+
+float* const* NsFrameRing::BeginWrite() {
+  const size_t write = write_count_.load(std::memory_order_relaxed);
+  if (write - cached_read_count_ == capacity_) {
+    cached_read_count_ = read_count_.load(std::memory_order_acquire);
+    if (write - cached_read_count_ == capacity_) {
+      return nullptr;
+    }
+  }
+  return &channels_[write % capacity_ * num_channels_];
+}
+
+void NsFrameRing::EndWrite() {
+  const size_t write = write_count_.load(std::memory_order_relaxed);
+  RTC_DCHECK_LT(write - cached_read_count_, capacity_);
+  write_count_.store(write + 1, std::memory_order_release);
+}
+
+bool NsFrameRing::Write(const float* const* channels) {
+  float* const* slot = BeginWrite();
+  if (!slot) {
+    return false;
+  }
+  for (size_t ch = 0; ch < num_channels_; ++ch) {
+    memcpy(slot[ch], channels[ch], num_frames_ * sizeof(float));
+  }
+  EndWrite();
+  return true;
+}
+
+bool NsFrameRing::WriteInterleaved(rtc::ArrayView<const float> frame) {
+  RTC_DCHECK_EQ(num_frames_ * num_channels_, frame.size());
+  float* const* slot = BeginWrite();
+  if (!slot) {
+    return false;
+  }
+  for (size_t ch = 0; ch < num_channels_; ++ch) {
+    float* channel = slot[ch];
+    for (size_t k = 0; k < num_frames_; ++k) {
+      channel[k] = frame[k * num_channels_ + ch];
+    }
+  }
+  EndWrite();
+  return true;
+}
+
+const float* const* NsFrameRing::BeginRead() {
+  const size_t read = read_count_.load(std::memory_order_relaxed);
+  if (read == cached_write_count_) {
+    cached_write_count_ = write_count_.load(std::memory_order_acquire);
+    if (read == cached_write_count_) {
+      return nullptr;
+    }
+  }
+  return &channels_[read % capacity_ * num_channels_];
+}
+
+void NsFrameRing::EndRead() {
+  const size_t read = read_count_.load(std::memory_order_relaxed);
+  RTC_DCHECK_NE(read, cached_write_count_);
+  read_count_.store(read + 1, std::memory_order_release);
+}
+
+}  // namespace webrtc
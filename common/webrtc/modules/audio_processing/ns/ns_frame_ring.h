@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_NS_NS_FRAME_RING_H_
+#define MODULES_AUDIO_PROCESSING_NS_NS_FRAME_RING_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "api/array_view.h"
+#include "modules/audio_processing/ns/ns_common.h"
+#include "rtc_base/memory/aligned_malloc.h"
+
+namespace webrtc {
+
+// Wait-free single-producer/single-consumer ring of preallocated
+// multichannel frames, for handing audio from a capture thread to a noise
+// suppression thread without locks or allocations.
+//
+// Each slot holds one frame, deinterleaved with one cache-line aligned array
+// per channel, and is exposed as a table of channel pointers. A slot being
+// read can therefore be passed directly to AudioBuffer::CopyFrom(), and a
+// slot being written can be filled in place by the producer.
+//
+// BeginWrite()/EndWrite() must only be called by the producer thread and
+// BeginRead()/EndRead() only by the consumer thread.
+class NsFrameRing {
+ public:
+  NsFrameRing(size_t num_frames_per_channel,
+              size_t num_channels,
+              size_t capacity);
+  NsFrameRing(const NsFrameRing&) = delete;
+  NsFrameRing& operator=(const NsFrameRing&) = delete;
+  ~NsFrameRing();
+
+  // Returns the channels of the next free slot, or null if the ring is full.
+  // The slot is published by EndWrite().
+  float* const* BeginWrite();
+  void EndWrite();
+
+  // Copies a frame, deinterleaved with one pointer per channel or
+  // interleaved, into the next free slot and publishes it. Returns false if
+  // the ring is full.
+  bool Write(const float* const* channels);
+  bool WriteInterleaved(rtc::ArrayView<const float> frame);
+
+  // Returns the channels of the oldest published slot, or null if the ring
+  // is empty. The slot is released to the producer by EndRead().
+  const float* const* BeginRead();
+  void EndRead();
+
+  // Number of published slots not yet released. Exact on the consumer side,
+  // a lower bound on the producer side.
+  size_t size() const {
+    return write_count_.load(std::memory_order_acquire) -
+           read_count_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+
+  size_t capacity() const { return capacity_; }
+  size_t num_frames_per_channel() const { return num_frames_; }
+  size_t num_channels() const { return num_channels_; }
+
+ private:
+  const size_t num_frames_;
+  const size_t num_channels_;
+  const size_t capacity_;
+  std::unique_ptr<float, AlignedFreeDeleter> samples_;
+  // capacity_ tables of num_channels_ channel pointers.
+  std::vector<float*> channels_;
+
+  // The counts only grow; the slot of count c is c % capacity_. Each side
+  // keeps a cached copy of the other side's count so that it only reads the
+  // shared one when the ring looks full or empty. The producer and consumer
+  // members are on separate cache lines.
+  char padding0_[kNsStateAlignment];
+  std::atomic<size_t> write_count_{0};
+  size_t cached_read_count_ = 0;
+  char padding1_[kNsStateAlignment];
+  std::atomic<size_t> read_count_{0};
+  size_t cached_write_count_ = 0;
+  char padding2_[kNsStateAlignment];
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_NS_FRAME_RING_H_
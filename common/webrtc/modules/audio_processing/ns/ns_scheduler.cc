@@ -0,0 +1,286 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/ns/ns_scheduler.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "common_audio/channel_buffer.h"
+#include "modules/audio_processing/audio_buffer.h"
+#include "modules/audio_processing/ns/noise_suppressor_for_rate.h"
+#include "modules/audio_processing/ns/ns_frame_ring.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+namespace {
+
+void PinCurrentThread(size_t worker) {
+#if defined(__linux__)
+  const size_t num_cpus = std::max(1u, std::thread::hardware_concurrency());
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(worker % num_cpus, &cpus);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+}
+
+}  // namespace
+
+// A suppressor with its queue of input frames. The deadline of each queued
+// frame is kept in a ring that follows the frame ring slot for slot.
+class NsScheduler::Stream {
+ public:
+  Stream(const NsConfig& ns_config,
+         size_t sample_rate_hz,
+         size_t num_channels,
+         size_t queue_capacity,
+         FrameCallback callback)
+      : frame_size_(sample_rate_hz / 100),
+        num_channels_(num_channels),
+        suppressor_(ns_config, sample_rate_hz, num_channels),
+        audio_(sample_rate_hz,
+               num_channels,
+               NsProcessingRateHz(sample_rate_hz, ns_config.processing_rate),
+               num_channels,
+               sample_rate_hz,
+               num_channels),
+        output_(frame_size_, num_channels),
+        frames_(frame_size_, num_channels, queue_capacity),
+        deadlines_(queue_capacity),
+        callback_(std::move(callback)) {}
+
+  // Producer side.
+  bool Push(const float* const* channels, Clock::time_point deadline) {
+    float* const* frame = frames_.BeginWrite();
+    if (!frame) {
+      frames_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    for (size_t ch = 0; ch < num_channels_; ++ch) {
+      memcpy(frame[ch], channels[ch], frame_size_ * sizeof(float));
+    }
+    deadlines_[num_pushed_++ % deadlines_.size()] = deadline;
+    frames_.EndWrite();
+    const size_t depth = frames_.size();
+    if (depth > max_queue_depth.load(std::memory_order_relaxed)) {
+      max_queue_depth.store(depth, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  // Worker side.
+  bool empty() const { return frames_.empty(); }
+  size_t queue_depth() const { return frames_.size(); }
+  Clock::time_point head_deadline() const {
+    return deadlines_[num_popped_ % deadlines_.size()];
+  }
+
+  // Processes the oldest queued frame and passes it to the callback.
+  void ProcessHead() {
+    audio_.CopyFrom(frames_.BeginRead());
+    // The frame has been copied; release its slot to the producer.
+    frames_.EndRead();
+    ++num_popped_;
+
+    suppressor_.ProcessFrame(&audio_);
+    audio_.CopyTo(output_.channels());
+    callback_(output_.channels(), frame_size_);
+  }
+
+  // Whether the stream is waiting for or being processed by a worker. Only
+  // cleared with NsScheduler::mutex_ held.
+  std::atomic<bool> scheduled{false};
+
+  std::atomic<int64_t> frames_processed{0};
+  std::atomic<int64_t> deadline_misses{0};
+  std::atomic<int64_t> frames_dropped{0};
+  std::atomic<size_t> max_queue_depth{0};
+
+ private:
+  const size_t frame_size_;
+  const size_t num_channels_;
+  NoiseSuppressorForRate suppressor_;
+  AudioBuffer audio_;
+  ChannelBuffer<float> output_;
+
+  NsFrameRing frames_;
+  std::vector<Clock::time_point> deadlines_;
+  size_t num_pushed_ = 0;
+  size_t num_popped_ = 0;
+
+  const FrameCallback callback_;
+};
+
+NsScheduler::NsScheduler(const Config& config)
+    : config_(config),
+      start_time_(Clock::now()),
+      worker_states_(AlignedMalloc<WorkerState>(
+          std::max<size_t>(config.num_workers, 1) * sizeof(WorkerState),
+          kNsStateAlignment)) {
+  RTC_DCHECK_LT(0, config_.num_workers);
+  for (size_t w = 0; w < config_.num_workers; ++w) {
+    new (&worker_states_[w]) WorkerState();
+    worker_states_[w].busy_ns.store(0, std::memory_order_relaxed);
+  }
+  workers_.reserve(config_.num_workers);
+  for (size_t w = 0; w < config_.num_workers; ++w) {
+    workers_.emplace_back(&NsScheduler::WorkerLoop, this, w);
+  }
+}
+
+NsScheduler::~NsScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  stream_ready_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+  for (Stream* stream : streams_) {
+    delete stream;
+  }
+  for (size_t w = 0; w < config_.num_workers; ++w) {
+    worker_states_[w].~WorkerState();
+  }
+}
+
+NsScheduler::Stream* NsScheduler::AddStream(const NsConfig& ns_config,
+                                            size_t sample_rate_hz,
+                                            size_t num_channels,
+                                            FrameCallback callback) {
+  Stream* stream =
+      new Stream(ns_config, sample_rate_hz, num_channels,
+                 config_.queue_capacity_frames, std::move(callback));
+  std::lock_guard<std::mutex> lock(streams_mutex_);
+  streams_.insert(stream);
+  return stream;
+}
+
+void NsScheduler::RemoveStream(Stream* stream) {
+  // A worker clears |scheduled| with |mutex_| held and only once the queue is
+  // empty, after which no worker touches the stream.
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!stream->scheduled.load()) {
+        break;
+      }
+    }
+    std::this_thread::yield();
+  }
+
+  std::lock_guard<std::mutex> lock(streams_mutex_);
+  streams_.erase(stream);
+  delete stream;
+}
+
+bool NsScheduler::PushFrame(Stream* stream, const float* const* channels) {
+  const Clock::time_point deadline =
+      Clock::now() + std::chrono::milliseconds(config_.deadline_ms);
+  if (!stream->Push(channels, deadline)) {
+    return false;
+  }
+  // Pairs with the fence in WorkerLoop(): either this sees |scheduled|
+  // cleared or the worker sees the new frame.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!stream->scheduled.exchange(true)) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ScheduleLocked(stream);
+    }
+    stream_ready_.notify_one();
+  }
+  return true;
+}
+
+void NsScheduler::ScheduleLocked(Stream* stream) {
+  ready_streams_.push({stream->head_deadline(), stream});
+}
+
+NsScheduler::Stats NsScheduler::GetStats() const {
+  Stats stats;
+  {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    for (const Stream* stream : streams_) {
+      stats.frames_processed += stream->frames_processed.load();
+      stats.deadline_misses += stream->deadline_misses.load();
+      stats.frames_dropped += stream->frames_dropped.load();
+      stats.queue_depth += stream->queue_depth();
+      stats.max_queue_depth =
+          std::max(stats.max_queue_depth, stream->max_queue_depth.load());
+    }
+  }
+  const double elapsed_ns = std::chrono::duration<double, std::nano>(
+                                Clock::now() - start_time_)
+                                .count();
+  for (size_t w = 0; w < config_.num_workers; ++w) {
+    stats.worker_utilization.push_back(
+        worker_states_[w].busy_ns.load(std::memory_order_relaxed) /
+        elapsed_ns);
+  }
+  return stats;
+}
+
+void NsScheduler::WorkerLoop(size_t worker) {
+  if (config_.pin_workers) {
+    PinCurrentThread(worker);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    stream_ready_.wait(lock,
+                       [this] { return stop_ || !ready_streams_.empty(); });
+    if (stop_) {
+      return;
+    }
+    const ReadyStream next = ready_streams_.top();
+    ready_streams_.pop();
+    lock.unlock();
+
+    const Clock::time_point start = Clock::now();
+    Stream* stream = next.stream;
+    stream->ProcessHead();
+    const Clock::time_point end = Clock::now();
+    stream->frames_processed.fetch_add(1, std::memory_order_relaxed);
+    if (end > next.deadline) {
+      stream->deadline_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    worker_states_[worker].busy_ns.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count(),
+        std::memory_order_relaxed);
+
+    // Requeue the stream if it has more frames. Otherwise clear |scheduled|
+    // and check again, since the producer does not requeue a stream while
+    // the flag is set.
+    lock.lock();
+    if (!stream->empty()) {
+      ScheduleLocked(stream);
+    } else {
+      stream->scheduled.store(false);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!stream->empty() && !stream->scheduled.exchange(true)) {
+        ScheduleLocked(stream);
+      }
+    }
+  }
+}
+
+}  // namespace webrtc
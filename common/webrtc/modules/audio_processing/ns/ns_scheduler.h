@@ -0,0 +1,142 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_NS_NS_SCHEDULER_H_
+#define MODULES_AUDIO_PROCESSING_NS_NS_SCHEDULER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "modules/audio_processing/ns/ns_common.h"
+#include "modules/audio_processing/ns/ns_config.h"
+#include "rtc_base/memory/aligned_malloc.h"
+
+namespace webrtc {
+
+// Runs the noise suppression of many independent streams on a fixed pool of
+// worker threads, instead of one thread per stream.
+//
+// Each stream has a preallocated queue of 10 ms frames that a single producer
+// thread fills with PushFrame() without taking any lock. A frame must be
+// processed within Config::deadline_ms of being pushed. The workers take the
+// stream whose oldest queued frame has the earliest deadline, process that
+// frame and hand the result to the stream's callback. A stream is only
+// processed by one worker at a time.
+class NsScheduler {
+ public:
+  struct Config {
+    size_t num_workers = 1;
+    // Pins worker i to CPU i modulo the number of CPUs, where supported.
+    bool pin_workers = true;
+    // Frames that a stream can queue before PushFrame() drops them.
+    size_t queue_capacity_frames = 4;
+    // Time from PushFrame() to the end of the callback that is on time.
+    int deadline_ms = 10;
+  };
+
+  // Receives a processed 10 ms frame on a worker thread, deinterleaved in
+  // [-1, 1] with one pointer per channel.
+  using FrameCallback =
+      std::function<void(const float* const* channels, size_t num_frames)>;
+
+  struct Stats {
+    int64_t frames_processed = 0;
+    int64_t deadline_misses = 0;
+    // Frames that PushFrame() dropped because the queue was full.
+    int64_t frames_dropped = 0;
+    // Frames currently queued over all streams.
+    size_t queue_depth = 0;
+    // Largest number of frames that any stream has had queued.
+    size_t max_queue_depth = 0;
+    // Fraction of the time since construction that each worker has spent
+    // processing frames.
+    std::vector<float> worker_utilization;
+  };
+
+  class Stream;
+
+  explicit NsScheduler(const Config& config);
+  NsScheduler(const NsScheduler&) = delete;
+  NsScheduler& operator=(const NsScheduler&) = delete;
+  // Stops the workers; frames still queued are not processed.
+  ~NsScheduler();
+
+  // Adds a stream with its own suppressor. The stream can be fed as soon as
+  // this returns. |callback| is called from the worker threads.
+  Stream* AddStream(const NsConfig& ns_config,
+                    size_t sample_rate_hz,
+                    size_t num_channels,
+                    FrameCallback callback);
+
+  // Waits for the stream's queued frames to be processed and destroys it.
+  // The producer must have stopped pushing frames.
+  void RemoveStream(Stream* stream);
+
+  // Queues a 10 ms frame, deinterleaved in [-1, 1] with one pointer per
+  // channel. Returns false, dropping the frame, if the queue is full. Only
+  // one thread may push to a stream.
+  bool PushFrame(Stream* stream, const float* const* channels);
+
+  Stats GetStats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // A stream with queued frames, waiting for a worker.
+  struct ReadyStream {
+    Clock::time_point deadline;
+    Stream* stream;
+    bool operator>(const ReadyStream& other) const {
+      return deadline > other.deadline;
+    }
+  };
+
+  struct alignas(kNsStateAlignment) WorkerState {
+    std::atomic<int64_t> busy_ns;
+  };
+
+  void WorkerLoop(size_t worker);
+  // Queues |stream| for a worker. Must be called with |mutex_| held.
+  void ScheduleLocked(Stream* stream);
+
+  const Config config_;
+  const Clock::time_point start_time_;
+
+  // Streams that have frames queued, earliest deadline first, and the
+  // workers' stop flag. Guarded by |mutex_|.
+  std::mutex mutex_;
+  std::condition_variable stream_ready_;
+  std::priority_queue<ReadyStream,
+                      std::vector<ReadyStream>,
+                      std::greater<ReadyStream>>
+      ready_streams_;
+  bool stop_ = false;
+
+  mutable std::mutex streams_mutex_;
+  std::unordered_set<Stream*> streams_;
+
+  std::unique_ptr<WorkerState[], AlignedFreeDeleter> worker_states_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_NS_SCHEDULER_H_
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/ns/ns_thread_pool.h"
+
+#include <new>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/denormal_disabler.h"
+
+namespace webrtc {
+
+NsThreadPool::NsThreadPool(size_t num_workers)
+    : num_threads_(num_workers + 1),
+      ranges_(AlignedMalloc<TaskRange>(num_threads_ * sizeof(TaskRange),
+                                       kNsStateAlignment)) {
+  for (size_t t = 0; t < num_threads_; ++t) {
+    new (&ranges_[t]) TaskRange();
+    ranges_[t].next.store(0, std::memory_order_relaxed);
+    ranges_[t].end = 0;
+  }
+  workers_.reserve(num_workers);
+  for (size_t t = 1; t < num_threads_; ++t) {
+    workers_.emplace_back(&NsThreadPool::WorkerLoop, this, t);
+  }
+}
+
+NsThreadPool::~NsThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  job_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+  for (size_t t = 0; t < num_threads_; ++t) {
+    ranges_[t].~TaskRange();
+  }
+}
+
+void NsThreadPool::Run(size_t num_tasks,
+                       TaskFunction function,
+                       const void* task) {
+  if (workers_.empty() || num_tasks <= 1) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+      function(task, i);
+    }
+    return;
+  }
+
+  // Split the tasks into even ranges. The ranges are only written while no
+  // worker is running tasks.
+  for (size_t t = 0; t < num_threads_; ++t) {
+    ranges_[t].next.store(num_tasks * t / num_threads_,
+                          std::memory_order_relaxed);
+    ranges_[t].end = num_tasks * (t + 1) / num_threads_;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    function_ = function;
+    task_ = task;
+    ++generation_;
+  }
+  job_available_.notify_all();
+
+  RunTasks(0, function, task);
+
+  // All tasks have been taken. Withdraw the job so that workers that have
+  // not woken up yet do not pick it up, and wait for the ones running it.
+  std::unique_lock<std::mutex> lock(mutex_);
+  function_ = nullptr;
+  task_ = nullptr;
+  job_done_.wait(lock, [this] { return num_busy_workers_ == 0; });
+}
+
+void NsThreadPool::RunTasks(size_t thread,
+                            TaskFunction function,
+                            const void* task) {
+  for (size_t k = 0; k < num_threads_; ++k) {
+    TaskRange& range = ranges_[(thread + k) % num_threads_];
+    size_t i;
+    while ((i = range.next.fetch_add(1, std::memory_order_relaxed)) <
+           range.end) {
+      function(task, i);
+    }
+  }
+}
+
+void NsThreadPool::WorkerLoop(size_t thread) {
+  // The workers only run suppressor work, so they keep denormals flushed for
+  // their whole lifetime, as the caller does for the tasks it runs itself.
+  DenormalDisabler denormal_disabler;
+  uint64_t generation = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    job_available_.wait(lock, [this, generation] {
+      return stop_ || (function_ && generation_ != generation);
+    });
+    if (stop_) {
+      return;
+    }
+    generation = generation_;
+    TaskFunction function = function_;
+    const void* task = task_;
+    ++num_busy_workers_;
+    lock.unlock();
+
+    RunTasks(thread, function, task);
+
+    lock.lock();
+    if (--num_busy_workers_ == 0) {
+      job_done_.notify_one();
+    }
+  }
+}
+
+}  // namespace webrtc
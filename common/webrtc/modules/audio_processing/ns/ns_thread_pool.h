@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_NS_NS_THREAD_POOL_H_
+#define MODULES_AUDIO_PROCESSING_NS_NS_THREAD_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "modules/audio_processing/ns/ns_common.h"
+#include "rtc_base/memory/aligned_malloc.h"
+
+namespace webrtc {
+
+// Pool of worker threads that runs the per-channel work of a noise suppressor
+// in parallel. The calling thread takes part in the work, so a pool with
+// N workers runs N + 1 tasks at a time.
+//
+// The tasks of a ParallelFor() call are split into one contiguous range per
+// thread, so that with a stable task count every thread keeps working on the
+// same channels from frame to frame. A thread that runs out of tasks steals
+// the remaining ones from the ranges of the others.
+class NsThreadPool {
+ public:
+  explicit NsThreadPool(size_t num_workers);
+  NsThreadPool(const NsThreadPool&) = delete;
+  NsThreadPool& operator=(const NsThreadPool&) = delete;
+  ~NsThreadPool();
+
+  // Calls task(i) for every i in [0, num_tasks) and returns when all calls
+  // have returned. Only one thread may call this at a time.
+  template <typename Task>
+  void ParallelFor(size_t num_tasks, const Task& task) {
+    Run(num_tasks, &CallTask<Task>, &task);
+  }
+
+  size_t num_workers() const { return workers_.size(); }
+
+ private:
+  using TaskFunction = void (*)(const void* task, size_t index);
+
+  // Range of task indices owned by one thread. Threads take tasks from the
+  // front of their own range and steal from the front of the others.
+  struct alignas(kNsStateAlignment) TaskRange {
+    std::atomic<size_t> next;
+    size_t end;
+  };
+
+  template <typename Task>
+  static void CallTask(const void* task, size_t index) {
+    (*static_cast<const Task*>(task))(index);
+  }
+
+  void Run(size_t num_tasks, TaskFunction function, const void* task);
+  // Runs tasks until none are left, starting with the range of |thread|.
+  void RunTasks(size_t thread, TaskFunction function, const void* task);
+  void WorkerLoop(size_t thread);
+
+  const size_t num_threads_;
+  std::unique_ptr<TaskRange[], AlignedFreeDeleter> ranges_;
+
+  std::mutex mutex_;
+  std::condition_variable job_available_;
+  std::condition_variable job_done_;
+  // The current job, null between ParallelFor() calls. Guarded by |mutex_|.
+  TaskFunction function_ = nullptr;
+  const void* task_ = nullptr;
+  uint64_t generation_ = 0;
+  size_t num_busy_workers_ = 0;
+  bool stop_ = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_NS_THREAD_POOL_H_
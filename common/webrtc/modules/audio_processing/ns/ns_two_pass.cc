@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/ns/ns_two_pass.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "modules/audio_processing/ns/noise_suppressor.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+template <typename Layout>
+void SuppressNoiseTwoPass(const NsConfig& config,
+                          size_t sample_rate_hz,
+                          size_t num_channels,
+                          rtc::ArrayView<const float* const> input,
+                          rtc::ArrayView<float* const> output,
+                          size_t num_frames,
+                          NsThreadPool* thread_pool) {
+  using Suppressor = BasicNoiseSuppressor<Layout>;
+  RTC_DCHECK_EQ(input.size(), output.size());
+  RTC_DCHECK_EQ(0, input.size() % num_channels);
+
+  const size_t max_num_chunks = thread_pool ? thread_pool->num_workers() + 1
+                                            : 1;
+  const size_t num_chunks = std::max<size_t>(
+      1, std::min(max_num_chunks, num_frames / kNsTwoPassMinChunkFrames));
+
+  // First pass: analyze the chunks with one suppressor each.
+  std::vector<std::unique_ptr<Suppressor>> analyzers(num_chunks);
+  const auto analyze_chunk = [&](size_t chunk) {
+    const size_t begin = chunk * num_frames / num_chunks;
+    const size_t end = (chunk + 1) * num_frames / num_chunks;
+    std::vector<const float*> chunk_input(input.size());
+    for (size_t k = 0; k < input.size(); ++k) {
+      chunk_input[k] = input[k] + begin * Layout::kNsFrameSize;
+    }
+    analyzers[chunk] =
+        Suppressor::Create(config, sample_rate_hz, num_channels);
+    analyzers[chunk]->AnalyzeBlock(chunk_input, end - begin);
+  };
+  if (thread_pool && num_chunks > 1) {
+    thread_pool->ParallelFor(num_chunks, analyze_chunk);
+  } else {
+    analyze_chunk(0);
+  }
+
+  // Second pass: process the whole signal with the merged estimates, with the
+  // channels spread over the thread pool. The channel tasks share only the
+  // read-only FFT tables; "ns_bench twopass" on a multichannel file in a
+  // ThreadSanitizer build (make tsan) checks this path for data races.
+  std::vector<const Suppressor*> analyzer_pointers;
+  for (const auto& analyzer : analyzers) {
+    analyzer_pointers.push_back(analyzer.get());
+  }
+  std::unique_ptr<Suppressor> suppressor =
+      Suppressor::Create(config, sample_rate_hz, num_channels);
+  suppressor->InitializeFromAnalyses(analyzer_pointers);
+  suppressor->SetThreadPool(thread_pool);
+  suppressor->ProcessBlock(input, output, num_frames);
+}
+
+template void SuppressNoiseTwoPass<Ns10msLayout>(
+    const NsConfig& config,
+    size_t sample_rate_hz,
+    size_t num_channels,
+    rtc::ArrayView<const float* const> input,
+    rtc::ArrayView<float* const> output,
+    size_t num_frames,
+    NsThreadPool* thread_pool);
+template void SuppressNoiseTwoPass<Ns5msLayout>(
+    const NsConfig& config,
+    size_t sample_rate_hz,
+    size_t num_channels,
+    rtc::ArrayView<const float* const> input,
+    rtc::ArrayView<float* const> output,
+    size_t num_frames,
+    NsThreadPool* thread_pool);
+template void SuppressNoiseTwoPass<Ns48kFullBandLayout>(
+    const NsConfig& config,
+    size_t sample_rate_hz,
+    size_t num_channels,
+    rtc::ArrayView<const float* const> input,
+    rtc::ArrayView<float* const> output,
+    size_t num_frames,
+    NsThreadPool* thread_pool);
+
+}  // namespace webrtc
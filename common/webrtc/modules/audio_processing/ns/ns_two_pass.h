@@ -0,0 +1,47 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_NS_NS_TWO_PASS_H_
+#define MODULES_AUDIO_PROCESSING_NS_NS_TWO_PASS_H_
+
+#include <stddef.h>
+
+#include "api/array_view.h"
+#include "modules/audio_processing/ns/ns_config.h"
+#include "modules/audio_processing/ns/ns_thread_pool.h"
+
+namespace webrtc {
+
+// Smallest number of frames that the analysis pass gives to one analyzer, so
+// that every analyzer gets past the startup phases of the estimators.
+constexpr size_t kNsTwoPassMinChunkFrames = 500;
+
+// Suppresses the noise of a whole recording in two passes, for offline use
+// where the output does not have to be causal. The first pass splits the
+// signal into up to one chunk per thread of |thread_pool|, at least
+// kNsTwoPassMinChunkFrames frames each, and analyzes the chunks in parallel
+// with separate suppressors. The second pass initializes a suppressor with
+// the average of their estimates and processes the signal from the start,
+// so that the beginning is suppressed with a settled noise profile instead
+// of one that is still adapting. The signals are laid out as for
+// BasicNoiseSuppressor::ProcessBlock and the output may alias the input.
+// Without a thread pool the analysis runs on the calling thread as one chunk.
+template <typename Layout>
+void SuppressNoiseTwoPass(const NsConfig& config,
+                          size_t sample_rate_hz,
+                          size_t num_channels,
+                          rtc::ArrayView<const float* const> input,
+                          rtc::ArrayView<float* const> output,
+                          size_t num_frames,
+                          NsThreadPool* thread_pool);
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_NS_TWO_PASS_H_
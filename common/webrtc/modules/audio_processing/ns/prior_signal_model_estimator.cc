@@ -23,7 +23,7 @@ namespace {
 // Identifies the first of the two largest peaks in the histogram.
 void FindFirstOfTwoLargestPeaks(
     float bin_size,
-    rtc::ArrayView<const int, kHistogramSize> spectral_flatness,
+    const FeatureHistogram& spectral_flatness,
     float* peak_position,
     int* peak_weight) {
   RTC_DCHECK(peak_position);
@@ -64,7 +64,7 @@ void FindFirstOfTwoLargestPeaks(
   }
 }
 
-void UpdateLrt(rtc::ArrayView<const int, kHistogramSize> lrt_histogram,
+void UpdateLrt(const FeatureHistogram& lrt_histogram,
                float* prior_model_lrt,
                bool* low_lrt_fluctuations) {
   RTC_DCHECK(prior_model_lrt);
@@ -167,4 +167,22 @@ void PriorSignalModelEstimator::Update(const Histograms& histograms) {
   }
 }
 
+void PriorSignalModelEstimator::InitializeFromAverage(
+    rtc::ArrayView<const PriorSignalModelEstimator* const> estimators) {
+  RTC_DCHECK(!estimators.empty());
+  PriorSignalModel& m = prior_model_;
+  m.lrt = m.flatness_threshold = m.template_diff_threshold = 0.f;
+  m.lrt_weighting = m.flatness_weighting = m.difference_weighting = 0.f;
+  const float scale = 1.f / estimators.size();
+  for (const PriorSignalModelEstimator* e : estimators) {
+    const PriorSignalModel& other = e->prior_model_;
+    m.lrt += scale * other.lrt;
+    m.flatness_threshold += scale * other.flatness_threshold;
+    m.template_diff_threshold += scale * other.template_diff_threshold;
+    m.lrt_weighting += scale * other.lrt_weighting;
+    m.flatness_weighting += scale * other.flatness_weighting;
+    m.difference_weighting += scale * other.difference_weighting;
+  }
+}
+
 }  // namespace webrtc
@@ -11,6 +11,7 @@
 #ifndef MODULES_AUDIO_PROCESSING_NS_PRIOR_SIGNAL_MODEL_ESTIMATOR_H_
 #define MODULES_AUDIO_PROCESSING_NS_PRIOR_SIGNAL_MODEL_ESTIMATOR_H_
 
+#include "api/array_view.h"
 #include "modules/audio_processing/ns/histograms.h"
 #include "modules/audio_processing/ns/prior_signal_model.h"
 
@@ -27,6 +28,10 @@ class PriorSignalModelEstimator {
   // Updates the model estimate.
   void Update(const Histograms& h);
 
+  // Sets the model to the average of the models of |estimators|.
+  void InitializeFromAverage(
+      rtc::ArrayView<const PriorSignalModelEstimator* const> estimators);
+
   // Returns the estimated model.
   const PriorSignalModel& get_prior_model() const { return prior_model_; }
 
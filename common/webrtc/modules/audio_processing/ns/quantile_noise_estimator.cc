@@ -10,13 +10,16 @@
 
 #include "modules/audio_processing/ns/quantile_noise_estimator.h"
 
+#include <math.h>
 #include <algorithm>
 
 #include "modules/audio_processing/ns/fast_math.h"
+#include "rtc_base/checks.h"
 
 namespace webrtc {
 
-QuantileNoiseEstimator::QuantileNoiseEstimator() {
+template <typename Layout>
+QuantileNoiseEstimator<Layout>::QuantileNoiseEstimator() {
   quantile_.fill(0.f);
   density_.fill(0.3f);
   log_quantile_.fill(8.f);
@@ -27,7 +30,8 @@ QuantileNoiseEstimator::QuantileNoiseEstimator() {
   }
 }
 
-void QuantileNoiseEstimator::Estimate(
+template <typename Layout>
+void QuantileNoiseEstimator<Layout>::Estimate(
     rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum,
     rtc::ArrayView<float, kFftSizeBy2Plus1> noise_spectrum) {
   std::array<float, kFftSizeBy2Plus1> log_spectrum;
@@ -85,4 +89,34 @@ void QuantileNoiseEstimator::Estimate(
   std::copy(quantile_.begin(), quantile_.end(), noise_spectrum.begin());
 }
 
+template <typename Layout>
+void QuantileNoiseEstimator<Layout>::InitializeFromAverage(
+    rtc::ArrayView<const QuantileNoiseEstimator* const> estimators) {
+  RTC_DCHECK(!estimators.empty());
+  const float scale = 1.f / estimators.size();
+  density_.fill(0.f);
+  log_quantile_.fill(0.f);
+  std::array<float, kFftSizeBy2Plus1> log_quantile_average;
+  log_quantile_average.fill(0.f);
+  num_updates_ = 0;
+  for (const QuantileNoiseEstimator* e : estimators) {
+    for (size_t j = 0; j < density_.size(); ++j) {
+      density_[j] += scale * e->density_[j];
+      log_quantile_[j] += scale * e->log_quantile_[j];
+    }
+    for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+      log_quantile_average[i] +=
+          scale * logf(std::max(e->quantile_[i], 1e-10f));
+    }
+    num_updates_ = std::max(num_updates_, e->num_updates_);
+  }
+  for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+    quantile_[i] = expf(log_quantile_average[i]);
+  }
+}
+
+template class QuantileNoiseEstimator<Ns10msLayout>;
+template class QuantileNoiseEstimator<Ns5msLayout>;
+template class QuantileNoiseEstimator<Ns48kFullBandLayout>;
+
 }  // namespace webrtc
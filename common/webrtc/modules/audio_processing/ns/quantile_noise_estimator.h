@@ -22,8 +22,11 @@ namespace webrtc {
 constexpr int kSimult = 3;
 
 // For quantile noise estimation.
+template <typename Layout>
 class QuantileNoiseEstimator {
  public:
+  static constexpr size_t kFftSizeBy2Plus1 = Layout::kFftSizeBy2Plus1;
+
   QuantileNoiseEstimator();
   QuantileNoiseEstimator(const QuantileNoiseEstimator&) = delete;
   QuantileNoiseEstimator& operator=(const QuantileNoiseEstimator&) = delete;
@@ -32,10 +35,17 @@ class QuantileNoiseEstimator {
   void Estimate(rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum,
                 rtc::ArrayView<float, kFftSizeBy2Plus1> noise_spectrum);
 
+  // Sets the quantiles and densities to the average of those of |estimators|,
+  // the quantiles averaged in the log domain. The update phases are kept.
+  void InitializeFromAverage(
+      rtc::ArrayView<const QuantileNoiseEstimator* const> estimators);
+
  private:
-  std::array<float, kSimult * kFftSizeBy2Plus1> density_;
-  std::array<float, kSimult * kFftSizeBy2Plus1> log_quantile_;
-  std::array<float, kFftSizeBy2Plus1> quantile_;
+  alignas(kNsStateAlignment)
+      std::array<float, kSimult * kFftSizeBy2Plus1> density_;
+  alignas(kNsStateAlignment)
+      std::array<float, kSimult * kFftSizeBy2Plus1> log_quantile_;
+  alignas(kNsStateAlignment) std::array<float, kFftSizeBy2Plus1> quantile_;
   std::array<int, kSimult> counter_;
   int num_updates_ = 1;
 };
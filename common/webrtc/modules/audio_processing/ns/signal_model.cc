@@ -12,7 +12,8 @@
 
 namespace webrtc {
 
-SignalModel::SignalModel() {
+template <typename Layout>
+SignalModel<Layout>::SignalModel() {
   constexpr float kSfFeatureThr = 0.5f;
 
   lrt = kLtrFeatureThr;
@@ -21,4 +22,8 @@ SignalModel::SignalModel() {
   avg_log_lrt.fill(kLtrFeatureThr);
 }
 
+template struct SignalModel<Ns10msLayout>;
+template struct SignalModel<Ns5msLayout>;
+template struct SignalModel<Ns48kFullBandLayout>;
+
 }  // namespace webrtc
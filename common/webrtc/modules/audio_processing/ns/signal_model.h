@@ -17,6 +17,7 @@
 
 namespace webrtc {
 
+template <typename Layout>
 struct SignalModel {
   SignalModel();
   SignalModel(const SignalModel&) = delete;
@@ -26,7 +27,8 @@ struct SignalModel {
   float spectral_diff;
   float spectral_flatness;
   // Log LRT factor with time-smoothing.
-  std::array<float, kFftSizeBy2Plus1> avg_log_lrt;
+  alignas(kNsStateAlignment)
+      std::array<float, Layout::kFftSizeBy2Plus1> avg_log_lrt;
 };
 
 }  // namespace webrtc
@@ -10,16 +10,18 @@
 
 #include "modules/audio_processing/ns/signal_model_estimator.h"
 
+#include <vector>
+
 #include "modules/audio_processing/ns/fast_math.h"
+#include "rtc_base/checks.h"
 
 namespace webrtc {
 
 namespace {
 
-constexpr float kOneByFftSizeBy2Plus1 = 1.f / kFftSizeBy2Plus1;
-
 // Computes the difference measure between input spectrum and a template/learned
 // noise spectrum.
+template <size_t kFftSizeBy2Plus1>
 float ComputeSpectralDiff(
     rtc::ArrayView<const float, kFftSizeBy2Plus1> conservative_noise_spectrum,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum,
@@ -28,6 +30,8 @@ float ComputeSpectralDiff(
   // spectral_diff = var(signal_spectrum) - cov(signal_spectrum, magnAvgPause)^2
   // / var(magnAvgPause)
 
+  constexpr float kOneByFftSizeBy2Plus1 = 1.f / kFftSizeBy2Plus1;
+
   // Compute average quantities.
   float noise_average = 0.f;
   for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
@@ -60,6 +64,7 @@ float ComputeSpectralDiff(
 }
 
 // Updates the spectral flatness based on the input spectrum.
+template <size_t kFftSizeBy2Plus1>
 void UpdateSpectralFlatness(
     rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum,
     float signal_spectral_sum,
@@ -68,6 +73,7 @@ void UpdateSpectralFlatness(
 
   // Compute log of ratio of the geometric to arithmetic mean (handle the log(0)
   // separately).
+  constexpr float kOneByFftSizeBy2Plus1 = 1.f / kFftSizeBy2Plus1;
   constexpr float kAveraging = 0.3f;
   float avg_spect_flatness_num = 0.f;
   for (size_t i = 1; i < kFftSizeBy2Plus1; ++i) {
@@ -94,6 +100,7 @@ void UpdateSpectralFlatness(
 }
 
 // Updates the log LRT measures.
+template <size_t kFftSizeBy2Plus1>
 void UpdateSpectralLrt(rtc::ArrayView<const float, kFftSizeBy2Plus1> prior_snr,
                        rtc::ArrayView<const float, kFftSizeBy2Plus1> post_snr,
                        rtc::ArrayView<float, kFftSizeBy2Plus1> avg_log_lrt,
@@ -112,46 +119,56 @@ void UpdateSpectralLrt(rtc::ArrayView<const float, kFftSizeBy2Plus1> prior_snr,
   for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
     log_lrt_time_avg_k_sum += avg_log_lrt[i];
   }
+  constexpr float kOneByFftSizeBy2Plus1 = 1.f / kFftSizeBy2Plus1;
   *lrt = log_lrt_time_avg_k_sum * kOneByFftSizeBy2Plus1;
 }
 
 }  // namespace
 
-SignalModelEstimator::SignalModelEstimator()
+template <typename Layout>
+SignalModelEstimator<Layout>::SignalModelEstimator()
     : prior_model_estimator_(kLtrFeatureThr) {}
 
-void SignalModelEstimator::AdjustNormalization(int32_t num_analyzed_frames,
-                                               float signal_energy) {
+template <typename Layout>
+void SignalModelEstimator<Layout>::AdjustNormalization(
+    int32_t num_analyzed_frames,
+    float signal_energy) {
   diff_normalization_ *= num_analyzed_frames;
   diff_normalization_ += signal_energy;
   diff_normalization_ /= (num_analyzed_frames + 1);
 }
 
 // Update the noise features.
-void SignalModelEstimator::Update(
+template <typename Layout>
+void SignalModelEstimator<Layout>::Update(
     rtc::ArrayView<const float, kFftSizeBy2Plus1> prior_snr,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> post_snr,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> conservative_noise_spectrum,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum,
     float signal_spectral_sum,
-    float signal_energy) {
+    float signal_energy,
+    int num_frames) {
+  RTC_DCHECK_LT(0, num_frames);
   // Compute spectral flatness on input spectrum.
-  UpdateSpectralFlatness(signal_spectrum, signal_spectral_sum,
-                         &features_.spectral_flatness);
+  UpdateSpectralFlatness<kFftSizeBy2Plus1>(
+      signal_spectrum, signal_spectral_sum, &features_.spectral_flatness);
 
   // Compute difference of input spectrum with learned/estimated noise spectrum.
   float spectral_diff =
-      ComputeSpectralDiff(conservative_noise_spectrum, signal_spectrum,
-                          signal_spectral_sum, diff_normalization_);
+      ComputeSpectralDiff<kFftSizeBy2Plus1>(
+          conservative_noise_spectrum, signal_spectrum, signal_spectral_sum,
+          diff_normalization_);
   // Compute time-avg update of difference feature.
   features_.spectral_diff += 0.3f * (spectral_diff - features_.spectral_diff);
 
-  signal_energy_sum_ += signal_energy;
+  signal_energy_sum_ += num_frames * signal_energy;
 
   // Compute histograms for parameter decisions (thresholds and weights for
   // features). Parameters are extracted periodically.
-  if (--histogram_analysis_counter_ > 0) {
-    histograms_.Update(features_);
+  histogram_analysis_counter_ -= num_frames;
+  if (histogram_analysis_counter_ > 0) {
+    histograms_.Update(features_.lrt, features_.spectral_flatness,
+                       features_.spectral_diff);
   } else {
     // Compute model parameters.
     prior_model_estimator_.Update(histograms_);
@@ -169,7 +186,34 @@ void SignalModelEstimator::Update(
   }
 
   // Compute the LRT.
-  UpdateSpectralLrt(prior_snr, post_snr, features_.avg_log_lrt, &features_.lrt);
+  UpdateSpectralLrt<kFftSizeBy2Plus1>(prior_snr, post_snr,
+                                      features_.avg_log_lrt, &features_.lrt);
 }
 
+template <typename Layout>
+void SignalModelEstimator<Layout>::InitializeFromAverage(
+    rtc::ArrayView<const SignalModelEstimator* const> estimators) {
+  RTC_DCHECK(!estimators.empty());
+  const float scale = 1.f / estimators.size();
+  diff_normalization_ = 0.f;
+  features_.lrt = features_.spectral_diff = features_.spectral_flatness = 0.f;
+  features_.avg_log_lrt.fill(0.f);
+  std::vector<const PriorSignalModelEstimator*> prior_model_estimators;
+  for (const SignalModelEstimator* e : estimators) {
+    diff_normalization_ += scale * e->diff_normalization_;
+    features_.lrt += scale * e->features_.lrt;
+    features_.spectral_diff += scale * e->features_.spectral_diff;
+    features_.spectral_flatness += scale * e->features_.spectral_flatness;
+    for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+      features_.avg_log_lrt[i] += scale * e->features_.avg_log_lrt[i];
+    }
+    prior_model_estimators.push_back(&e->prior_model_estimator_);
+  }
+  prior_model_estimator_.InitializeFromAverage(prior_model_estimators);
+}
+
+template class SignalModelEstimator<Ns10msLayout>;
+template class SignalModelEstimator<Ns5msLayout>;
+template class SignalModelEstimator<Ns48kFullBandLayout>;
+
 }  // namespace webrtc
@@ -22,8 +22,11 @@
 
 namespace webrtc {
 
+template <typename Layout>
 class SignalModelEstimator {
  public:
+  static constexpr size_t kFftSizeBy2Plus1 = Layout::kFftSizeBy2Plus1;
+
   SignalModelEstimator();
   SignalModelEstimator(const SignalModelEstimator&) = delete;
   SignalModelEstimator& operator=(const SignalModelEstimator&) = delete;
@@ -31,18 +34,28 @@ class SignalModelEstimator {
   // Compute signal normalization during the initial startup phase.
   void AdjustNormalization(int32_t num_analyzed_frames, float signal_energy);
 
+  // Updates the features with a frame. |num_frames| is the number of frames
+  // that the update stands for, more than one when the estimators are only
+  // updated on some of the frames; the histogram window and the energy
+  // normalization count frames.
   void Update(
       rtc::ArrayView<const float, kFftSizeBy2Plus1> prior_snr,
       rtc::ArrayView<const float, kFftSizeBy2Plus1> post_snr,
       rtc::ArrayView<const float, kFftSizeBy2Plus1> conservative_noise_spectrum,
       rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum,
       float signal_spectral_sum,
-      float signal_energy);
+      float signal_energy,
+      int num_frames);
+
+  // Sets the normalization, the features and the prior model to the average
+  // of those of |estimators|. The histograms are kept.
+  void InitializeFromAverage(
+      rtc::ArrayView<const SignalModelEstimator* const> estimators);
 
   const PriorSignalModel& get_prior_model() const {
     return prior_model_estimator_.get_prior_model();
   }
-  const SignalModel& get_model() { return features_; }
+  const SignalModel<Layout>& get_model() { return features_; }
 
  private:
   float diff_normalization_ = 0.f;
@@ -50,7 +63,7 @@ class SignalModelEstimator {
   Histograms histograms_;
   int histogram_analysis_counter_ = 500;
   PriorSignalModelEstimator prior_model_estimator_;
-  SignalModel features_;
+  SignalModel<Layout> features_;
 };
 
 }  // namespace webrtc
@@ -12,24 +12,28 @@
 
 #include <math.h>
 #include <algorithm>
+#include <vector>
 
 #include "modules/audio_processing/ns/fast_math.h"
 #include "rtc_base/checks.h"
 
 namespace webrtc {
 
-SpeechProbabilityEstimator::SpeechProbabilityEstimator() {
+template <typename Layout>
+SpeechProbabilityEstimator<Layout>::SpeechProbabilityEstimator() {
   speech_probability_.fill(0.f);
 }
 
-void SpeechProbabilityEstimator::Update(
+template <typename Layout>
+void SpeechProbabilityEstimator<Layout>::Update(
     int32_t num_analyzed_frames,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> prior_snr,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> post_snr,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> conservative_noise_spectrum,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum,
     float signal_spectral_sum,
-    float signal_energy) {
+    float signal_energy,
+    int num_frames) {
   // Update models.
   if (num_analyzed_frames < kLongStartupPhaseBlocks) {
     signal_model_estimator_.AdjustNormalization(num_analyzed_frames,
@@ -37,9 +41,10 @@ void SpeechProbabilityEstimator::Update(
   }
   signal_model_estimator_.Update(prior_snr, post_snr,
                                  conservative_noise_spectrum, signal_spectrum,
-                                 signal_spectral_sum, signal_energy);
+                                 signal_spectral_sum, signal_energy,
+                                 num_frames);
 
-  const SignalModel& model = signal_model_estimator_.get_model();
+  const SignalModel<Layout>& model = signal_model_estimator_.get_model();
   const PriorSignalModel& prior_model =
       signal_model_estimator_.get_prior_model();
 
@@ -100,4 +105,26 @@ void SpeechProbabilityEstimator::Update(
   }
 }
 
+template <typename Layout>
+void SpeechProbabilityEstimator<Layout>::InitializeFromAverage(
+    rtc::ArrayView<const SpeechProbabilityEstimator* const> estimators) {
+  RTC_DCHECK(!estimators.empty());
+  const float scale = 1.f / estimators.size();
+  prior_speech_prob_ = 0.f;
+  speech_probability_.fill(0.f);
+  std::vector<const SignalModelEstimator<Layout>*> signal_model_estimators;
+  for (const SpeechProbabilityEstimator* e : estimators) {
+    prior_speech_prob_ += scale * e->prior_speech_prob_;
+    for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+      speech_probability_[i] += scale * e->speech_probability_[i];
+    }
+    signal_model_estimators.push_back(&e->signal_model_estimator_);
+  }
+  signal_model_estimator_.InitializeFromAverage(signal_model_estimators);
+}
+
+template class SpeechProbabilityEstimator<Ns10msLayout>;
+template class SpeechProbabilityEstimator<Ns5msLayout>;
+template class SpeechProbabilityEstimator<Ns48kFullBandLayout>;
+
 }  // namespace webrtc
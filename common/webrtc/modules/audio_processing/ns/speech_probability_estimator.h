@@ -20,14 +20,18 @@
 namespace webrtc {
 
 // Class for estimating the probability of speech.
+template <typename Layout>
 class SpeechProbabilityEstimator {
  public:
+  static constexpr size_t kFftSizeBy2Plus1 = Layout::kFftSizeBy2Plus1;
+
   SpeechProbabilityEstimator();
   SpeechProbabilityEstimator(const SpeechProbabilityEstimator&) = delete;
   SpeechProbabilityEstimator& operator=(const SpeechProbabilityEstimator&) =
       delete;
 
-  // Compute speech probability.
+  // Compute speech probability. |num_frames| is the number of frames that
+  // the update stands for, see SignalModelEstimator::Update().
   void Update(
       int32_t num_analyzed_frames,
       rtc::ArrayView<const float, kFftSizeBy2Plus1> prior_snr,
@@ -35,15 +39,22 @@ class SpeechProbabilityEstimator {
       rtc::ArrayView<const float, kFftSizeBy2Plus1> conservative_noise_spectrum,
       rtc::ArrayView<const float, kFftSizeBy2Plus1> signal_spectrum,
       float signal_spectral_sum,
-      float signal_energy);
+      float signal_energy,
+      int num_frames);
+
+  // Sets the signal model and the probabilities to the average of those of
+  // |estimators|.
+  void InitializeFromAverage(
+      rtc::ArrayView<const SpeechProbabilityEstimator* const> estimators);
 
   float get_prior_probability() const { return prior_speech_prob_; }
   rtc::ArrayView<const float> get_probability() { return speech_probability_; }
 
  private:
-  SignalModelEstimator signal_model_estimator_;
+  SignalModelEstimator<Layout> signal_model_estimator_;
   float prior_speech_prob_ = .5f;
-  std::array<float, kFftSizeBy2Plus1> speech_probability_;
+  alignas(kNsStateAlignment)
+      std::array<float, kFftSizeBy2Plus1> speech_probability_;
 };
 
 }  // namespace webrtc
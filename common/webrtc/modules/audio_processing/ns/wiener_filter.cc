@@ -20,14 +20,16 @@
 
 namespace webrtc {
 
-WienerFilter::WienerFilter(const SuppressionParams& suppression_params)
+template <typename Layout>
+WienerFilter<Layout>::WienerFilter(const SuppressionParams& suppression_params)
     : suppression_params_(suppression_params) {
   filter_.fill(1.f);
   initial_spectral_estimate_.fill(0.f);
   spectrum_prev_process_.fill(0.f);
 }
 
-void WienerFilter::Update(
+template <typename Layout>
+void WienerFilter<Layout>::Update(
     int32_t num_analyzed_frames,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> noise_spectrum,
     rtc::ArrayView<const float, kFftSizeBy2Plus1> prev_noise_spectrum,
@@ -80,7 +82,8 @@ void WienerFilter::Update(
             spectrum_prev_process_.begin());
 }
 
-float WienerFilter::ComputeOverallScalingFactor(
+template <typename Layout>
+float WienerFilter<Layout>::ComputeOverallScalingFactor(
     int32_t num_analyzed_frames,
     float prior_speech_probability,
     float energy_before_filtering,
@@ -117,4 +120,8 @@ float WienerFilter::ComputeOverallScalingFactor(
          (1.f - prior_speech_probability) * scale_factor2;
 }
 
+template class WienerFilter<Ns10msLayout>;
+template class WienerFilter<Ns5msLayout>;
+template class WienerFilter<Ns48kFullBandLayout>;
+
 }  // namespace webrtc
@@ -20,8 +20,11 @@
 namespace webrtc {
 
 // Estimates a Wiener-filter based frequency domain noise reduction filter.
+template <typename Layout>
 class WienerFilter {
  public:
+  static constexpr size_t kFftSizeBy2Plus1 = Layout::kFftSizeBy2Plus1;
+
   explicit WienerFilter(const SuppressionParams& suppression_params);
   WienerFilter(const WienerFilter&) = delete;
   WienerFilter& operator=(const WienerFilter&) = delete;
@@ -47,9 +50,11 @@ class WienerFilter {
 
  private:
   const SuppressionParams& suppression_params_;
-  std::array<float, kFftSizeBy2Plus1> spectrum_prev_process_;
-  std::array<float, kFftSizeBy2Plus1> initial_spectral_estimate_;
-  std::array<float, kFftSizeBy2Plus1> filter_;
+  alignas(kNsStateAlignment)
+      std::array<float, kFftSizeBy2Plus1> spectrum_prev_process_;
+  alignas(kNsStateAlignment)
+      std::array<float, kFftSizeBy2Plus1> initial_spectral_estimate_;
+  alignas(kNsStateAlignment) std::array<float, kFftSizeBy2Plus1> filter_;
 };
 
 }  // namespace webrtc
@@ -19,6 +19,8 @@
 namespace webrtc {
 namespace {
 
+// Maximum frame sizes supported by the two-band filter, corresponding to 10 ms
+// at 32 kHz. Shorter frames are used for low-latency processing.
 constexpr size_t kSamplesPerBand = 160;
 constexpr size_t kTwoBandFilterSamplesPerFrame = 320;
 
@@ -70,35 +72,44 @@ void SplittingFilter::Synthesis(const ChannelBuffer<float>* bands,
 void SplittingFilter::TwoBandsAnalysis(const ChannelBuffer<float>* data,
                                        ChannelBuffer<float>* bands) {
   RTC_DCHECK_EQ(two_bands_states_.size(), data->num_channels());
-  RTC_DCHECK_EQ(data->num_frames(), kTwoBandFilterSamplesPerFrame);
+  RTC_DCHECK_LE(data->num_frames(), kTwoBandFilterSamplesPerFrame);
+  const size_t num_frames = data->num_frames();
+  const size_t num_frames_per_band = bands->num_frames_per_band();
 
   for (size_t i = 0; i < two_bands_states_.size(); ++i) {
     std::array<std::array<int16_t, kSamplesPerBand>, 2> bands16;
     std::array<int16_t, kTwoBandFilterSamplesPerFrame> full_band16;
-    FloatS16ToS16(data->channels(0)[i], full_band16.size(), full_band16.data());
-    WebRtcSpl_AnalysisQMF(full_band16.data(), data->num_frames(),
-                          bands16[0].data(), bands16[1].data(),
+    FloatS16ToS16(data->channels(0)[i], num_frames, full_band16.data());
+    WebRtcSpl_AnalysisQMF(full_band16.data(), num_frames, bands16[0].data(),
+                          bands16[1].data(),
                           two_bands_states_[i].analysis_state1,
                           two_bands_states_[i].analysis_state2);
-    S16ToFloatS16(bands16[0].data(), bands16[0].size(), bands->channels(0)[i]);
-    S16ToFloatS16(bands16[1].data(), bands16[1].size(), bands->channels(1)[i]);
+    S16ToFloatS16(bands16[0].data(), num_frames_per_band,
+                  bands->channels(0)[i]);
+    S16ToFloatS16(bands16[1].data(), num_frames_per_band,
+                  bands->channels(1)[i]);
   }
 }
 
 void SplittingFilter::TwoBandsSynthesis(const ChannelBuffer<float>* bands,
                                         ChannelBuffer<float>* data) {
   RTC_DCHECK_LE(data->num_channels(), two_bands_states_.size());
-  RTC_DCHECK_EQ(data->num_frames(), kTwoBandFilterSamplesPerFrame);
+  RTC_DCHECK_LE(data->num_frames(), kTwoBandFilterSamplesPerFrame);
+  const size_t num_frames = data->num_frames();
+  const size_t num_frames_per_band = bands->num_frames_per_band();
+
   for (size_t i = 0; i < data->num_channels(); ++i) {
     std::array<std::array<int16_t, kSamplesPerBand>, 2> bands16;
     std::array<int16_t, kTwoBandFilterSamplesPerFrame> full_band16;
-    FloatS16ToS16(bands->channels(0)[i], bands16[0].size(), bands16[0].data());
-    FloatS16ToS16(bands->channels(1)[i], bands16[1].size(), bands16[1].data());
+    FloatS16ToS16(bands->channels(0)[i], num_frames_per_band,
+                  bands16[0].data());
+    FloatS16ToS16(bands->channels(1)[i], num_frames_per_band,
+                  bands16[1].data());
     WebRtcSpl_SynthesisQMF(bands16[0].data(), bands16[1].data(),
-                           bands->num_frames_per_band(), full_band16.data(),
+                           num_frames_per_band, full_band16.data(),
                            two_bands_states_[i].synthesis_state1,
                            two_bands_states_[i].synthesis_state2);
-    S16ToFloatS16(full_band16.data(), full_band16.size(), data->channels(0)[i]);
+    S16ToFloatS16(full_band16.data(), num_frames, data->channels(0)[i]);
   }
 }
 
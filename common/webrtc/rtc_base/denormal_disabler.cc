@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/denormal_disabler.h"
+
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && \
+    (defined(__SSE__) || defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define WEBRTC_DENORMAL_DISABLER_X86
+#elif defined(WEBRTC_ARCH_ARM_FAMILY) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define WEBRTC_DENORMAL_DISABLER_ARM
+#endif
+
+namespace webrtc {
+
+namespace {
+
+#if defined(WEBRTC_DENORMAL_DISABLER_X86)
+// Flush-to-zero and denormals-are-zero bits of MXCSR.
+constexpr uint32_t kDenormalBits = 0x8040;
+
+uint32_t ReadControl() {
+  return _mm_getcsr();
+}
+
+void WriteControl(uint32_t control) {
+  _mm_setcsr(control);
+}
+#elif defined(WEBRTC_DENORMAL_DISABLER_ARM)
+// Flush-to-zero bit of FPCR on ARM64 and of FPSCR on ARMv7, which flushes
+// both inputs and results.
+constexpr uint32_t kDenormalBits = 1 << 24;
+
+uint32_t ReadControl() {
+#if defined(WEBRTC_ARCH_64_BITS)
+  uint64_t control;
+  __asm__ __volatile__("mrs %0, fpcr" : "=r"(control));
+  return static_cast<uint32_t>(control);
+#else
+  uint32_t control;
+  __asm__ __volatile__("vmrs %0, fpscr" : "=r"(control));
+  return control;
+#endif
+}
+
+void WriteControl(uint32_t control) {
+#if defined(WEBRTC_ARCH_64_BITS)
+  const uint64_t control64 = control;
+  __asm__ __volatile__("msr fpcr, %0" : : "r"(control64));
+#else
+  __asm__ __volatile__("vmsr fpscr, %0" : : "r"(control));
+#endif
+}
+#endif
+
+}  // namespace
+
+DenormalDisabler::DenormalDisabler() {
+#if defined(WEBRTC_DENORMAL_DISABLER_X86) || \
+    defined(WEBRTC_DENORMAL_DISABLER_ARM)
+  // Writing the control register stalls the pipeline, so a nested guard that
+  // finds the bits already set leaves it alone.
+  const uint32_t control = ReadControl();
+  if ((control & kDenormalBits) != kDenormalBits) {
+    saved_control_ = control;
+    restore_ = true;
+    WriteControl(control | kDenormalBits);
+  }
+#endif
+}
+
+DenormalDisabler::~DenormalDisabler() {
+#if defined(WEBRTC_DENORMAL_DISABLER_X86) || \
+    defined(WEBRTC_DENORMAL_DISABLER_ARM)
+  if (restore_) {
+    WriteControl(saved_control_);
+  }
+#endif
+}
+
+bool DenormalDisabler::IsSupported() {
+#if defined(WEBRTC_DENORMAL_DISABLER_X86) || \
+    defined(WEBRTC_DENORMAL_DISABLER_ARM)
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace webrtc
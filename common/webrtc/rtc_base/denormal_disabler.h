@@ -0,0 +1,46 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_DENORMAL_DISABLER_H_
+#define RTC_BASE_DENORMAL_DISABLER_H_
+
+#include <stdint.h>
+
+#include "rtc_base/constructor_magic.h"
+
+namespace webrtc {
+
+// Makes the floating point unit of the calling thread treat denormal
+// (subnormal) floats as zero for the lifetime of the object: results that
+// would be denormal are flushed to zero, and on x86 denormal inputs are read
+// as zero too. Operations on denormals take a slow microcode path on x86, so
+// recursive states that decay towards zero in silence can otherwise make the
+// per-frame cost jump. The previous mode is restored on destruction, so the
+// guards nest and leave the caller's mode untouched. Does nothing where
+// IsSupported() is false.
+class DenormalDisabler {
+ public:
+  DenormalDisabler();
+  ~DenormalDisabler();
+
+  // Whether denormals can be flushed on this platform: x86 with SSE and ARM.
+  static bool IsSupported();
+
+ private:
+  // The control register before the object was created, if it was changed.
+  uint32_t saved_control_ = 0;
+  bool restore_ = false;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(DenormalDisabler);
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_DENORMAL_DISABLER_H_
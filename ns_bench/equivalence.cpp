@@ -0,0 +1,1423 @@
+// Numerical equivalence checks of the optimized kernels.
+
+#include "equivalence.h"
+
+#include <glob.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "common_audio/channel_buffer.h"
+#include "common_audio/include/audio_util.h"
+#include "common_audio/resampler/polyphase_resampler.h"
+#include "common_audio/resampler/push_sinc_resampler.h"
+#include "common_audio/resampler/sinc_resampler.h"
+#include "common_audio/sparse_fir_filter.h"
+#include "modules/audio_processing/audio_buffer.h"
+#include "modules/audio_processing/legacy_ns/noise_suppression.h"
+#include "modules/audio_processing/legacy_ns/ns_core.h"
+#include "modules/audio_processing/ns/fast_math.h"
+#include "modules/audio_processing/ns/histograms.h"
+#include "modules/audio_processing/ns/noise_suppressor.h"
+#include "modules/audio_processing/ns/ns_fft.h"
+#include "modules/audio_processing/ns/ns_thread_pool.h"
+#include "modules/audio_processing/ns/quantile_noise_estimator.h"
+#include "modules/audio_processing/splitting_filter.h"
+#include "rtc_base/memory/aligned_malloc.h"
+#include "VAFrame/VAFrame.h"
+
+using namespace webrtc;
+
+namespace {
+
+constexpr size_t kFftSize = Ns10msLayout::kFftSize;
+constexpr size_t kNumBins = Ns10msLayout::kFftSizeBy2Plus1;
+
+// Test signal with samples in [-1, 1].
+struct Signal {
+    std::string name;
+    size_t sample_rate = 16000;
+    std::vector<std::vector<float>> channels;
+    bool random = false;
+
+    size_t num_frames() const
+    {
+        return channels[0].size() / (sample_rate / 100);
+    }
+};
+
+// Returns the distance between two floats in units in the last place.
+int64_t UlpDistance(float a, float b)
+{
+    if (isnan(a) || isnan(b)) {
+        return isnan(a) && isnan(b) ? 0 : INT64_MAX;
+    }
+    auto ordered = [](float f) {
+        int32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        return bits < 0 ? static_cast<int64_t>(INT32_MIN) - bits
+                        : static_cast<int64_t>(bits);
+    };
+    return std::abs(ordered(a) - ordered(b));
+}
+
+// Accumulates the differences between the output of a kernel and that of its
+// reference.
+class ErrorStats {
+public:
+    void Add(double reference, double value)
+    {
+        const double error = value - reference;
+        error_energy_ += error * error;
+        reference_energy_ += reference * reference;
+        max_abs_ = std::max(max_abs_, fabs(error));
+    }
+    void AddFloats(float reference, float value)
+    {
+        Add(reference, value);
+        max_ulps_ = std::max(max_ulps_, UlpDistance(reference, value));
+    }
+    // Adds the level difference in dB of two positive amplitudes.
+    void AddLevels(double reference, double value)
+    {
+        const double difference_db = fabs(20.0 * log10(value / reference));
+        max_db_ = std::max(max_db_, difference_db);
+        sum_db_ += difference_db;
+        ++num_levels_;
+    }
+
+    // Energy of the error relative to that of the reference, in dB. Minus
+    // infinity if the outputs are identical.
+    double error_db() const
+    {
+        if (error_energy_ == 0.0) {
+            return -INFINITY;
+        }
+        return 10.0 * log10(error_energy_ / std::max(reference_energy_, 1e-30));
+    }
+    double max_abs() const { return max_abs_; }
+    double max_db() const { return max_db_; }
+    double mean_db() const
+    {
+        return num_levels_ > 0 ? sum_db_ / num_levels_ : 0.0;
+    }
+    double max_ulps() const { return static_cast<double>(max_ulps_); }
+
+private:
+    double error_energy_ = 0.0;
+    double reference_energy_ = 0.0;
+    double max_abs_ = 0.0;
+    double max_db_ = 0.0;
+    double sum_db_ = 0.0;
+    size_t num_levels_ = 0;
+    int64_t max_ulps_ = 0;
+};
+
+// Prints the checks as rows of a table and keeps track of the failures.
+class Report {
+public:
+    Report()
+    {
+        printf("%-22s %-42s %-10s %12s %12s  %s\n", "kernel", "input",
+               "metric", "value", "tolerance", "result");
+    }
+
+    // A check passes if |value| is at most |tolerance|.
+    void Row(const char *kernel, const std::string &input, const char *metric,
+             double value, double tolerance)
+    {
+        const bool passed = value <= tolerance;
+        printf("%-22s %-42.42s %-10s %12.4g %12.4g  %s\n", kernel,
+               input.c_str(), metric, value, tolerance,
+               passed ? "ok" : "FAIL");
+        fflush(stdout);
+        num_failures_ += passed ? 0 : 1;
+    }
+
+    bool passed() const { return num_failures_ == 0; }
+
+private:
+    int num_failures_ = 0;
+};
+
+// Makes noise with a level that changes every 100 ms, between near silence and
+// -6 dBFS, plus a tone of random frequency in every other segment.
+Signal RandomSignal(const char *name, size_t sample_rate, size_t num_channels,
+                    size_t seconds, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.f, 1.f);
+    std::uniform_real_distribution<float> level_db(-90.f, -6.f);
+    std::uniform_real_distribution<float> frequency(50.f, 0.45f * sample_rate);
+
+    Signal signal;
+    signal.name = name;
+    signal.sample_rate = sample_rate;
+    signal.random = true;
+    signal.channels.assign(num_channels,
+                           std::vector<float>(seconds * sample_rate));
+    const size_t segment = sample_rate / 10;
+    for (size_t start = 0; start < seconds * sample_rate; start += segment) {
+        const float amplitude = powf(10.f, level_db(rng) / 20.f);
+        const float tone = (start / segment) % 2 ? amplitude : 0.f;
+        const float omega = 2.f * M_PI * frequency(rng) / sample_rate;
+        for (size_t c = 0; c < num_channels; ++c) {
+            for (size_t n = start; n < start + segment; ++n) {
+                const float x = 0.5f * amplitude * noise(rng) +
+                                tone * sinf(omega * (n - start));
+                signal.channels[c][n] = std::min(1.f, std::max(-1.f, x));
+            }
+        }
+    }
+    return signal;
+}
+
+std::vector<Signal> LoadSignals(const char *pattern)
+{
+    std::vector<Signal> signals;
+    glob_t files;
+    if (glob(pattern, 0, nullptr, &files) != 0) {
+        printf("No files match %s\n", pattern);
+        return signals;
+    }
+    for (size_t f = 0; f < files.gl_pathc; ++f) {
+        const char *path = files.gl_pathv[f];
+        AudioFileFlt af;
+        if (!af.load(path)) {
+            continue;
+        }
+        Signal signal;
+        signal.name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        signal.sample_rate = af.getSampleRate();
+        signal.channels = af.samples;
+        signals.push_back(std::move(signal));
+    }
+    globfree(&files);
+    return signals;
+}
+
+// Returns the first channel of |signal| as a signal of |sample_rate|. The
+// kernel checks only need realistic sample values, not the original rate.
+Signal FirstChannel(const Signal &signal, size_t sample_rate)
+{
+    Signal mono;
+    mono.name = signal.name;
+    mono.sample_rate = sample_rate;
+    mono.random = signal.random;
+    mono.channels.push_back(signal.channels[0]);
+    return mono;
+}
+
+// Compares NrFft with a double precision DFT, and the round trip through the
+// inverse transform with the input.
+void CheckFft(const std::vector<Signal> &signals, Report *report)
+{
+    constexpr size_t kMaxFrames = 1000;
+    std::vector<double> cosines(kFftSize);
+    std::vector<double> sines(kFftSize);
+    for (size_t n = 0; n < kFftSize; ++n) {
+        cosines[n] = cos(2.0 * M_PI * n / kFftSize);
+        sines[n] = sin(2.0 * M_PI * n / kFftSize);
+    }
+
+    NrFft<Ns10msLayout> fft;
+    for (const Signal &signal : signals) {
+        const std::vector<float> &x = signal.channels[0];
+        ErrorStats forward;
+        ErrorStats round_trip;
+        for (size_t start = 0, frame = 0;
+             start + kFftSize <= x.size() && frame < kMaxFrames;
+             start += Ns10msLayout::kNsFrameSize, ++frame) {
+            std::array<float, kFftSize> input;
+            for (size_t n = 0; n < kFftSize; ++n) {
+                input[n] = 32768.f * x[start + n];
+            }
+            std::array<float, kFftSize> time_data = input;
+            std::array<float, kFftSize> real;
+            std::array<float, kFftSize> imag;
+            fft.Fft(time_data, real, imag);
+            // The transform has the sign convention of Ooura's rdft().
+            for (size_t k = 0; k < kNumBins; ++k) {
+                double reference_real = 0.0;
+                double reference_imag = 0.0;
+                for (size_t n = 0; n < kFftSize; ++n) {
+                    reference_real += input[n] * cosines[n * k % kFftSize];
+                    reference_imag += input[n] * sines[n * k % kFftSize];
+                }
+                forward.Add(reference_real, real[k]);
+                forward.Add(reference_imag, imag[k]);
+            }
+
+            fft.Ifft(real, imag, time_data);
+            for (size_t n = 0; n < kFftSize; ++n) {
+                round_trip.Add(input[n], time_data[n]);
+            }
+        }
+        report->Row("fft_forward", signal.name, "err_db", forward.error_db(),
+                    -100.0);
+        report->Row("fft_round_trip", signal.name, "err_db",
+                    round_trip.error_db(), -100.0);
+    }
+}
+
+// Compares the fast_math approximations with the C library over their input
+// range, and the array versions with the scalar ones. The tolerances of the
+// approximations are their current errors, so that a faster approximation
+// must be at least as accurate.
+void CheckFastMath(Report *report)
+{
+    constexpr size_t kNumValues = 100000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> exponent(-20.f, 20.f);
+    std::uniform_real_distribution<float> power(-2.f, 2.f);
+    std::uniform_real_distribution<float> argument(-30.f, 30.f);
+
+    std::vector<float> positive(kNumValues);
+    std::vector<float> arguments(kNumValues);
+    for (size_t i = 0; i < kNumValues; ++i) {
+        positive[i] = powf(10.f, exponent(rng));
+        arguments[i] = argument(rng);
+    }
+
+    ErrorStats sqrt_stats;
+    ErrorStats log_stats;
+    ErrorStats exp_stats;
+    ErrorStats pow_stats;
+    for (size_t i = 0; i < kNumValues; ++i) {
+        const float x = positive[i];
+        sqrt_stats.AddFloats(sqrtf(x), SqrtFastApproximation(x));
+        log_stats.Add(log(static_cast<double>(x)), LogApproximation(x));
+        exp_stats.AddLevels(exp(static_cast<double>(arguments[i])),
+                            ExpApproximation(arguments[i]));
+        // The powers are kept within the float range.
+        const float base = sqrtf(x);
+        const float p = power(rng);
+        pow_stats.AddLevels(pow(static_cast<double>(base), p),
+                            PowApproximation(base, p));
+    }
+    report->Row("sqrt_approximation", "log-uniform 1e-20..1e20", "ulps",
+                sqrt_stats.max_ulps(), 0.0);
+    report->Row("log_approximation", "log-uniform 1e-20..1e20", "max_abs",
+                log_stats.max_abs(), 0.06);
+    report->Row("exp_approximation", "uniform -30..30", "max_db",
+                exp_stats.max_db(), 1.7);
+    report->Row("pow_approximation", "x 1e-10..1e10, p -2..2", "max_db",
+                pow_stats.max_db(), 1.1);
+
+    std::vector<float> log_array(kNumValues);
+    std::vector<float> exp_array(kNumValues);
+    std::vector<float> exp_sign_flip_array(kNumValues);
+    LogApproximation(positive, log_array);
+    ExpApproximation(arguments, exp_array);
+    ExpApproximationSignFlip(arguments, exp_sign_flip_array);
+    ErrorStats log_array_stats;
+    ErrorStats exp_array_stats;
+    for (size_t i = 0; i < kNumValues; ++i) {
+        log_array_stats.AddFloats(LogApproximation(positive[i]), log_array[i]);
+        exp_array_stats.AddFloats(ExpApproximation(arguments[i]),
+                                  exp_array[i]);
+        exp_array_stats.AddFloats(ExpApproximation(-arguments[i]),
+                                  exp_sign_flip_array[i]);
+    }
+    report->Row("log_array", "vs scalar", "ulps", log_array_stats.max_ulps(),
+                0.0);
+    report->Row("exp_array", "vs scalar", "ulps", exp_array_stats.max_ulps(),
+                0.0);
+}
+
+// Compares the 8 bit bins of Histograms with int bins over update windows of
+// features drawn around a few levels, so that single bins overflow the 8 bits,
+// and of uniformly spread features, some of them outside the histogram range.
+// The prior model is computed from the bins alone, so equal bins give equal
+// decisions.
+void CheckHistograms(Report *report)
+{
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> uniform(-1.f, 110.f);
+    std::normal_distribution<float> jitter(0.f, 0.2f);
+    const float bin_sizes[] = {kBinSizeLrt, kBinSizeSpecFlat, kBinSizeSpecDiff};
+    for (bool clustered : {true, false}) {
+        Histograms histograms;
+        double max_difference = 0.0;
+        for (int window = 0; window < 20; ++window) {
+            std::array<std::vector<int>, 3> reference;
+            for (std::vector<int> &bins : reference) {
+                bins.assign(kHistogramSize, 0);
+            }
+            histograms.Clear();
+            const float center = uniform(rng);
+            for (int n = 0; n < kFeatureUpdateWindowSize - 1; ++n) {
+                float features[3];
+                for (int f = 0; f < 3; ++f) {
+                    const float value =
+                        clustered ? center + jitter(rng) : 10 * uniform(rng);
+                    features[f] = value * bin_sizes[f];
+                    if (features[f] >= 0.f &&
+                        features[f] < kHistogramSize * bin_sizes[f]) {
+                        ++reference[f][static_cast<size_t>(
+                            features[f] * (1.f / bin_sizes[f]))];
+                    }
+                }
+                histograms.Update(features[0], features[1], features[2]);
+            }
+            const FeatureHistogram *compact[] = {
+                &histograms.get_lrt(), &histograms.get_spectral_flatness(),
+                &histograms.get_spectral_diff()};
+            for (int f = 0; f < 3; ++f) {
+                for (int i = 0; i < kHistogramSize; ++i) {
+                    max_difference = std::max<double>(
+                        max_difference,
+                        abs((*compact[f])[i] - reference[f][i]));
+                }
+            }
+        }
+        report->Row("histograms", clustered ? "clustered features"
+                                            : "uniform features",
+                    "max_abs", max_difference, 0.0);
+    }
+}
+
+// QuantileNoiseEstimator in double precision with exact logarithms and
+// exponentials.
+class ReferenceQuantileEstimator {
+public:
+    ReferenceQuantileEstimator()
+        : density_(kSimult * kNumBins, 0.3),
+          log_quantile_(kSimult * kNumBins, 8.0),
+          quantile_(kNumBins, 0.0)
+    {
+        for (int s = 0; s < kSimult; ++s) {
+            counter_[s] = static_cast<int>(
+                floor(kLongStartupPhaseBlocks * (s + 1.0) / kSimult));
+        }
+    }
+
+    void Estimate(const float *signal_spectrum, double *noise_spectrum)
+    {
+        int quantile_index_to_return = -1;
+        for (int s = 0, k = 0; s < kSimult; ++s, k += kNumBins) {
+            const double one_by_counter_plus_1 = 1.0 / (counter_[s] + 1.0);
+            for (size_t i = 0; i < kNumBins; ++i) {
+                const double log_spectrum = log(signal_spectrum[i]);
+                double &density = density_[k + i];
+                double &log_quantile = log_quantile_[k + i];
+                const double delta = density > 1.0 ? 40.0 / density : 40.0;
+                const double multiplier = delta * one_by_counter_plus_1;
+                if (log_spectrum > log_quantile) {
+                    log_quantile += 0.25 * multiplier;
+                } else {
+                    log_quantile -= 0.75 * multiplier;
+                }
+                constexpr double kWidth = 0.01;
+                if (fabs(log_spectrum - log_quantile) < kWidth) {
+                    density = (counter_[s] * density + 1.0 / (2.0 * kWidth)) *
+                              one_by_counter_plus_1;
+                }
+            }
+            if (counter_[s] >= kLongStartupPhaseBlocks) {
+                counter_[s] = 0;
+                if (num_updates_ >= kLongStartupPhaseBlocks) {
+                    quantile_index_to_return = k;
+                }
+            }
+            ++counter_[s];
+        }
+
+        if (num_updates_ < kLongStartupPhaseBlocks) {
+            quantile_index_to_return = kNumBins * (kSimult - 1);
+            ++num_updates_;
+        }
+        if (quantile_index_to_return >= 0) {
+            for (size_t i = 0; i < kNumBins; ++i) {
+                quantile_[i] = exp(log_quantile_[quantile_index_to_return + i]);
+            }
+        }
+        std::copy(quantile_.begin(), quantile_.end(), noise_spectrum);
+    }
+
+private:
+    std::vector<double> density_;
+    std::vector<double> log_quantile_;
+    std::vector<double> quantile_;
+    int counter_[kSimult];
+    int num_updates_ = 1;
+};
+
+// Compares QuantileNoiseEstimator with the reference on the magnitude spectra
+// of Hann windowed frames, after the startup phase. The approximated logarithm
+// can flip the comparisons with the quantile, so single bins of the two
+// estimates may differ by many dB; the mean difference is held instead. The
+// level jumps of the random signals make the estimates diverge further.
+void CheckQuantileNoiseEstimator(const std::vector<Signal> &signals,
+                                 Report *report)
+{
+    std::array<float, kFftSize> window;
+    for (size_t n = 0; n < kFftSize; ++n) {
+        window[n] = 0.5f - 0.5f * cosf(2.f * M_PI * n / kFftSize);
+    }
+
+    NrFft<Ns10msLayout> fft;
+    for (const Signal &signal : signals) {
+        const std::vector<float> &x = signal.channels[0];
+        QuantileNoiseEstimator<Ns10msLayout> estimator;
+        ReferenceQuantileEstimator reference;
+        ErrorStats stats;
+        for (size_t start = 0, frame = 0; start + kFftSize <= x.size();
+             start += Ns10msLayout::kNsFrameSize, ++frame) {
+            std::array<float, kFftSize> time_data;
+            for (size_t n = 0; n < kFftSize; ++n) {
+                time_data[n] = 32768.f * x[start + n] * window[n];
+            }
+            std::array<float, kFftSize> real;
+            std::array<float, kFftSize> imag;
+            fft.Fft(time_data, real, imag);
+            // The floor keeps the logarithms finite on digital silence.
+            std::array<float, kNumBins> spectrum;
+            for (size_t k = 0; k < kNumBins; ++k) {
+                spectrum[k] =
+                    sqrtf(real[k] * real[k] + imag[k] * imag[k]) + 1.f;
+            }
+
+            std::array<float, kNumBins> noise;
+            std::array<double, kNumBins> reference_noise;
+            estimator.Estimate(spectrum, noise);
+            reference.Estimate(spectrum.data(), reference_noise.data());
+            if (frame >= kLongStartupPhaseBlocks) {
+                for (size_t k = 0; k < kNumBins; ++k) {
+                    stats.AddLevels(reference_noise[k], noise[k]);
+                }
+            }
+        }
+        report->Row("quantile_noise", signal.name, "mean_db", stats.mean_db(),
+                    signal.random ? 5.0 : 1.5);
+    }
+}
+
+// Compares SparseFIRFilter with a direct form filter in double precision,
+// dense and sparse, on blocks of varying length.
+void CheckSparseFirFilter(const std::vector<Signal> &signals, Report *report)
+{
+    struct {
+        size_t num_coefficients;
+        size_t sparsity;
+        size_t offset;
+    } const kFilters[] = {{16, 1, 0}, {4, 3, 2}};
+    const size_t kBlockSizes[] = {160, 37, 480, 1};
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> coefficient(-1.f, 1.f);
+    for (const Signal &signal : signals) {
+        const std::vector<float> &x = signal.channels[0];
+        ErrorStats stats;
+        for (const auto &f : kFilters) {
+            std::vector<float> coefficients(f.num_coefficients);
+            for (float &c : coefficients) {
+                c = coefficient(rng);
+            }
+            SparseFIRFilter filter(coefficients.data(), coefficients.size(),
+                                   f.sparsity, f.offset);
+            std::vector<float> y(x.size());
+            for (size_t start = 0, b = 0; start < x.size(); ++b) {
+                const size_t length =
+                    std::min(kBlockSizes[b % 4], x.size() - start);
+                filter.Filter(&x[start], length, &y[start]);
+                start += length;
+            }
+            for (size_t n = 0; n < x.size(); ++n) {
+                double reference = 0.0;
+                for (size_t i = 0; i < coefficients.size(); ++i) {
+                    const size_t delay = f.offset + i * f.sparsity;
+                    if (n >= delay) {
+                        reference += coefficients[i] * x[n - delay];
+                    }
+                }
+                stats.Add(reference, y[n]);
+            }
+        }
+        report->Row("sparse_fir", signal.name, "err_db", stats.error_db(),
+                    -120.0);
+    }
+}
+
+// Cascade of three first order allpass sections of the 2 band QMF filter bank
+// in double precision, with the Q16 coefficients of splitting_filter.c.
+class ReferenceAllpass {
+public:
+    explicit ReferenceAllpass(const uint16_t coefficients[3])
+    {
+        for (int i = 0; i < 3; ++i) {
+            a_[i] = coefficients[i] / 65536.0;
+        }
+    }
+
+    double Filter(double x)
+    {
+        for (int i = 0; i < 3; ++i) {
+            const double y = x_[i] + a_[i] * (x - y_[i]);
+            x_[i] = x;
+            y_[i] = y;
+            x = y;
+        }
+        return x;
+    }
+
+private:
+    double a_[3];
+    double x_[3] = {0.0, 0.0, 0.0};
+    double y_[3] = {0.0, 0.0, 0.0};
+};
+
+const uint16_t kAllpassCoefficients1[3] = {6418, 36982, 57261};
+const uint16_t kAllpassCoefficients2[3] = {21333, 49062, 63010};
+
+// Compares the fixed-point 2 band analysis and synthesis of SplittingFilter
+// with the QMF filter bank in double precision. The synthesis reference is
+// fed the bands of the analysis under test, so that the two errors do not add
+// up. Both are limited by the 16 bit quantization of the bands.
+void CheckTwoBandFilterBank(const std::vector<Signal> &signals,
+                            Report *report)
+{
+    constexpr size_t kNumFrames = 320;
+    constexpr size_t kBandSize = kNumFrames / 2;
+    for (const Signal &signal : signals) {
+        const std::vector<float> &x = signal.channels[0];
+        SplittingFilter filter(1, 2, kNumFrames);
+        ChannelBuffer<float> data(kNumFrames, 1);
+        ChannelBuffer<float> bands(kNumFrames, 1, 2);
+        ReferenceAllpass analysis_odd(kAllpassCoefficients1);
+        ReferenceAllpass analysis_even(kAllpassCoefficients2);
+        ReferenceAllpass synthesis_sum(kAllpassCoefficients2);
+        ReferenceAllpass synthesis_difference(kAllpassCoefficients1);
+        ErrorStats analysis;
+        ErrorStats synthesis;
+        for (size_t start = 0; start + kNumFrames <= x.size();
+             start += kNumFrames) {
+            float *samples = data.channels()[0];
+            for (size_t n = 0; n < kNumFrames; ++n) {
+                samples[n] = 16384.f * x[start + n];
+            }
+            filter.Analysis(&data, &bands);
+            const float *low = bands.channels(0)[0];
+            const float *high = bands.channels(1)[0];
+            for (size_t i = 0; i < kBandSize; ++i) {
+                const double odd = analysis_odd.Filter(
+                    std::round(samples[2 * i + 1]));
+                const double even = analysis_even.Filter(
+                    std::round(samples[2 * i]));
+                analysis.Add(0.5 * (odd + even), low[i]);
+                analysis.Add(0.5 * (odd - even), high[i]);
+            }
+
+            std::vector<double> reference(kNumFrames);
+            for (size_t i = 0; i < kBandSize; ++i) {
+                reference[2 * i + 1] = synthesis_sum.Filter(low[i] + high[i]);
+                reference[2 * i] =
+                    synthesis_difference.Filter(low[i] - high[i]);
+            }
+            filter.Synthesis(&bands, &data);
+            for (size_t n = 0; n < kNumFrames; ++n) {
+                synthesis.Add(reference[n], data.channels()[0][n]);
+            }
+        }
+        report->Row("two_band_analysis", signal.name, "err_db",
+                    analysis.error_db(), -60.0);
+        report->Row("two_band_synthesis", signal.name, "err_db",
+                    synthesis.error_db(), -60.0);
+    }
+}
+
+// Low-pass prototype of the 3 band filter bank, the kLowpassCoeffs of
+// three_band_filter_bank.cc read column by column as its 48 taps.
+const float kThreeBandLowpassCoeffs[12][4] = {
+    {-0.00047749f, -0.00496888f, +0.16547118f, +0.00425496f},
+    {-0.00173287f, -0.01585778f, +0.14989004f, +0.00994113f},
+    {-0.00304815f, -0.02536082f, +0.12154542f, +0.01157993f},
+    {-0.00383509f, -0.02982767f, +0.08543175f, +0.00983212f},
+    {-0.00346946f, -0.02587886f, +0.04760441f, +0.00607594f},
+    {-0.00154717f, -0.01136076f, +0.01387458f, +0.00186353f},
+    {+0.00186353f, +0.01387458f, -0.01136076f, -0.00154717f},
+    {+0.00607594f, +0.04760441f, -0.02587886f, -0.00346946f},
+    {+0.00983212f, +0.08543175f, -0.02982767f, -0.00383509f},
+    {+0.01157993f, +0.12154542f, -0.02536082f, -0.00304815f},
+    {+0.00994113f, +0.14989004f, -0.01585778f, -0.00173287f},
+    {+0.00425496f, +0.16547118f, -0.00496888f, -0.00047749f}};
+
+// Direct form of the 3 band filter bank in double precision. Band b is
+// filtered by the prototype modulated to its center frequency, g_b[n] =
+// 2 h[n] cos(pi n (2b + 1) / 6), and decimated by 3 at phase 2. The synthesis
+// upsamples each band by 3 with zeros, filters it by 3 g_b and sums the bands.
+// The polyphase filters and DCT modulation of ThreeBandFilterBank compute the
+// same sums in another order.
+class ReferenceThreeBand {
+public:
+    static constexpr size_t kNumTaps = 48;
+
+    ReferenceThreeBand()
+    {
+        for (size_t b = 0; b < 3; ++b) {
+            for (size_t n = 0; n < kNumTaps; ++n) {
+                const double h = kThreeBandLowpassCoeffs[n % 12][n / 12];
+                g_[b][n] = 2.0 * h * cos(M_PI * n * (2 * b + 1) / 6.0);
+            }
+        }
+    }
+
+    // Returns sample m of band b of the analysis of the whole signal |x|.
+    double Analysis(const std::vector<float> &x, size_t b, size_t m) const
+    {
+        double sum = 0.0;
+        for (size_t n = 0; n < kNumTaps && n <= 3 * m + 2; ++n) {
+            sum += g_[b][n] * x[3 * m + 2 - n];
+        }
+        return sum;
+    }
+
+    // Returns sample k of the synthesis of the whole band signals |bands|.
+    double Synthesis(const std::vector<float> (&bands)[3], size_t k) const
+    {
+        double sum = 0.0;
+        for (size_t n = k % 3; n < kNumTaps && n <= k; n += 3) {
+            for (size_t b = 0; b < 3; ++b) {
+                sum += 3.0 * g_[b][n] * bands[b][(k - n) / 3];
+            }
+        }
+        return sum;
+    }
+
+private:
+    double g_[3][kNumTaps];
+};
+
+constexpr size_t ReferenceThreeBand::kNumTaps;
+
+// Compares the 3 band analysis and synthesis of SplittingFilter with the
+// direct form filter bank in double precision, each on its own: the synthesis
+// reference is fed the bands of the analysis under test. The filter bank does
+// not reconstruct its input, so the round trip is no reference for either.
+void CheckThreeBandFilterBank(const std::vector<Signal> &signals,
+                              Report *report)
+{
+    constexpr size_t kNumFrames = 480;
+    constexpr size_t kBandSize = kNumFrames / 3;
+    const ReferenceThreeBand reference;
+    for (const Signal &signal : signals) {
+        const size_t length = signal.channels[0].size() / kNumFrames *
+                              kNumFrames;
+        std::vector<float> x(length);
+        for (size_t n = 0; n < length; ++n) {
+            x[n] = 32768.f * signal.channels[0][n];
+        }
+
+        SplittingFilter filter(1, 3, kNumFrames);
+        ChannelBuffer<float> data(kNumFrames, 1);
+        ChannelBuffer<float> bands(kNumFrames, 1, 3);
+        std::vector<float> band_signals[3];
+        std::vector<float> y;
+        for (size_t start = 0; start < length; start += kNumFrames) {
+            memcpy(data.channels()[0], &x[start], kNumFrames * sizeof(float));
+            filter.Analysis(&data, &bands);
+            for (size_t b = 0; b < 3; ++b) {
+                const float *band = bands.channels(b)[0];
+                band_signals[b].insert(band_signals[b].end(), band,
+                                       band + kBandSize);
+            }
+            filter.Synthesis(&bands, &data);
+            y.insert(y.end(), data.channels()[0],
+                     data.channels()[0] + kNumFrames);
+        }
+
+        ErrorStats analysis;
+        for (size_t b = 0; b < 3; ++b) {
+            for (size_t m = 0; m < band_signals[b].size(); ++m) {
+                analysis.Add(reference.Analysis(x, b, m), band_signals[b][m]);
+            }
+        }
+        ErrorStats synthesis;
+        for (size_t k = 0; k < y.size(); ++k) {
+            synthesis.Add(reference.Synthesis(band_signals, k), y[k]);
+        }
+        report->Row("three_band_analysis", signal.name, "err_db",
+                    analysis.error_db(), -120.0);
+        report->Row("three_band_synthesis", signal.name, "err_db",
+                    synthesis.error_db(), -120.0);
+    }
+}
+
+class NullResamplerCallback : public SincResamplerCallback {
+public:
+    void Run(size_t frames, float *destination) override
+    {
+        memset(destination, 0, frames * sizeof(float));
+    }
+};
+
+// Compares the SIMD convolution of SincResampler with the C one, using the
+// kernels of a 48 to 16 kHz resampler at every sub-sample offset.
+void CheckSincConvolve(const std::vector<Signal> &signals, Report *report)
+{
+    constexpr size_t kKernelSize = SincResampler::kKernelSize;
+    constexpr size_t kMaxSamples = 200000;
+    NullResamplerCallback callback;
+    SincResampler resampler(3.0, SincResampler::kDefaultRequestSize,
+                            &callback);
+    const float *kernels = resampler.get_kernel_for_testing();
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> factor(0.0, 1.0);
+    for (const Signal &signal : signals) {
+        const std::vector<float> &x = signal.channels[0];
+        std::vector<float> input(x.size());
+        std::transform(x.begin(), x.end(), input.begin(),
+                       [](float v) { return 32768.f * v; });
+        ErrorStats stats;
+        for (size_t n = 0; n + kKernelSize <= input.size() && n < kMaxSamples;
+             ++n) {
+            const size_t offset = n % SincResampler::kKernelOffsetCount;
+            const float *k1 = kernels + offset * kKernelSize;
+            const float *k2 = k1 + kKernelSize;
+            const double f = factor(rng);
+            stats.Add(
+                SincResampler::ConvolveForTesting(false, &input[n], k1, k2, f),
+                SincResampler::ConvolveForTesting(true, &input[n], k1, k2, f));
+        }
+        report->Row("sinc_convolve", signal.name, "err_db", stats.error_db(),
+                    -120.0);
+    }
+}
+
+// Compares the kernels that SetRatio() computes into the resampler's own
+// storage with the cached kernels of a resampler constructed with the ratio.
+// They must be identical.
+void CheckSincSetRatio(Report *report)
+{
+    constexpr size_t kStorageSize = SincResampler::kKernelStorageSize;
+    NullResamplerCallback callback;
+    for (double ratio : {3.0, 2.0, 0.5, 44100.0 / 16000.0}) {
+        SincResampler reference(ratio, SincResampler::kDefaultRequestSize,
+                                &callback);
+        SincResampler resampler(1.5, SincResampler::kDefaultRequestSize,
+                                &callback);
+        resampler.SetRatio(ratio);
+        const float *expected = reference.get_kernel_for_testing();
+        const float *actual = resampler.get_kernel_for_testing();
+        double max_difference = 0.0;
+        for (size_t i = 0; i < kStorageSize; ++i) {
+            max_difference = std::max<double>(
+                max_difference, fabs(expected[i] - actual[i]));
+        }
+        char input[32];
+        snprintf(input, sizeof(input), "1.5 -> %.4f", ratio);
+        report->Row("sinc_set_ratio", input, "max_diff", max_difference, 0.0);
+    }
+}
+
+// Compares MultiChannelPushSincResampler with one PushSincResampler per
+// channel, at down- and upsampling ratios with 1 to 16 channels made of the
+// signal shifted by a different offset per channel. The outputs must be
+// identical.
+void CheckMultiChannelResampler(const std::vector<Signal> &signals,
+                                Report *report)
+{
+    struct Ratio {
+        size_t source_frames;
+        size_t destination_frames;
+    };
+    const Ratio kRatios[] = {{480, 160}, {441, 160}, {160, 480}};
+    for (const Signal &signal : signals) {
+        const std::vector<float> &x = signal.channels[0];
+        double max_difference = 0.0;
+        for (const Ratio &ratio : kRatios) {
+            for (size_t num_channels : {1, 2, 5, 16}) {
+                MultiChannelPushSincResampler multichannel(
+                    ratio.source_frames, ratio.destination_frames,
+                    num_channels);
+                std::vector<std::unique_ptr<PushSincResampler>> references;
+                for (size_t ch = 0; ch < num_channels; ++ch) {
+                    references.emplace_back(new PushSincResampler(
+                        ratio.source_frames, ratio.destination_frames));
+                }
+                ChannelBuffer<float> input(ratio.source_frames, num_channels);
+                ChannelBuffer<float> output(ratio.destination_frames,
+                                            num_channels);
+                std::vector<float> reference(ratio.destination_frames);
+                for (size_t start = 0; start + ratio.source_frames +
+                                           997 * num_channels <= x.size();
+                     start += ratio.source_frames) {
+                    for (size_t ch = 0; ch < num_channels; ++ch) {
+                        memcpy(input.channels()[ch], &x[start + 997 * ch],
+                               ratio.source_frames * sizeof(float));
+                    }
+                    multichannel.Resample(
+                        rtc::ArrayView<const float *const>(input.channels(),
+                                                           num_channels),
+                        ratio.source_frames,
+                        rtc::ArrayView<float *const>(output.channels(),
+                                                     num_channels),
+                        ratio.destination_frames);
+                    for (size_t ch = 0; ch < num_channels; ++ch) {
+                        references[ch]->Resample(
+                            input.channels()[ch], ratio.source_frames,
+                            reference.data(), ratio.destination_frames);
+                        for (size_t k = 0; k < ratio.destination_frames; ++k) {
+                            max_difference = std::max<double>(
+                                max_difference,
+                                fabs(output.channels()[ch][k] - reference[k]));
+                        }
+                    }
+                }
+            }
+        }
+        report->Row("multichannel_sinc", signal.name, "max_abs",
+                    max_difference, 0.0);
+    }
+}
+
+// Compares PolyphaseResampler with MultiChannelPushSincResampler on mono and
+// stereo signals. Downsampling and upsampling by two use kernels of the sinc
+// table without interpolation and must give identical outputs; the other
+// upsampling ratios interpolate between sinc kernels and must be close. Also
+// compares the SIMD polyphase convolution with the C one.
+void CheckPolyphaseResampler(const std::vector<Signal> &signals,
+                             Report *report)
+{
+    struct Ratio {
+        size_t source_frames;
+        size_t destination_frames;
+        bool exact;
+    };
+    const Ratio kRatios[] = {{480, 160, true},  {320, 160, true},
+                             {480, 80, true},   {160, 320, true},
+                             {160, 480, false}, {80, 480, false}};
+    constexpr size_t kKernelSize = SincResampler::kKernelSize;
+    constexpr size_t kNumChannels = 2;
+    for (const Signal &signal : signals) {
+        const std::vector<float> &x = signal.channels[0];
+        double max_difference = 0.0;
+        ErrorStats interpolated;
+        ErrorStats convolve;
+        for (const Ratio &ratio : kRatios) {
+            PolyphaseResampler polyphase(ratio.source_frames,
+                                         ratio.destination_frames,
+                                         kNumChannels);
+            MultiChannelPushSincResampler sinc(ratio.source_frames,
+                                               ratio.destination_frames,
+                                               kNumChannels);
+            ChannelBuffer<float> input(ratio.source_frames, kNumChannels);
+            ChannelBuffer<float> output(ratio.destination_frames,
+                                        kNumChannels);
+            ChannelBuffer<float> reference(ratio.destination_frames,
+                                           kNumChannels);
+            for (size_t start = 0;
+                 start + ratio.source_frames + 997 <= x.size();
+                 start += ratio.source_frames) {
+                for (size_t ch = 0; ch < kNumChannels; ++ch) {
+                    memcpy(input.channels()[ch], &x[start + 997 * ch],
+                           ratio.source_frames * sizeof(float));
+                }
+                rtc::ArrayView<const float *const> source(input.channels(),
+                                                          kNumChannels);
+                polyphase.Resample(source, ratio.source_frames,
+                                   rtc::ArrayView<float *const>(
+                                       output.channels(), kNumChannels),
+                                   ratio.destination_frames);
+                sinc.Resample(source, ratio.source_frames,
+                              rtc::ArrayView<float *const>(
+                                  reference.channels(), kNumChannels),
+                              ratio.destination_frames);
+                for (size_t ch = 0; ch < kNumChannels; ++ch) {
+                    for (size_t k = 0; k < ratio.destination_frames; ++k) {
+                        const float value = output.channels()[ch][k];
+                        const float expected = reference.channels()[ch][k];
+                        if (ratio.exact) {
+                            max_difference = std::max<double>(
+                                max_difference, fabs(value - expected));
+                        } else {
+                            interpolated.Add(expected, value);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Any kernel will do for the convolution.
+        std::unique_ptr<float[], AlignedFreeDeleter> kernel(
+            static_cast<float *>(
+                AlignedMalloc(sizeof(float) * kKernelSize, 16)));
+        SincResampler::ComputeKernel(3.0, 0.25f, kernel.get());
+        for (size_t n = 0; n + kKernelSize <= x.size(); ++n) {
+            convolve.Add(
+                PolyphaseResampler::ConvolveForTesting(false, &x[n],
+                                                       kernel.get()),
+                PolyphaseResampler::ConvolveForTesting(true, &x[n],
+                                                       kernel.get()));
+        }
+
+        report->Row("polyphase_exact", signal.name, "max_abs", max_difference,
+                    0.0);
+        report->Row("polyphase_interp", signal.name, "err_db",
+                    interpolated.error_db(), -60.0);
+        report->Row("polyphase_convolve", signal.name, "err_db",
+                    convolve.error_db(), -120.0);
+    }
+}
+
+// Splits a long run into windows and keeps the error of each, to tell a
+// constant error from one that accumulates.
+class WindowedErrors {
+public:
+    WindowedErrors(size_t num_frames, size_t num_windows)
+        : num_frames_(num_frames), windows_(num_windows) {}
+
+    ErrorStats &ForFrame(size_t frame)
+    {
+        return windows_[frame * windows_.size() / num_frames_];
+    }
+
+    double worst_error_db() const
+    {
+        double worst = -INFINITY;
+        for (const ErrorStats &w : windows_) {
+            worst = std::max(worst, w.error_db());
+        }
+        return worst;
+    }
+
+    // Mean error of the last quarter of the windows minus that of the second
+    // quarter, with exact windows counted as -200 dB. The first quarter is
+    // left out since the two versions start from the same state and take a
+    // while to differ.
+    double growth_db() const
+    {
+        const size_t quarter = std::max<size_t>(1, windows_.size() / 4);
+        double second = 0.0;
+        double last = 0.0;
+        for (size_t i = 0; i < quarter; ++i) {
+            second += std::max(-200.0, windows_[quarter + i].error_db());
+            last += std::max(-200.0,
+                             windows_[windows_.size() - 1 - i].error_db());
+        }
+        return (last - second) / quarter;
+    }
+
+private:
+    const size_t num_frames_;
+    std::vector<ErrorStats> windows_;
+};
+
+// The legacy float suppressor run with the generic C and with the SIMD
+// per-frequency functions side by side. The functions are selected globally,
+// so they are switched before each instance runs.
+class LegacySimdPair {
+public:
+    LegacySimdPair()
+    {
+        for (int simd = 0; simd < 2; ++simd) {
+            WebRtcNs_EnableSimd(simd);
+            states_[simd] = WebRtcNs_Create();
+            WebRtcNs_Init(states_[simd], 16000);
+            WebRtcNs_set_policy(states_[simd], 2);
+        }
+    }
+    ~LegacySimdPair()
+    {
+        for (NsHandle *state : states_) {
+            WebRtcNs_Free(state);
+        }
+        WebRtcNs_EnableSimd(1);
+    }
+
+    // Processes a 10 ms frame at 16 kHz in the S16 range with both instances.
+    void Process(const float *frame, float *c_output, float *simd_output)
+    {
+        float *outputs[] = {c_output, simd_output};
+        for (int simd = 0; simd < 2; ++simd) {
+            WebRtcNs_EnableSimd(simd);
+            WebRtcNs_Analyze(states_[simd], frame);
+            WebRtcNs_Process(states_[simd], &frame, 1, &outputs[simd]);
+        }
+    }
+
+private:
+    NsHandle *states_[2];
+};
+
+void CheckLegacySimd(const std::vector<Signal> &signals, Report *report)
+{
+    constexpr size_t kFrameSize = 160;
+    for (const Signal &signal : signals) {
+        const std::vector<float> &x = signal.channels[0];
+        LegacySimdPair pair;
+        ErrorStats stats;
+        float frame[kFrameSize];
+        float c_output[kFrameSize];
+        float simd_output[kFrameSize];
+        for (size_t start = 0; start + kFrameSize <= x.size();
+             start += kFrameSize) {
+            for (size_t n = 0; n < kFrameSize; ++n) {
+                frame[n] = 32768.f * x[start + n];
+            }
+            pair.Process(frame, c_output, simd_output);
+            for (size_t n = 0; n < kFrameSize; ++n) {
+                stats.Add(c_output[n], simd_output[n]);
+            }
+        }
+        report->Row("legacy_simd", signal.name, "err_db", stats.error_db(),
+                    -80.0);
+    }
+}
+
+// Runs two suppressors side by side over |num_frames| 10 ms frames made by
+// |make_frame|, and passes the outputs of each frame to |compare|.
+template <typename MakeFrame, typename Compare>
+void RunSuppressorPair(NoiseSuppressor *a, NoiseSuppressor *b,
+                       size_t sample_rate, size_t num_channels,
+                       size_t num_frames, const MakeFrame &make_frame,
+                       const Compare &compare)
+{
+    const size_t frame_size = sample_rate / 100;
+    AudioBuffer audio_a(sample_rate, num_channels, sample_rate, num_channels,
+                        sample_rate, num_channels);
+    AudioBuffer audio_b(sample_rate, num_channels, sample_rate, num_channels,
+                        sample_rate, num_channels);
+    ChannelBuffer<float> input(frame_size, num_channels);
+    ChannelBuffer<float> output_a(frame_size, num_channels);
+    ChannelBuffer<float> output_b(frame_size, num_channels);
+
+    NoiseSuppressor *suppressors[] = {a, b};
+    AudioBuffer *buffers[] = {&audio_a, &audio_b};
+    for (size_t i = 0; i < num_frames; ++i) {
+        make_frame(i, input.channels());
+        for (int s = 0; s < 2; ++s) {
+            buffers[s]->CopyFrom(input.channels());
+            if (buffers[s]->num_bands() > 1) {
+                buffers[s]->SplitIntoFrequencyBands();
+            }
+            suppressors[s]->Analyze(*buffers[s]);
+            suppressors[s]->Process(buffers[s]);
+            if (buffers[s]->num_bands() > 1) {
+                buffers[s]->MergeFrequencyBands();
+            }
+        }
+        audio_a.CopyTo(output_a.channels());
+        audio_b.CopyTo(output_b.channels());
+        compare(i, output_a.channels(), output_b.channels());
+    }
+}
+
+// Compares the whole suppressor on every signal: the generic path with the
+// specialized one selected by Create(), and serial with threaded processing
+// of the channels. All must be bit-exact.
+void CheckPipeline(const std::vector<Signal> &signals, Report *report)
+{
+    NsThreadPool thread_pool(1);
+    for (const Signal &signal : signals) {
+        const size_t sample_rate = signal.sample_rate;
+        const size_t num_channels = signal.channels.size();
+        const size_t frame_size = sample_rate / 100;
+        auto make_frame = [&](size_t i, float *const *channels) {
+            for (size_t c = 0; c < num_channels; ++c) {
+                memcpy(channels[c], &signal.channels[c][i * frame_size],
+                       frame_size * sizeof(float));
+            }
+        };
+
+        for (int threaded = 0; threaded < 2; ++threaded) {
+            if (threaded && num_channels < 2) {
+                continue;
+            }
+            NsConfig config;
+            NoiseSuppressor a(config, sample_rate, num_channels);
+            std::unique_ptr<NoiseSuppressor> b =
+                NoiseSuppressor::Create(config, sample_rate, num_channels);
+            if (threaded) {
+                b->SetThreadPool(&thread_pool);
+            }
+            ErrorStats stats;
+            RunSuppressorPair(
+                &a, b.get(), sample_rate, num_channels, signal.num_frames(),
+                make_frame,
+                [&](size_t i, const float *const *x, const float *const *y) {
+                    for (size_t c = 0; c < num_channels; ++c) {
+                        for (size_t n = 0; n < frame_size; ++n) {
+                            stats.AddFloats(x[c][n], y[c][n]);
+                        }
+                    }
+                });
+            report->Row(threaded ? "ns_threaded" : "ns_specialized",
+                        signal.name, "ulps", stats.max_ulps(), 0.0);
+        }
+    }
+}
+
+// Makes 16 bit split-band frames, indexed as [ch * num_bands + band], that
+// change every 100 ms between noise at a random level, a full-scale tone and
+// a tone clipped at the 16 bit limits from four times full scale. The tones
+// drive the output past the 16 bit range, so the saturation is exercised.
+std::vector<std::vector<int16_t>> Int16SplitBands(size_t num_signals,
+                                                  size_t num_frames,
+                                                  uint32_t seed)
+{
+    constexpr size_t kBandSize = 160;
+    constexpr size_t kSegment = 10 * kBandSize;
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.f, 1.f);
+    std::uniform_real_distribution<float> level_db(-90.f, -6.f);
+    std::uniform_real_distribution<float> frequency(0.005f, 0.45f);
+
+    std::vector<std::vector<int16_t>> bands(
+        num_signals, std::vector<int16_t>(num_frames * kBandSize));
+    for (std::vector<int16_t> &band : bands) {
+        for (size_t begin = 0; begin < band.size(); begin += kSegment) {
+            const int kind = (begin / kSegment) % 3;
+            const float level = 32768.f * powf(10.f, level_db(rng) / 20.f);
+            const float omega = 2.f * M_PI * frequency(rng);
+            const size_t end = std::min(band.size(), begin + kSegment);
+            for (size_t n = begin; n < end; ++n) {
+                float x = level * noise(rng);
+                if (kind == 1) {
+                    x = 32767.f * sinf(omega * n);
+                } else if (kind == 2) {
+                    x = 4.f * 32768.f * sinf(omega * n);
+                }
+                band[n] = FloatS16ToS16(x);
+            }
+        }
+    }
+    return bands;
+}
+
+// Compares the 16 bit Analyze and Process overloads with the float path on
+// the same samples followed by FloatS16ToS16, for mono 16 kHz and stereo
+// 48 kHz, generic and specialized. The two must be bit-exact.
+void CheckInt16Pipeline(Report *report)
+{
+    constexpr size_t kBandSize = 160;
+    constexpr size_t kNumFrames = 600;
+    struct {
+        const char *name;
+        size_t sample_rate;
+        size_t num_channels;
+    } const kFormats[] = {
+        {"int16 16k mono", 16000, 1},
+        {"int16 48k stereo", 48000, 2},
+    };
+    for (const auto &format : kFormats) {
+        const size_t num_channels = format.num_channels;
+        AudioBuffer audio(format.sample_rate, num_channels,
+                          format.sample_rate, num_channels,
+                          format.sample_rate, num_channels);
+        const size_t num_bands = audio.num_bands();
+        const size_t num_signals = num_channels * num_bands;
+        const std::vector<std::vector<int16_t>> input =
+            Int16SplitBands(num_signals, kNumFrames, 7);
+
+        for (int specialized = 0; specialized < 2; ++specialized) {
+            auto make_suppressor = [&]() {
+                NsConfig config;
+                if (specialized) {
+                    return NoiseSuppressor::Create(config, format.sample_rate,
+                                                   num_channels);
+                }
+                return std::unique_ptr<NoiseSuppressor>(new NoiseSuppressor(
+                    config, format.sample_rate, num_channels));
+            };
+            std::unique_ptr<NoiseSuppressor> float_ns = make_suppressor();
+            std::unique_ptr<NoiseSuppressor> int16_ns = make_suppressor();
+
+            std::vector<std::vector<int16_t>> float_output(
+                num_signals, std::vector<int16_t>(kBandSize));
+            std::vector<std::vector<int16_t>> int16_output = float_output;
+            std::vector<const int16_t *> in(num_signals);
+            std::vector<int16_t *> out(num_signals);
+            int max_diff = 0;
+            for (size_t i = 0; i < kNumFrames; ++i) {
+                for (size_t k = 0; k < num_signals; ++k) {
+                    in[k] = &input[k][i * kBandSize];
+                }
+                for (size_t c = 0; c < num_channels; ++c) {
+                    audio.ImportSplitChannelData(c, &in[c * num_bands]);
+                }
+                float_ns->Analyze(audio);
+                float_ns->Process(&audio);
+                for (size_t c = 0; c < num_channels; ++c) {
+                    for (size_t b = 0; b < num_bands; ++b) {
+                        out[c * num_bands + b] =
+                            float_output[c * num_bands + b].data();
+                    }
+                    audio.ExportSplitChannelData(c, &out[c * num_bands]);
+                }
+
+                for (size_t k = 0; k < num_signals; ++k) {
+                    out[k] = int16_output[k].data();
+                }
+                int16_ns->Analyze(in);
+                int16_ns->Process(in, out);
+
+                for (size_t k = 0; k < num_signals; ++k) {
+                    for (size_t n = 0; n < kBandSize; ++n) {
+                        max_diff = std::max(
+                            max_diff, abs(float_output[k][n] -
+                                          int16_output[k][n]));
+                    }
+                }
+            }
+            report->Row("ns_int16",
+                        std::string(format.name) +
+                            (specialized ? " specialized" : " generic"),
+                        "max_diff", max_diff, 0.0);
+        }
+    }
+}
+
+// Repeats a 16 kHz mono signal with a random gain on each pass, so that the
+// long runs do not settle into a periodic state.
+class LoopedSignal {
+public:
+    explicit LoopedSignal(const Signal &signal)
+        : samples_(signal.channels[0]), rng_(4), gain_db_(-30.f, 6.f)
+    {
+        frames_per_pass_ = samples_.size() / kFrameSize;
+    }
+
+    void Frame(size_t i, float *frame)
+    {
+        const size_t pass = i / frames_per_pass_;
+        while (gains_.size() <= pass) {
+            gains_.push_back(powf(10.f, gain_db_(rng_) / 20.f));
+        }
+        const float *x = &samples_[(i % frames_per_pass_) * kFrameSize];
+        for (size_t n = 0; n < kFrameSize; ++n) {
+            frame[n] = std::min(1.f, std::max(-1.f, gains_[pass] * x[n]));
+        }
+    }
+
+    static constexpr size_t kFrameSize = 160;
+
+private:
+    const std::vector<float> &samples_;
+    size_t frames_per_pass_;
+    std::mt19937 rng_;
+    std::uniform_real_distribution<float> gain_db_;
+    std::vector<float> gains_;
+};
+
+constexpr size_t LoopedSignal::kFrameSize;
+
+// Runs the pairs over |num_frames| frames of the looped signal, checking that
+// the suppressors stay bit-exact and that the error of the legacy SIMD
+// functions stays inaudible and does not keep growing. The legacy estimators
+// make discrete decisions, such as the quantile and histogram updates, that
+// the rounding differences of the SIMD functions occasionally flip, so over
+// long runs the two versions drift apart by more than over a single file.
+void CheckLongRuns(const Signal &signal, size_t num_frames, Report *report)
+{
+    constexpr size_t kNumWindows = 16;
+    const std::string input =
+        signal.name + " x" + std::to_string(num_frames) + " frames";
+    constexpr size_t kFrameSize = LoopedSignal::kFrameSize;
+
+    {
+        LoopedSignal looped(signal);
+        NsConfig config;
+        NoiseSuppressor generic(config, 16000, 1);
+        std::unique_ptr<NoiseSuppressor> specialized =
+            NoiseSuppressor::Create(config, 16000, 1);
+        ErrorStats stats;
+        RunSuppressorPair(
+            &generic, specialized.get(), 16000, 1, num_frames,
+            [&](size_t i, float *const *channels) {
+                looped.Frame(i, channels[0]);
+            },
+            [&](size_t i, const float *const *x, const float *const *y) {
+                for (size_t n = 0; n < kFrameSize; ++n) {
+                    stats.AddFloats(x[0][n], y[0][n]);
+                }
+            });
+        report->Row("ns_specialized_long", input, "ulps", stats.max_ulps(),
+                    0.0);
+    }
+
+    {
+        LoopedSignal looped(signal);
+        LegacySimdPair pair;
+        WindowedErrors errors(num_frames, kNumWindows);
+        float frame[kFrameSize];
+        float c_output[kFrameSize];
+        float simd_output[kFrameSize];
+        for (size_t i = 0; i < num_frames; ++i) {
+            looped.Frame(i, frame);
+            for (float &x : frame) {
+                x *= 32768.f;
+            }
+            pair.Process(frame, c_output, simd_output);
+            ErrorStats &stats = errors.ForFrame(i);
+            for (size_t n = 0; n < kFrameSize; ++n) {
+                stats.Add(c_output[n], simd_output[n]);
+            }
+        }
+        report->Row("legacy_simd_long", input, "err_db",
+                    errors.worst_error_db(), -60.0);
+        report->Row("legacy_simd_long", input, "growth_db",
+                    errors.growth_db(), 20.0);
+    }
+}
+
+}  // namespace
+
+bool RunEquivalenceChecks(const char *asset_pattern, size_t long_run_frames)
+{
+    std::vector<Signal> random_signals;
+    random_signals.push_back(RandomSignal("random 16k mono", 16000, 1, 10, 5));
+    random_signals.push_back(
+        RandomSignal("random 48k stereo", 48000, 2, 10, 6));
+    std::vector<Signal> signals = random_signals;
+    for (Signal &signal : LoadSignals(asset_pattern)) {
+        signals.push_back(std::move(signal));
+    }
+
+    // The kernel checks use the first channel of every signal.
+    std::vector<Signal> mono_signals;
+    for (const Signal &signal : signals) {
+        mono_signals.push_back(FirstChannel(signal, 16000));
+    }
+
+    Report report;
+    CheckFft(mono_signals, &report);
+    CheckFastMath(&report);
+    CheckHistograms(&report);
+    CheckQuantileNoiseEstimator(mono_signals, &report);
+    CheckSparseFirFilter(mono_signals, &report);
+    CheckTwoBandFilterBank(mono_signals, &report);
+    CheckThreeBandFilterBank(mono_signals, &report);
+    CheckSincConvolve(mono_signals, &report);
+    CheckSincSetRatio(&report);
+    CheckMultiChannelResampler(mono_signals, &report);
+    CheckPolyphaseResampler(mono_signals, &report);
+    CheckLegacySimd(mono_signals, &report);
+    CheckPipeline(signals, &report);
+    CheckInt16Pipeline(&report);
+
+    // The long runs loop the first 16 kHz file, or the random signal if
+    // there is none.
+    const Signal *long_run_signal = &random_signals[0];
+    for (const Signal &signal : signals) {
+        if (signal.sample_rate == 16000 && &signal != &signals[0]) {
+            long_run_signal = &signal;
+            break;
+        }
+    }
+    if (long_run_frames > 0) {
+        CheckLongRuns(FirstChannel(*long_run_signal, 16000), long_run_frames,
+                      &report);
+    }
+
+    printf("%s\n", report.passed() ? "All checks passed"
+                                   : "Some checks FAILED");
+    return report.passed();
+}
@@ -0,0 +1,21 @@
+// Numerical equivalence checks of the optimized kernels.
+//
+// Each check runs an optimized or approximated kernel, or the whole
+// suppressor, next to a scalar reference on the same random and recorded
+// inputs, and compares the two with the tolerance of that kernel: bit-exact,
+// a number of ULPs, or an error level in dB relative to the reference. The
+// long-run checks feed more than a million frames through both versions and
+// also fail if the error grows over the run. A speedup that changes the
+// numerics of a kernel gets a check here before it replaces the kernel.
+
+#ifndef NS_BENCH_EQUIVALENCE_H_
+#define NS_BENCH_EQUIVALENCE_H_
+
+#include <stddef.h>
+
+// Runs all checks on random signals and on the files matching
+// |asset_pattern|, with |long_run_frames| 10 ms frames in the long-run
+// checks. Prints one row per check and returns whether all of them passed.
+bool RunEquivalenceChecks(const char *asset_pattern, size_t long_run_frames);
+
+#endif  // NS_BENCH_EQUIVALENCE_H_
@@ -0,0 +1,2470 @@
+// WebRtc noise suppression benchmarks
+
+#include <glob.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common_audio/channel_buffer.h"
+#include "common_audio/include/audio_util.h"
+#include "common_audio/resampler/polyphase_resampler.h"
+#include "common_audio/resampler/push_sinc_resampler.h"
+#include "common_audio/resampler/sinc_resampler.h"
+#include "common_audio/third_party/fft4g/fft4g.h"
+#include "modules/audio_processing/legacy_noise_suppression.h"
+#include "modules/audio_processing/legacy_ns/ns_core.h"
+#include "modules/audio_processing/ns/histograms.h"
+#include "modules/audio_processing/ns/noise_suppression_stream.h"
+#include "modules/audio_processing/ns/noise_suppressor.h"
+#include "modules/audio_processing/ns/ns_fft.h"
+#include "modules/audio_processing/ns/ns_frame_ring.h"
+#include "modules/audio_processing/ns/ns_scheduler.h"
+#include "modules/audio_processing/ns/ns_two_pass.h"
+#include "AudioFile/AudioFile.h"
+#include "VAFrame/VAFrame.h"
+#include "equivalence.h"
+#include "perf_counters.h"
+#include "rt_check.h"
+
+using namespace webrtc;
+
+namespace {
+
+struct BenchResult {
+    double seconds = 0.0;
+    // Time stamp counter ticks, or zero where there is no counter.
+    uint64_t cycles = 0;
+    size_t num_frames = 0;
+};
+
+double NowSeconds()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t ReadCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+NsConfig BenchConfig()
+{
+    NsConfig cfg;
+    cfg.target_level = NsConfig::SuppressionLevel::k18dB;
+    return cfg;
+}
+
+// Runs a suppressor over the whole file |repeats| times, chunking the audio
+// into |chunk_size_ms| frames, and measures the time spent in the suppressor
+// and the band-split filters. The output of the first pass is stored in
+// |output| and the time of each frame of the first pass in |frame_seconds|,
+// if given.
+template <typename Suppressor>
+BenchResult RunSuppressor(Suppressor *ns, const AudioFileFlt &af,
+                          size_t chunk_size_ms, int repeats,
+                          std::vector<float> *output = nullptr,
+                          std::vector<double> *frame_seconds = nullptr)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t samples = sample_rate * chunk_size_ms / 1000;
+    const size_t total_frames = af.getNumSamplesPerChannel() / samples;
+
+    AudioBuffer ab(sample_rate, num_channels, sample_rate, num_channels,
+                   sample_rate, num_channels, chunk_size_ms);
+
+    VAFrameFlt frame(sample_rate);
+    frame.buf.assign(num_channels, std::vector<float>(samples));
+
+    BenchResult result;
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < total_frames; ++i) {
+            for (size_t c = 0; c < num_channels; ++c) {
+                memcpy(frame.buf[c].data(), &af.samples[c][samples * i],
+                       samples * sizeof(float));
+            }
+
+            const double start = NowSeconds();
+            const uint64_t start_cycles = ReadCycles();
+            ab.CopyFrom(&frame);
+            if (ab.num_bands() > 1) {
+                ab.SplitIntoFrequencyBands();
+            }
+            ns->Analyze(ab);
+            ns->Process(&ab);
+            if (ab.num_bands() > 1) {
+                ab.MergeFrequencyBands();
+            }
+            ab.CopyTo(&frame);
+            result.cycles += ReadCycles() - start_cycles;
+            const double seconds = NowSeconds() - start;
+            result.seconds += seconds;
+
+            if (frame_seconds && r == 0) {
+                frame_seconds->push_back(seconds);
+            }
+            if (output && r == 0) {
+                for (size_t c = 0; c < num_channels; ++c) {
+                    output->insert(output->end(), frame.buf[c].begin(),
+                                   frame.buf[c].end());
+                }
+            }
+        }
+        result.num_frames += total_frames;
+    }
+    return result;
+}
+
+void PrintHeader()
+{
+    printf("%-24s %10s %12s %10s %12s\n", "variant", "frame_ms", "us/frame",
+           "xRT", "delay_ms");
+}
+
+// Prints one result row. The real-time factor is the duration of the
+// processed audio divided by the processing time.
+void PrintRow(const char *name, double chunk_size_ms, const BenchResult &r,
+              double delay_ms)
+{
+    const double us_per_frame = 1e6 * r.seconds / r.num_frames;
+    const double audio_seconds = r.num_frames * chunk_size_ms / 1000.0;
+    printf("%-24s %10.2f %12.2f %10.1f %12.2f\n", name, chunk_size_ms,
+           us_per_frame, audio_seconds / r.seconds, delay_ms);
+}
+
+// Returns the algorithmic delay of a suppressor in ms: the blocking delay of
+// one frame plus the filterbank overlap. Both are counted at the band rate of
+// the suppressor; the band-split filters add their own delay at 32 and 48 kHz
+// when that is 16 kHz.
+template <typename Suppressor>
+double AlgorithmicDelayMs()
+{
+    constexpr double kSamplesPerMs = Suppressor::kBandRateHz / 1000.0;
+    return (Suppressor::kNsFrameSize + Suppressor::kFilterbankDelaySamples) /
+           kSamplesPerMs;
+}
+
+// Compares the 10 ms suppressor with the low-latency 5 ms variant.
+int BenchLayouts(const AudioFileFlt &af, int repeats)
+{
+    NoiseSuppressor ns10(BenchConfig(), af.getSampleRate(),
+                         af.getNumChannels());
+    LowLatencyNoiseSuppressor ns5(BenchConfig(), af.getSampleRate(),
+                                  af.getNumChannels());
+
+    PrintHeader();
+    PrintRow("10ms/fft256", 10, RunSuppressor(&ns10, af, 10, repeats),
+             AlgorithmicDelayMs<NoiseSuppressor>());
+    PrintRow("5ms/fft128", 5, RunSuppressor(&ns5, af, 5, repeats),
+             AlgorithmicDelayMs<LowLatencyNoiseSuppressor>());
+    return 0;
+}
+
+// Compares the generic processing path with the compile-time specialization
+// for the channel and band count of the file, and checks that their outputs
+// are identical.
+int BenchSpecializations(const AudioFileFlt &af, int repeats)
+{
+    NoiseSuppressor generic(BenchConfig(), af.getSampleRate(),
+                            af.getNumChannels());
+    std::unique_ptr<NoiseSuppressor> specialized = NoiseSuppressor::Create(
+        BenchConfig(), af.getSampleRate(), af.getNumChannels());
+    if (!specialized->is_specialized()) {
+        printf("No specialization for %u Hz, %d channels\n",
+               af.getSampleRate(), af.getNumChannels());
+        return 1;
+    }
+
+    std::vector<float> generic_out;
+    std::vector<float> specialized_out;
+    const double delay_ms = AlgorithmicDelayMs<NoiseSuppressor>();
+
+    PrintHeader();
+    PrintRow("generic", 10,
+             RunSuppressor(&generic, af, 10, repeats, &generic_out),
+             delay_ms);
+    PrintRow("specialized", 10,
+             RunSuppressor(specialized.get(), af, 10, repeats,
+                           &specialized_out),
+             delay_ms);
+    printf("bit-exact: %s\n", generic_out == specialized_out ? "yes" : "no");
+    return generic_out == specialized_out ? 0 : 1;
+}
+
+// Runs the file through a NoiseSuppressionStream in chunks of |chunk_size|
+// frames, or of varying size if it is zero, and checks that the output equals
+// |reference| delayed by the latency the stream reports. |reference| is the
+// output of RunSuppressor() for 10 ms frames.
+bool RunStream(const AudioFileFlt &af, size_t chunk_size, int repeats,
+               const std::vector<float> &reference, BenchResult *result)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t block_size = sample_rate / 100;
+    const size_t total_frames =
+        af.getNumSamplesPerChannel() / block_size * block_size;
+
+    std::vector<float> input(total_frames * num_channels);
+    for (size_t n = 0; n < total_frames; ++n) {
+        for (size_t c = 0; c < num_channels; ++c) {
+            input[n * num_channels + c] = af.samples[c][n];
+        }
+    }
+    std::vector<float> output(input.size());
+
+    // Varying chunk sizes cycle through values from 1 frame to two blocks.
+    const size_t kVaryingSizes[] = {1, block_size / 3, 2 * block_size,
+                                    block_size - 1, block_size + 7};
+    bool exact = true;
+    for (int r = 0; r < repeats; ++r) {
+        NoiseSuppressionStream stream(BenchConfig(), sample_rate,
+                                      num_channels, chunk_size);
+        size_t n = 0;
+        size_t num_chunks = 0;
+        const double start = NowSeconds();
+        while (n < total_frames) {
+            size_t size = chunk_size;
+            if (size == 0) {
+                size = kVaryingSizes[num_chunks % 5];
+            }
+            size = std::min(size, total_frames - n);
+            stream.Process(
+                rtc::ArrayView<const float>(&input[n * num_channels],
+                                            size * num_channels),
+                rtc::ArrayView<float>(&output[n * num_channels],
+                                      size * num_channels));
+            n += size;
+            ++num_chunks;
+        }
+        result->seconds += NowSeconds() - start;
+        result->num_frames += num_chunks;
+
+        const size_t latency = stream.latency_frames();
+        for (size_t m = latency; m < total_frames && exact; ++m) {
+            const size_t k = m - latency;
+            const size_t block = k / block_size;
+            for (size_t c = 0; c < num_channels; ++c) {
+                const float expected =
+                    reference[(block * num_channels + c) * block_size +
+                              k % block_size];
+                exact = exact && output[m * num_channels + c] == expected;
+            }
+        }
+    }
+    return exact;
+}
+
+// Compares the streaming front end at several chunk sizes with feeding the
+// suppressor 10 ms frames directly, and checks that the streamed output is the
+// direct output delayed by the reported latency.
+int BenchStream(const AudioFileFlt &af, int repeats)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const double ms_per_frame = 1000.0 / sample_rate;
+    if (NsProcessingRateHz(sample_rate, BenchConfig().processing_rate) !=
+        sample_rate) {
+        printf("The direct path needs a 16, 32 or 48 kHz file\n");
+        return 1;
+    }
+    std::unique_ptr<NoiseSuppressor> direct = NoiseSuppressor::Create(
+        BenchConfig(), sample_rate, af.getNumChannels());
+    std::vector<float> reference;
+    const double overlap_ms = NoiseSuppressor::kFilterbankDelaySamples / 16.0;
+
+    PrintHeader();
+    PrintRow("direct", 10,
+             RunSuppressor(direct.get(), af, 10, repeats, &reference),
+             AlgorithmicDelayMs<NoiseSuppressor>());
+
+    struct {
+        const char *name;
+        size_t chunk_size;
+    } const kChunks[] = {
+        {"stream 10ms", sample_rate / 100},
+        {"stream 20ms", sample_rate / 50},
+        {"stream 2.5ms", sample_rate / 400},
+        {"stream 512", 512},
+        {"stream varying", 0},
+    };
+    bool exact = true;
+    for (const auto &chunk : kChunks) {
+        BenchResult result;
+        exact = RunStream(af, chunk.chunk_size, repeats, reference,
+                          &result) && exact;
+        NoiseSuppressionStream stream(BenchConfig(), sample_rate,
+                                      af.getNumChannels(), chunk.chunk_size);
+        // For varying chunks the blocking delay is that of the longest one.
+        const size_t max_chunk = chunk.chunk_size > 0
+                                     ? chunk.chunk_size
+                                     : 2 * stream.block_size_frames();
+        const double chunk_ms =
+            chunk.chunk_size > 0 ? chunk.chunk_size * ms_per_frame
+                                 : 1000.0 * af.getNumSamplesPerChannel() /
+                                       sample_rate / result.num_frames *
+                                       repeats;
+        PrintRow(chunk.name, chunk_ms, result,
+                 (max_chunk + stream.latency_frames()) * ms_per_frame +
+                     overlap_ms);
+    }
+    printf("bit-exact: %s\n", exact ? "yes" : "no");
+    return exact ? 0 : 1;
+}
+
+// Runs the file through a NoiseSuppressionStream in chunks of its block size,
+// 10 ms or NsChunkSizeMs() at rates such as 11.025 kHz, with each processing
+// rate: the split-band suppressor, at 16 kHz for files at rates other than 32
+// and 48 kHz, and the full-band suppressor at 48 kHz.
+int BenchRates(const AudioFileFlt &af, int repeats)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t chunk_ms = NsChunkSizeMs(sample_rate);
+    const size_t block_size = sample_rate * chunk_ms / 1000;
+    const size_t total_frames =
+        af.getNumSamplesPerChannel() / block_size * block_size;
+
+    std::vector<float> input(total_frames * num_channels);
+    for (size_t n = 0; n < total_frames; ++n) {
+        for (size_t c = 0; c < num_channels; ++c) {
+            input[n * num_channels + c] = af.samples[c][n];
+        }
+    }
+    std::vector<float> output(input.size());
+
+    struct {
+        const char *name;
+        NsConfig::ProcessingRate rate;
+    } const kRates[] = {
+        {"split band", NsConfig::ProcessingRate::k16kHz},
+        {"full band", NsConfig::ProcessingRate::k48kHz},
+    };
+    PrintHeader();
+    for (const auto &rate : kRates) {
+        NsConfig cfg = BenchConfig();
+        cfg.processing_rate = rate.rate;
+        BenchResult result;
+        double delay_ms = 0.0;
+        size_t processing_rate = 0;
+        for (int r = 0; r < repeats; ++r) {
+            NoiseSuppressionStream stream(cfg, sample_rate, num_channels,
+                                          block_size);
+            const double start = NowSeconds();
+            for (size_t n = 0; n < total_frames; n += block_size) {
+                stream.Process(
+                    rtc::ArrayView<const float>(&input[n * num_channels],
+                                                block_size * num_channels),
+                    rtc::ArrayView<float>(&output[n * num_channels],
+                                          block_size * num_channels));
+            }
+            result.seconds += NowSeconds() - start;
+            result.num_frames += total_frames / block_size;
+            delay_ms = chunk_ms +
+                       stream.latency_frames() * 1000.0 / sample_rate +
+                       1000.0 * stream.resampling_delay_seconds() +
+                       1000.0 * stream.suppressor().filterbank_delay_seconds();
+            processing_rate = stream.processing_rate_hz();
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "%s (%zu)", rate.name, processing_rate);
+        PrintRow(name, chunk_ms, result, delay_ms);
+    }
+    return 0;
+}
+
+// Compares the suppressor with and without the bypass of silent and
+// noise-free frames, on the file and on a copy of it in which two out of
+// every three seconds are attenuated by 80 dB.
+int BenchBypass(const AudioFileFlt &af, int repeats)
+{
+    AudioFileFlt gated = af;
+    const size_t sample_rate = af.getSampleRate();
+    for (auto &channel : gated.samples) {
+        for (size_t n = 0; n < channel.size(); ++n) {
+            if (n / sample_rate % 3 != 0) {
+                channel[n] *= 1e-4f;
+            }
+        }
+    }
+
+    struct {
+        const char *name;
+        const AudioFileFlt *file;
+    } const kFiles[] = {{"file", &af}, {"gated", &gated}};
+    const double delay_ms = AlgorithmicDelayMs<NoiseSuppressor>();
+
+    PrintHeader();
+    for (const auto &file : kFiles) {
+        for (bool enabled : {false, true}) {
+            NsConfig cfg = BenchConfig();
+            cfg.bypass.enabled = enabled;
+            NoiseSuppressor ns(cfg, sample_rate, af.getNumChannels());
+            const BenchResult result =
+                RunSuppressor(&ns, *file.file, 10, repeats);
+            char name[64];
+            snprintf(name, sizeof(name), "%s %s (%.0f%%)", file.name,
+                     enabled ? "bypass" : "no bypass",
+                     100.f * ns.bypassed_fraction());
+            PrintRow(name, 10, result, delay_ms);
+        }
+    }
+    return 0;
+}
+
+// Compares serial processing of 8, 32 and 64 channel arrays with processing on
+// a thread pool, and checks that the outputs are identical. The channels are
+// copies of the file's channels, each shifted by a different offset. The pool
+// has at least 3 workers so that a ThreadSanitizer build (make tsan) sees the
+// channel tasks overlap even on a single core.
+int BenchThreads(const AudioFileFlt &af, int repeats)
+{
+    const size_t num_workers =
+        std::max(4u, std::thread::hardware_concurrency()) - 1;
+    NsThreadPool pool(num_workers);
+    const double delay_ms = AlgorithmicDelayMs<NoiseSuppressor>();
+    bool exact = true;
+
+    PrintHeader();
+    for (size_t num_channels : {8, 32, 64}) {
+        AudioFileFlt array = af;
+        const size_t length = af.getNumSamplesPerChannel();
+        array.samples.assign(num_channels, std::vector<float>(length));
+        for (size_t c = 0; c < num_channels; ++c) {
+            const std::vector<float> &source =
+                af.samples[c % af.getNumChannels()];
+            for (size_t n = 0; n < length; ++n) {
+                array.samples[c][n] = source[(n + 997 * c) % length];
+            }
+        }
+
+        NoiseSuppressor serial(BenchConfig(), af.getSampleRate(),
+                               num_channels);
+        NoiseSuppressor parallel(BenchConfig(), af.getSampleRate(),
+                                 num_channels);
+        parallel.SetThreadPool(&pool);
+
+        std::vector<float> serial_out;
+        std::vector<float> parallel_out;
+        char name[64];
+        snprintf(name, sizeof(name), "%zu ch serial", num_channels);
+        PrintRow(name, 10,
+                 RunSuppressor(&serial, array, 10, repeats, &serial_out),
+                 delay_ms);
+        snprintf(name, sizeof(name), "%zu ch %zu+1 threads", num_channels,
+                 num_workers);
+        PrintRow(name, 10,
+                 RunSuppressor(&parallel, array, 10, repeats, &parallel_out),
+                 delay_ms);
+        exact = exact && serial_out == parallel_out;
+    }
+    printf("bit-exact: %s\n", exact ? "yes" : "no");
+    return exact ? 0 : 1;
+}
+
+struct SchedulerLoad {
+    NsScheduler::Stats stats;
+    int64_t frames_pushed = 0;
+};
+
+// Feeds |num_streams| streams with one 10 ms frame each every 10 ms for
+// |seconds|, spreading the streams evenly over the period, and waits for the
+// scheduler to drain.
+SchedulerLoad RunSchedulerLoad(const AudioFileFlt &af, size_t num_streams,
+                               size_t num_workers, int seconds)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t frame_size = sample_rate / 100;
+    const size_t num_file_frames = af.getNumSamplesPerChannel() / frame_size;
+
+    NsScheduler::Config config;
+    config.num_workers = num_workers;
+    NsScheduler scheduler(config);
+    std::atomic<int64_t> frames_done(0);
+    std::vector<NsScheduler::Stream *> streams;
+    for (size_t i = 0; i < num_streams; ++i) {
+        streams.push_back(scheduler.AddStream(
+            BenchConfig(), sample_rate, num_channels,
+            [&frames_done](const float *const *, size_t) {
+                frames_done.fetch_add(1, std::memory_order_relaxed);
+            }));
+    }
+
+    std::vector<const float *> channels(num_channels);
+    SchedulerLoad load;
+    const auto period = std::chrono::microseconds(10000);
+    const auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < 100 * seconds; ++k) {
+        for (size_t i = 0; i < num_streams; ++i) {
+            std::this_thread::sleep_until(start + k * period +
+                                          period * i / num_streams);
+            const size_t frame = (k + i) % num_file_frames;
+            for (size_t c = 0; c < num_channels; ++c) {
+                channels[c] = &af.samples[c][frame * frame_size];
+            }
+            scheduler.PushFrame(streams[i], channels.data());
+            ++load.frames_pushed;
+        }
+    }
+
+    while (true) {
+        load.stats = scheduler.GetStats();
+        if (load.stats.frames_processed + load.stats.frames_dropped ==
+            load.frames_pushed) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return load;
+}
+
+// Finds the largest number of streams that the scheduler runs without
+// deadline misses or dropped frames, by doubling the stream count and then
+// bisecting. Each load level runs for |repeats| seconds of audio.
+int BenchScheduler(const AudioFileFlt &af, int repeats)
+{
+    const size_t num_workers = std::max(1u, std::thread::hardware_concurrency());
+    printf("%zu workers, %d s per load level\n", num_workers, repeats);
+    printf("%8s %10s %8s %8s %10s %s\n", "streams", "frames", "misses",
+           "dropped", "max_depth", "utilization");
+
+    auto run = [&](size_t num_streams) {
+        const SchedulerLoad load =
+            RunSchedulerLoad(af, num_streams, num_workers, repeats);
+        printf("%8zu %10lld %8lld %8lld %10zu", num_streams,
+               static_cast<long long>(load.stats.frames_processed),
+               static_cast<long long>(load.stats.deadline_misses),
+               static_cast<long long>(load.stats.frames_dropped),
+               load.stats.max_queue_depth);
+        for (float u : load.stats.worker_utilization) {
+            printf(" %.2f", u);
+        }
+        printf("\n");
+        return load.stats.deadline_misses == 0 &&
+               load.stats.frames_dropped == 0;
+    };
+
+    size_t good = 0;
+    size_t bad = 8;
+    while (run(bad)) {
+        good = bad;
+        bad *= 2;
+    }
+    while (bad - good > std::max<size_t>(1, good / 16)) {
+        const size_t mid = (good + bad) / 2;
+        if (run(mid)) {
+            good = mid;
+        } else {
+            bad = mid;
+        }
+    }
+    printf("max streams without deadline misses: %zu\n", good);
+    return 0;
+}
+
+// Frame queue of the VAFrame pattern: frames are copied into vectors and
+// passed through a mutex-guarded queue.
+class LockedFrameQueue {
+public:
+    explicit LockedFrameQueue(size_t capacity) : capacity_(capacity) {}
+
+    bool Write(const VAFrameFlt &frame)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frames_.size() == capacity_) {
+            return false;
+        }
+        frames_.push_back(frame);
+        return true;
+    }
+
+    bool Read(VAFrameFlt *frame)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frames_.empty()) {
+            return false;
+        }
+        *frame = std::move(frames_.front());
+        frames_.pop_front();
+        return true;
+    }
+
+private:
+    const size_t capacity_;
+    std::mutex mutex_;
+    std::deque<VAFrameFlt> frames_;
+};
+
+struct HandoffResult {
+    double frames_per_second = 0.0;
+    double median_latency_us = 0.0;
+    double p99_latency_us = 0.0;
+};
+
+// Passes |num_frames| 10 ms frames of the file from a producer thread to a
+// consumer thread that copies each into an AudioBuffer. The producer pushes
+// a frame every |period_us|, or as fast as it can if zero. Both threads poll.
+template <bool kUseRing>
+HandoffResult RunHandoff(const AudioFileFlt &af, size_t num_frames,
+                         int period_us)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t frame_size = sample_rate / 100;
+    const size_t num_file_frames = af.getNumSamplesPerChannel() / frame_size;
+    constexpr size_t kCapacity = 8;
+
+    NsFrameRing ring(frame_size, num_channels, kCapacity);
+    LockedFrameQueue queue(kCapacity);
+    AudioBuffer ab(sample_rate, num_channels, sample_rate, num_channels,
+                   sample_rate, num_channels);
+    std::vector<double> push_times(num_frames);
+    std::vector<double> latencies(num_frames);
+
+    const double start = NowSeconds();
+    std::thread consumer([&] {
+        VAFrameFlt frame(sample_rate);
+        for (size_t i = 0; i < num_frames; ++i) {
+            if (kUseRing) {
+                const float *const *slot;
+                while (!(slot = ring.BeginRead())) {
+                    std::this_thread::yield();
+                }
+                ab.CopyFrom(slot);
+                ring.EndRead();
+            } else {
+                while (!queue.Read(&frame)) {
+                    std::this_thread::yield();
+                }
+                ab.CopyFrom(&frame);
+            }
+            latencies[i] = NowSeconds() - push_times[i];
+        }
+    });
+
+    VAFrameFlt frame(sample_rate);
+    frame.buf.assign(num_channels, std::vector<float>(frame_size));
+    std::vector<const float *> channels(num_channels);
+    for (size_t i = 0; i < num_frames; ++i) {
+        if (period_us > 0) {
+            while (NowSeconds() < start + i * period_us * 1e-6) {
+                std::this_thread::yield();
+            }
+        }
+        const size_t offset = (i % num_file_frames) * frame_size;
+        if (kUseRing) {
+            for (size_t c = 0; c < num_channels; ++c) {
+                channels[c] = &af.samples[c][offset];
+            }
+            push_times[i] = NowSeconds();
+            while (!ring.Write(channels.data())) {
+                std::this_thread::yield();
+            }
+        } else {
+            // The VAFrame pattern copies the capture into the frame first.
+            for (size_t c = 0; c < num_channels; ++c) {
+                memcpy(frame.buf[c].data(), &af.samples[c][offset],
+                       frame_size * sizeof(float));
+            }
+            push_times[i] = NowSeconds();
+            while (!queue.Write(frame)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    consumer.join();
+
+    HandoffResult result;
+    result.frames_per_second = num_frames / (NowSeconds() - start);
+    std::sort(latencies.begin(), latencies.end());
+    result.median_latency_us = 1e6 * latencies[num_frames / 2];
+    result.p99_latency_us = 1e6 * latencies[num_frames * 99 / 100];
+    return result;
+}
+
+// Compares handing frames to a consumer thread through an NsFrameRing with
+// a mutex-guarded queue of VAFrame copies: throughput with an unpaced
+// producer and handoff latency with one frame every 500 us.
+int BenchRing(const AudioFileFlt &af, int repeats)
+{
+    const size_t num_frames = 10000 * repeats;
+    printf("%-16s %14s %14s %14s\n", "queue", "frames/s", "median_us",
+           "p99_us");
+    auto print = [](const char *name, const HandoffResult &throughput,
+                    const HandoffResult &paced) {
+        printf("%-16s %14.0f %14.2f %14.2f\n", name,
+               throughput.frames_per_second, paced.median_latency_us,
+               paced.p99_latency_us);
+    };
+    print("mutex+VAFrame", RunHandoff<false>(af, num_frames, 0),
+          RunHandoff<false>(af, 2000, 500));
+    print("NsFrameRing", RunHandoff<true>(af, num_frames, 0),
+          RunHandoff<true>(af, 2000, 500));
+    return 0;
+}
+
+// Runs |process| for frames 0 to |num_frames| - 1 with allocation and lock
+// counting on, and prints the calls it made.
+template <typename ProcessFrame>
+bool CheckRtSafety(const char *name, size_t num_frames,
+                   const ProcessFrame &process)
+{
+    RtViolations violations;
+    {
+        RtGuard guard;
+        for (size_t i = 0; i < num_frames; ++i) {
+            process(i);
+        }
+        violations = guard.violations();
+    }
+    printf("%-24s %10zu %12zu %10zu %10zu %6s\n", name, num_frames,
+           violations.allocations, violations.frees, violations.locks,
+           violations.any() ? "FAIL" : "PASS");
+    return !violations.any();
+}
+
+// Checks that the AudioBuffer copies, the band split and the suppressor do
+// not allocate or lock after construction, with the file's frames passed as
+// a VAFrame or as channel pointers and processed at |buffer_rate|.
+bool CheckSuppressorRtSafety(const char *name, const AudioFileFlt &af,
+                             const NsConfig &cfg, size_t buffer_rate,
+                             bool use_vaframe)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t samples = sample_rate / 100;
+    const size_t total_frames = af.getNumSamplesPerChannel() / samples;
+
+    AudioBuffer ab(sample_rate, num_channels, buffer_rate, num_channels,
+                   sample_rate, num_channels);
+    NoiseSuppressor ns(cfg, buffer_rate, num_channels);
+    VAFrameFlt frame(sample_rate);
+    frame.buf.assign(num_channels, std::vector<float>(samples));
+    std::vector<const float *> input(num_channels);
+    std::vector<float *> output(num_channels);
+    for (size_t c = 0; c < num_channels; ++c) {
+        output[c] = frame.buf[c].data();
+    }
+
+    return CheckRtSafety(name, total_frames, [&](size_t i) {
+        if (use_vaframe) {
+            for (size_t c = 0; c < num_channels; ++c) {
+                memcpy(frame.buf[c].data(), &af.samples[c][samples * i],
+                       samples * sizeof(float));
+            }
+            ab.CopyFrom(&frame);
+        } else {
+            for (size_t c = 0; c < num_channels; ++c) {
+                input[c] = &af.samples[c][samples * i];
+            }
+            ab.CopyFrom(input.data());
+        }
+        if (ab.num_bands() > 1) {
+            ab.SplitIntoFrequencyBands();
+        }
+        ns.Analyze(ab);
+        ns.Process(&ab);
+        if (ab.num_bands() > 1) {
+            ab.MergeFrequencyBands();
+        }
+        if (use_vaframe) {
+            ab.CopyTo(&frame);
+        } else {
+            ab.CopyTo(output.data());
+        }
+    });
+}
+
+// Checks that NoiseSuppressionStream::Process() does not allocate or lock
+// after construction, with chunks of |chunk_size| frames.
+bool CheckStreamRtSafety(const char *name, const AudioFileFlt &af,
+                         size_t chunk_size)
+{
+    const size_t num_channels = af.getNumChannels();
+    const size_t total_chunks = af.getNumSamplesPerChannel() / chunk_size;
+
+    std::vector<float> input(total_chunks * chunk_size * num_channels);
+    for (size_t n = 0; n < total_chunks * chunk_size; ++n) {
+        for (size_t c = 0; c < num_channels; ++c) {
+            input[n * num_channels + c] = af.samples[c][n];
+        }
+    }
+    std::vector<float> output(input.size());
+    NoiseSuppressionStream stream(BenchConfig(), af.getSampleRate(),
+                                  num_channels, chunk_size);
+
+    const size_t chunk_length = chunk_size * num_channels;
+    return CheckRtSafety(name, total_chunks, [&](size_t i) {
+        stream.Process(
+            rtc::ArrayView<const float>(&input[i * chunk_length],
+                                        chunk_length),
+            rtc::ArrayView<float>(&output[i * chunk_length], chunk_length));
+    });
+}
+
+// Checks that the per-frame processing paths make no allocation and take no
+// lock once constructed. Returns 1 if any of them does.
+int BenchRtCheck(const AudioFileFlt &af, int repeats)
+{
+    const size_t sample_rate = af.getSampleRate();
+    // Resample 16 kHz files up and the others down to 16 kHz.
+    const size_t resampled_rate = sample_rate == 16000 ? 32000 : 16000;
+
+    // Two out of every three seconds are attenuated by 80 dB, so that the
+    // bypass is taken.
+    AudioFileFlt gated = af;
+    for (auto &channel : gated.samples) {
+        for (size_t n = 0; n < channel.size(); ++n) {
+            if (n / sample_rate % 3 != 0) {
+                channel[n] *= 1e-4f;
+            }
+        }
+    }
+    NsConfig bypass_cfg = BenchConfig();
+    bypass_cfg.bypass.enabled = true;
+
+    printf("%-24s %10s %12s %10s %10s %6s\n", "case", "calls",
+           "allocations", "frees", "locks", "");
+    bool safe = true;
+    safe &= CheckSuppressorRtSafety("VAFrame", af, BenchConfig(),
+                                    sample_rate, true);
+    safe &= CheckSuppressorRtSafety("channel pointers", af, BenchConfig(),
+                                    sample_rate, false);
+    safe &= CheckSuppressorRtSafety("VAFrame resampled", af, BenchConfig(),
+                                    resampled_rate, true);
+    safe &= CheckSuppressorRtSafety("pointers resampled", af, BenchConfig(),
+                                    resampled_rate, false);
+    safe &= CheckSuppressorRtSafety("bypass", gated, bypass_cfg, sample_rate,
+                                    true);
+    safe &= CheckStreamRtSafety("stream 10 ms", af, sample_rate / 100);
+    safe &= CheckStreamRtSafety("stream 5 ms", af, sample_rate / 200);
+    safe &= CheckStreamRtSafety("stream 7 frames", af, 7);
+    printf("real-time safe: %s\n", safe ? "yes" : "no");
+    return safe ? 0 : 1;
+}
+
+// Runs the legacy float suppressor through the same frame loop as the new
+// one.
+class LegacySuppressor {
+public:
+    LegacySuppressor(size_t num_channels, int sample_rate_hz,
+                     NoiseSuppression::Level level)
+        : ns_(num_channels, sample_rate_hz, level)
+    {
+    }
+
+    void Analyze(AudioBuffer &audio) { ns_.AnalyzeCaptureAudio(&audio); }
+    void Process(AudioBuffer *audio) { ns_.ProcessCaptureAudio(audio); }
+
+private:
+    NoiseSuppression ns_;
+};
+
+// Compares the generic C and the SSE2 per-frequency functions of the legacy
+// float suppressor at every suppression level. The SSE2 functions use
+// approximate logarithms and exponentials, so the outputs are checked to
+// differ by less than -80 dB relative to the output of the C functions.
+int BenchLegacySimd(const AudioFileFlt &af, int repeats)
+{
+    constexpr double kMaxErrorDb = -80.0;
+    struct {
+        const char *name;
+        NoiseSuppression::Level level;
+    } const kLevels[] = {
+        {"low", NoiseSuppression::Level::kLow},
+        {"moderate", NoiseSuppression::Level::kModerate},
+        {"high", NoiseSuppression::Level::kHigh},
+        {"very high", NoiseSuppression::Level::kVeryHigh},
+    };
+
+    printf("%-12s %12s %12s %10s %14s %10s\n", "level", "C us/frame",
+           "SIMD us/frame", "speedup", "max_abs_diff", "error_dB");
+    bool within_tolerance = true;
+    for (const auto &level : kLevels) {
+        BenchResult results[2];
+        std::vector<float> outputs[2];
+        for (int simd = 0; simd < 2; ++simd) {
+            // The functions are selected when a suppressor is initialized.
+            WebRtcNs_EnableSimd(simd);
+            LegacySuppressor ns(af.getNumChannels(), af.getSampleRate(),
+                                level.level);
+            results[simd] =
+                RunSuppressor(&ns, af, 10, repeats, &outputs[simd]);
+        }
+        WebRtcNs_EnableSimd(1);
+
+        double max_abs_diff = 0.0;
+        double error_energy = 0.0;
+        double energy = 0.0;
+        for (size_t n = 0; n < outputs[0].size(); ++n) {
+            const double diff = outputs[1][n] - outputs[0][n];
+            max_abs_diff = std::max(max_abs_diff, fabs(diff));
+            error_energy += diff * diff;
+            energy += outputs[0][n] * outputs[0][n];
+        }
+        const double error_db = error_energy > 0.0
+                                    ? 10.0 * log10(error_energy / energy)
+                                    : -INFINITY;
+        within_tolerance = within_tolerance && error_db < kMaxErrorDb;
+
+        const double us[2] = {1e6 * results[0].seconds / results[0].num_frames,
+                              1e6 * results[1].seconds / results[1].num_frames};
+        printf("%-12s %12.2f %12.2f %10.2f %14.3g %10.1f\n", level.name,
+               us[0], us[1], us[0] / us[1], max_abs_diff, error_db);
+    }
+    printf("within %.0f dB: %s\n", kMaxErrorDb,
+           within_tolerance ? "yes" : "no");
+    return within_tolerance ? 0 : 1;
+}
+
+// Runs the new and the legacy suppressor on the file followed by a minute of
+// silence made of zeros, of tiny normal values and of subnormal values, and
+// compares the per-frame cost in the silence with that in the file. Without
+// protection the decaying states and the inputs turn subnormal in the
+// silence, which costs many times the normal frame time on x86.
+int BenchSilence(const AudioFileFlt &af)
+{
+    constexpr size_t kSilenceSeconds = 60;
+    const size_t sample_rate = af.getSampleRate();
+    const size_t file_frames =
+        af.getNumSamplesPerChannel() / (sample_rate / 100);
+
+    struct {
+        const char *name;
+        float amplitude;
+    } const kSilences[] = {{"zeros", 0.f}, {"tiny", 1e-37f},
+                           {"subnormal", 1e-40f}};
+
+    printf("%-10s %-10s %10s %12s %14s %14s %8s\n", "engine", "silence",
+           "file_us", "silence_us", "worst_second", "worst_frame", "ratio");
+    double worst_ratio = 0.0;
+    for (const auto &silence : kSilences) {
+        AudioFileFlt extended = af;
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> noise(-silence.amplitude,
+                                                    silence.amplitude);
+        for (auto &channel : extended.samples) {
+            channel.resize(file_frames * sample_rate / 100);
+            for (size_t n = 0; n < kSilenceSeconds * sample_rate; ++n) {
+                channel.push_back(noise(rng));
+            }
+        }
+
+        for (bool legacy : {false, true}) {
+            std::vector<double> frame_seconds;
+            if (legacy) {
+                LegacySuppressor ns(af.getNumChannels(), sample_rate,
+                                    NoiseSuppression::Level::kModerate);
+                RunSuppressor(&ns, extended, 10, 1, nullptr, &frame_seconds);
+            } else {
+                NoiseSuppressor ns(BenchConfig(), sample_rate,
+                                   af.getNumChannels());
+                RunSuppressor(&ns, extended, 10, 1, nullptr, &frame_seconds);
+            }
+
+            // Frame times are noisy; compare medians of one second windows.
+            auto median = [](std::vector<double> v) {
+                std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+                return v[v.size() / 2];
+            };
+            const double file_us =
+                1e6 * median(std::vector<double>(
+                          frame_seconds.begin(),
+                          frame_seconds.begin() + file_frames));
+            const std::vector<double> silent(
+                frame_seconds.begin() + file_frames, frame_seconds.end());
+            double worst_second_us = 0.0;
+            for (size_t start = 0; start + 100 <= silent.size();
+                 start += 100) {
+                worst_second_us = std::max(
+                    worst_second_us,
+                    1e6 * median(std::vector<double>(
+                              silent.begin() + start,
+                              silent.begin() + start + 100)));
+            }
+            const double worst_frame_us =
+                1e6 * *std::max_element(silent.begin(), silent.end());
+            const double ratio = worst_second_us / file_us;
+            worst_ratio = std::max(worst_ratio, ratio);
+            printf("%-10s %-10s %10.2f %12.2f %14.2f %14.2f %8.2f\n",
+                   legacy ? "legacy" : "new", silence.name, file_us,
+                   1e6 * median(silent), worst_second_us, worst_frame_us,
+                   ratio);
+        }
+    }
+    printf("worst second of silence vs file: %.2fx\n", worst_ratio);
+    return 0;
+}
+
+// Compares the time-domain suppressor with the spectral-domain entry points
+// driven by a filterbank in the bench, as a host that shares its STFT with
+// other processing would run them. Both run on the file resampled to 16 kHz.
+// The suppressor time excludes the host filterbank, which is timed
+// separately. The outputs are checked to differ by less than -80 dB.
+int BenchSpectrum(const AudioFileFlt &af, int repeats)
+{
+    using Fft = NrFft<Ns10msLayout>;
+    constexpr size_t kFrameSize = NoiseSuppressor::kNsFrameSize;
+    constexpr size_t kFftSize = NoiseSuppressor::kFftSize;
+    constexpr size_t kOverlapSize = kFftSize - kFrameSize;
+    constexpr size_t kBins = NoiseSuppressor::kFftSizeBy2Plus1;
+    constexpr size_t kRate = 16000;
+    constexpr double kMaxErrorDb = -80.0;
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t samples = sample_rate / 100;
+    const size_t total_frames = af.getNumSamplesPerChannel() / samples;
+    const std::array<float, kFftSize> window =
+        NoiseSuppressor::FilterBankWindow();
+
+    VAFrameFlt frame(sample_rate);
+    frame.buf.assign(num_channels, std::vector<float>(samples));
+    auto load_frame = [&](size_t i) {
+        for (size_t c = 0; c < num_channels; ++c) {
+            memcpy(frame.buf[c].data(), &af.samples[c][samples * i],
+                   samples * sizeof(float));
+        }
+    };
+    auto store_frame = [&](std::vector<float> *output) {
+        for (size_t c = 0; c < num_channels; ++c) {
+            output->insert(output->end(), frame.buf[c].begin(),
+                           frame.buf[c].end());
+        }
+    };
+
+    BenchResult time_result;
+    BenchResult spectrum_result;
+    double filterbank_seconds = 0.0;
+    std::vector<float> time_out;
+    std::vector<float> spectrum_out;
+    for (int r = 0; r < repeats; ++r) {
+        AudioBuffer ab(sample_rate, num_channels, kRate, num_channels,
+                       sample_rate, num_channels);
+        NoiseSuppressor ns(BenchConfig(), kRate, num_channels);
+        for (size_t i = 0; i < total_frames; ++i) {
+            load_frame(i);
+            ab.CopyFrom(&frame);
+            const double start = NowSeconds();
+            const uint64_t start_cycles = ReadCycles();
+            ns.Analyze(ab);
+            ns.Process(&ab);
+            time_result.cycles += ReadCycles() - start_cycles;
+            time_result.seconds += NowSeconds() - start;
+            ab.CopyTo(&frame);
+            if (r == 0) {
+                store_frame(&time_out);
+            }
+        }
+        time_result.num_frames += total_frames;
+    }
+
+    for (int r = 0; r < repeats; ++r) {
+        AudioBuffer ab(sample_rate, num_channels, kRate, num_channels,
+                       sample_rate, num_channels);
+        NoiseSuppressor ns(BenchConfig(), kRate, num_channels);
+        Fft fft;
+        std::vector<std::array<float, kOverlapSize>> analysis_memory(
+            num_channels);
+        std::vector<std::array<float, kOverlapSize>> synthesis_memory(
+            num_channels);
+        std::vector<std::array<float, kFftSize>> real(num_channels);
+        std::vector<std::array<float, kFftSize>> imag(num_channels);
+        std::vector<float *> real_ptrs(num_channels);
+        std::vector<float *> imag_ptrs(num_channels);
+        for (size_t c = 0; c < num_channels; ++c) {
+            analysis_memory[c].fill(0.f);
+            synthesis_memory[c].fill(0.f);
+            real_ptrs[c] = real[c].data();
+            imag_ptrs[c] = imag[c].data();
+        }
+        std::array<float, kFftSize> extended_frame;
+        std::array<float, kBins> gains;
+
+        for (size_t i = 0; i < total_frames; ++i) {
+            load_frame(i);
+            ab.CopyFrom(&frame);
+
+            double start = NowSeconds();
+            for (size_t c = 0; c < num_channels; ++c) {
+                const float *x = ab.channels_const()[c];
+                std::copy(analysis_memory[c].begin(), analysis_memory[c].end(),
+                          extended_frame.begin());
+                std::copy(x, x + kFrameSize,
+                          extended_frame.begin() + kOverlapSize);
+                std::copy(extended_frame.end() - kOverlapSize,
+                          extended_frame.end(), analysis_memory[c].begin());
+                for (size_t k = 0; k < kFftSize; ++k) {
+                    extended_frame[k] *= window[k];
+                }
+                fft.Fft(extended_frame, real[c], imag[c]);
+            }
+            filterbank_seconds += NowSeconds() - start;
+
+            start = NowSeconds();
+            const uint64_t start_cycles = ReadCycles();
+            ns.AnalyzeSpectrum(
+                rtc::ArrayView<const float *const>(real_ptrs.data(),
+                                                   num_channels),
+                rtc::ArrayView<const float *const>(imag_ptrs.data(),
+                                                   num_channels));
+            ns.ProcessSpectrum(real_ptrs, imag_ptrs, gains);
+            spectrum_result.cycles += ReadCycles() - start_cycles;
+            spectrum_result.seconds += NowSeconds() - start;
+
+            start = NowSeconds();
+            for (size_t c = 0; c < num_channels; ++c) {
+                float *y = ab.channels()[c];
+                fft.Ifft(real[c], imag[c], extended_frame);
+                for (size_t k = 0; k < kFftSize; ++k) {
+                    extended_frame[k] *= window[k];
+                }
+                for (size_t k = 0; k < kFrameSize; ++k) {
+                    const float v =
+                        extended_frame[k] +
+                        (k < kOverlapSize ? synthesis_memory[c][k] : 0.f);
+                    y[k] = std::min(std::max(v, -32768.f), 32767.f);
+                }
+                std::copy(extended_frame.begin() + kFrameSize,
+                          extended_frame.end(), synthesis_memory[c].begin());
+            }
+            filterbank_seconds += NowSeconds() - start;
+
+            ab.CopyTo(&frame);
+            if (r == 0) {
+                store_frame(&spectrum_out);
+            }
+        }
+        spectrum_result.num_frames += total_frames;
+    }
+
+    double max_abs_diff = 0.0;
+    double error_energy = 0.0;
+    double energy = 0.0;
+    for (size_t n = 0; n < time_out.size(); ++n) {
+        const double diff = spectrum_out[n] - time_out[n];
+        max_abs_diff = std::max(max_abs_diff, fabs(diff));
+        error_energy += diff * diff;
+        energy += time_out[n] * time_out[n];
+    }
+    const double error_db = error_energy > 0.0
+                                ? 10.0 * log10(error_energy / energy)
+                                : -INFINITY;
+    const bool within_tolerance = error_db < kMaxErrorDb;
+
+    const double delay_ms = AlgorithmicDelayMs<NoiseSuppressor>();
+    PrintHeader();
+    PrintRow("time domain", 10, time_result, delay_ms);
+    PrintRow("spectral domain", 10, spectrum_result, delay_ms);
+    printf("host filterbank: %.2f us/frame\n",
+           1e6 * filterbank_seconds / spectrum_result.num_frames);
+    printf("max_abs_diff %.3g, error %.1f dB, within %.0f dB: %s\n",
+           max_abs_diff, error_db, kMaxErrorDb,
+           within_tolerance ? "yes" : "no");
+    return within_tolerance ? 0 : 1;
+}
+
+// Result of running one engine over one file, passed from the child process
+// that runs it.
+struct EngineResult {
+    BenchResult bench;
+    size_t state_bytes = 0;
+    double seg_snr_db = 0.0;
+    double attenuation_db = 0.0;
+    double noise_attenuation_db = 0.0;
+    long peak_rss_kb = 0;
+    bool ok = false;
+};
+
+// Returns the delay of |output| relative to |input|, in samples up to 20 ms,
+// as the lag of largest cross-correlation over one second of the file.
+size_t EstimateDelay(const std::vector<float> &input,
+                     const std::vector<float> &output, size_t sample_rate)
+{
+    const size_t max_lag = sample_rate / 50;
+    const size_t length = std::min(input.size(), output.size());
+    if (length <= max_lag) {
+        return 0;
+    }
+    const size_t start = length / 2 > sample_rate ? length / 2 - sample_rate
+                                                  : 0;
+    const size_t end = std::min(start + sample_rate, length - max_lag);
+    size_t best_lag = 0;
+    double best = -1.0;
+    for (size_t lag = 0; lag < max_lag; ++lag) {
+        double correlation = 0.0;
+        for (size_t n = start; n < end; ++n) {
+            correlation += input[n] * output[n + lag];
+        }
+        if (correlation > best) {
+            best = correlation;
+            best_lag = lag;
+        }
+    }
+    return best_lag;
+}
+
+// Computes the objective deltas of |output| against |input|, both
+// deinterleaved, after compensating the delay of the output. The segmental SNR
+// averages 10*log10(input energy / difference energy) over 10 ms segments with
+// signal, limited to [-10, 35] dB. The noise attenuation is measured on the
+// 20% of those segments with the lowest input energy.
+void ComputeObjectiveDeltas(const std::vector<std::vector<float>> &input,
+                            const std::vector<std::vector<float>> &output,
+                            size_t sample_rate, EngineResult *result)
+{
+    const size_t delay = EstimateDelay(input[0], output[0], sample_rate);
+    const size_t segment = sample_rate / 100;
+    const size_t num_segments = (output[0].size() - delay) / segment;
+
+    struct Energies {
+        double input = 0.0;
+        double output = 0.0;
+    };
+    std::vector<Energies> segments;
+    double seg_snr_sum = 0.0;
+    Energies total;
+    for (size_t k = 0; k < num_segments; ++k) {
+        Energies e;
+        double difference = 0.0;
+        for (size_t c = 0; c < input.size(); ++c) {
+            for (size_t n = k * segment; n < (k + 1) * segment; ++n) {
+                const double x = input[c][n];
+                const double y = output[c][n + delay];
+                e.input += x * x;
+                e.output += y * y;
+                difference += (x - y) * (x - y);
+            }
+        }
+        if (e.input == 0.0) {
+            continue;
+        }
+        const double snr =
+            difference > 0.0 ? 10.0 * log10(e.input / difference) : 35.0;
+        seg_snr_sum += std::min(35.0, std::max(-10.0, snr));
+        total.input += e.input;
+        total.output += e.output;
+        segments.push_back(e);
+    }
+    if (segments.empty()) {
+        return;
+    }
+
+    auto attenuation_db = [](const Energies &e) {
+        return 10.0 * log10(e.input / std::max(e.output, 1e-20));
+    };
+    std::sort(segments.begin(), segments.end(),
+              [](const Energies &a, const Energies &b) {
+                  return a.input < b.input;
+              });
+    Energies noise;
+    for (size_t k = 0; k < std::max<size_t>(1, segments.size() / 5); ++k) {
+        noise.input += segments[k].input;
+        noise.output += segments[k].output;
+    }
+    result->seg_snr_db = seg_snr_sum / segments.size();
+    result->attenuation_db = attenuation_db(total);
+    result->noise_attenuation_db = attenuation_db(noise);
+}
+
+// Returns the log kurtosis ratio of the power spectra of |output| and of
+// |input|, delayed by |delay|, over the quietest fifth of the 1024 sample
+// segments, a measure of musical noise: the isolated spectral peaks that the
+// suppression leaves in the noise raise the kurtosis, and 0 means that the
+// residual noise kept the spectral statistics of the input noise. The power
+// of each bin is normalized by its mean over the segments.
+double LogKurtosisRatio(const std::vector<std::vector<float>> &input,
+                        const std::vector<std::vector<float>> &output,
+                        size_t delay)
+{
+    constexpr size_t kSize = 1024;
+    constexpr size_t kBins = kSize / 2 + 1;
+    const size_t length = std::min(input[0].size(), output[0].size() - delay);
+    const size_t num_segments = length / kSize;
+
+    std::vector<std::pair<double, size_t>> energies(num_segments);
+    for (size_t k = 0; k < num_segments; ++k) {
+        double energy = 0.0;
+        for (const auto &channel : input) {
+            for (size_t n = k * kSize; n < (k + 1) * kSize; ++n) {
+                energy += channel[n] * channel[n];
+            }
+        }
+        energies[k] = {energy, k};
+    }
+    std::sort(energies.begin(), energies.end());
+    energies.resize(std::max<size_t>(1, num_segments / 5));
+
+    std::array<float, kSize> window;
+    for (size_t n = 0; n < kSize; ++n) {
+        window[n] = 0.5f - 0.5f * cosf(2.f * M_PI * n / kSize);
+    }
+    std::vector<size_t> ip(kSize / 2);
+    std::vector<float> w(kSize / 2);
+    auto kurtosis = [&](const std::vector<std::vector<float>> &x,
+                        size_t offset) {
+        std::vector<double> sum(kBins, 0.0);
+        std::vector<double> sum_squares(kBins, 0.0);
+        size_t count = 0;
+        std::array<float, kSize> frame;
+        for (const auto &segment : energies) {
+            for (const auto &channel : x) {
+                const float *begin = &channel[segment.second * kSize + offset];
+                for (size_t n = 0; n < kSize; ++n) {
+                    frame[n] = window[n] * begin[n];
+                }
+                WebRtc_rdft(kSize, 1, frame.data(), ip.data(), w.data());
+                for (size_t i = 1; i < kBins - 1; ++i) {
+                    const double power = frame[2 * i] * frame[2 * i] +
+                                         frame[2 * i + 1] * frame[2 * i + 1];
+                    sum[i] += power;
+                    sum_squares[i] += power * power;
+                }
+                ++count;
+            }
+        }
+        double kurtosis_sum = 0.0;
+        for (size_t i = 1; i < kBins - 1; ++i) {
+            if (sum[i] > 0.0) {
+                kurtosis_sum += sum_squares[i] * count / (sum[i] * sum[i]);
+            }
+        }
+        return kurtosis_sum / (kBins - 2);
+    };
+    if (num_segments == 0) {
+        return 0.0;
+    }
+    return log(kurtosis(output, delay) / kurtosis(input, 0));
+}
+
+// Runs the engine made by |create| over the file in a child process, so that
+// the peak resident set size is that of the one engine. It includes the file
+// and output buffers, which are the same for every engine.
+template <typename CreateEngine>
+EngineResult RunEngine(const AudioFileFlt &af, int repeats,
+                       const CreateEngine &create)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return EngineResult();
+    }
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        EngineResult result;
+        decltype(create()) engine;
+        {
+            RtGuard guard;
+            engine = create();
+            result.state_bytes = guard.violations().allocated_bytes;
+        }
+
+        std::vector<float> output;
+        result.bench = RunSuppressor(engine.get(), af, 10, repeats, &output);
+
+        // The output is stored frame by frame, one block per channel.
+        const size_t num_channels = af.getNumChannels();
+        const size_t samples = af.getSampleRate() / 100;
+        const size_t length = output.size() / num_channels;
+        std::vector<std::vector<float>> deinterleaved(
+            num_channels, std::vector<float>(length));
+        for (size_t i = 0; i < length / samples; ++i) {
+            for (size_t c = 0; c < num_channels; ++c) {
+                memcpy(&deinterleaved[c][i * samples],
+                       &output[(i * num_channels + c) * samples],
+                       samples * sizeof(float));
+            }
+        }
+        ComputeObjectiveDeltas(af.samples, deinterleaved, af.getSampleRate(),
+                               &result);
+        result.ok = true;
+        const ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    EngineResult result;
+    const bool received =
+        pid > 0 && read(fds[0], &result, sizeof(result)) == sizeof(result);
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    if (pid > 0 && wait4(pid, &status, 0, &usage) == pid) {
+        result.peak_rss_kb = usage.ru_maxrss;
+    }
+    result.ok = received && result.ok && WIFEXITED(status) &&
+                WEXITSTATUS(status) == 0;
+    return result;
+}
+
+// Runs the new suppressor and the legacy float suppressor over every file
+// matching |pattern| at each suppression level, and prints one
+// comma-separated row per run.
+int BenchEngines(const char *pattern, int repeats)
+{
+    struct {
+        const char *name;
+        NsConfig::SuppressionLevel target_level;
+        NoiseSuppression::Level legacy_level;
+    } const kLevels[] = {
+        {"6dB", NsConfig::SuppressionLevel::k6dB,
+         NoiseSuppression::Level::kLow},
+        {"12dB", NsConfig::SuppressionLevel::k12dB,
+         NoiseSuppression::Level::kModerate},
+        {"18dB", NsConfig::SuppressionLevel::k18dB,
+         NoiseSuppression::Level::kHigh},
+        {"21dB", NsConfig::SuppressionLevel::k21dB,
+         NoiseSuppression::Level::kVeryHigh},
+    };
+
+    glob_t files;
+    if (glob(pattern, 0, nullptr, &files) != 0) {
+        printf("No files match %s\n", pattern);
+        return 1;
+    }
+    printf("file,rate,channels,engine,level,cycles_per_frame,us_per_frame,"
+           "xrt,peak_rss_kb,state_bytes,seg_snr_db,attenuation_db,"
+           "noise_attenuation_db\n");
+    bool ok = true;
+    for (size_t f = 0; f < files.gl_pathc; ++f) {
+        AudioFileFlt af;
+        const char *path = files.gl_pathv[f];
+        if (!af.load(path)) {
+            ok = false;
+            continue;
+        }
+        const size_t sample_rate = af.getSampleRate();
+        const size_t num_channels = af.getNumChannels();
+        const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+
+        auto print = [&](const char *engine, const char *level,
+                         const EngineResult &r) {
+            const BenchResult &b = r.bench;
+            printf("\"%s\",%zu,%zu,%s,%s,%.0f,%.2f,%.1f,%ld,%zu,%.2f,%.2f,"
+                   "%.2f\n",
+                   name, sample_rate, num_channels, engine, level,
+                   static_cast<double>(b.cycles) / b.num_frames,
+                   1e6 * b.seconds / b.num_frames,
+                   b.num_frames * 0.01 / b.seconds, r.peak_rss_kb,
+                   r.state_bytes, r.seg_snr_db, r.attenuation_db,
+                   r.noise_attenuation_db);
+            ok = ok && r.ok;
+        };
+        for (const auto &level : kLevels) {
+            print("ns", level.name, RunEngine(af, repeats, [&] {
+                      NsConfig cfg;
+                      cfg.target_level = level.target_level;
+                      return NoiseSuppressor::Create(cfg, sample_rate,
+                                                     num_channels);
+                  }));
+            print("legacy", level.name, RunEngine(af, repeats, [&] {
+                      return std::unique_ptr<LegacySuppressor>(
+                          new LegacySuppressor(num_channels, sample_rate,
+                                               level.legacy_level));
+                  }));
+        }
+    }
+    globfree(&files);
+    return ok ? 0 : 1;
+}
+
+// Splits the whole file into the bands of the 10 ms suppressor, returned as
+// one signal per band laid out as for NoiseSuppressor::ProcessBlock.
+std::vector<std::vector<float>> SplitIntoBands(const AudioFileFlt &af)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t samples = sample_rate / 100;
+    const size_t total_frames = af.getNumSamplesPerChannel() / samples;
+    constexpr size_t kFrameSize = NoiseSuppressor::kNsFrameSize;
+
+    AudioBuffer ab(sample_rate, num_channels, sample_rate, num_channels,
+                   sample_rate, num_channels);
+    const size_t num_bands = ab.num_bands();
+    std::vector<std::vector<float>> bands(
+        num_channels * num_bands,
+        std::vector<float>(total_frames * kFrameSize));
+    VAFrameFlt frame(sample_rate);
+    frame.buf.assign(num_channels, std::vector<float>(samples));
+    for (size_t i = 0; i < total_frames; ++i) {
+        for (size_t c = 0; c < num_channels; ++c) {
+            memcpy(frame.buf[c].data(), &af.samples[c][samples * i],
+                   samples * sizeof(float));
+        }
+        ab.CopyFrom(&frame);
+        if (num_bands > 1) {
+            ab.SplitIntoFrequencyBands();
+        }
+        for (size_t c = 0; c < num_channels; ++c) {
+            for (size_t b = 0; b < num_bands; ++b) {
+                memcpy(&bands[c * num_bands + b][i * kFrameSize],
+                       ab.split_bands_const(c)[b], kFrameSize * sizeof(float));
+            }
+        }
+    }
+    return bands;
+}
+
+// Compares Analyze and Process on each 10 ms frame through an AudioBuffer, as
+// an offline tool calls them, with ProcessBlock on blocks of several sizes.
+// Then does the same for the 16 bit overloads, comparing per-frame Analyze and
+// Process calls with ProcessBlock, and AnalyzeBlock with per-frame Analyze
+// calls by processing the file again after the analysis. The file is split
+// into bands beforehand, and the time excludes that. Checks that the outputs
+// of each format are identical.
+int BenchBlock(const AudioFileFlt &af, int repeats)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t total_frames =
+        af.getNumSamplesPerChannel() / (sample_rate / 100);
+    constexpr size_t kFrameSize = NoiseSuppressor::kNsFrameSize;
+
+    AudioBuffer ab(sample_rate, num_channels, sample_rate, num_channels,
+                   sample_rate, num_channels);
+    const size_t num_bands = ab.num_bands();
+    const size_t num_signals = num_channels * num_bands;
+    const std::vector<std::vector<float>> bands = SplitIntoBands(af);
+
+    // Per-frame calls, copying each frame into and out of the AudioBuffer.
+    std::vector<std::vector<float>> reference = bands;
+    BenchResult frame_result;
+    for (int r = 0; r < repeats; ++r) {
+        NoiseSuppressor ns(BenchConfig(), sample_rate, num_channels);
+        const double start = NowSeconds();
+        for (size_t i = 0; i < total_frames; ++i) {
+            for (size_t c = 0; c < num_channels; ++c) {
+                for (size_t b = 0; b < num_bands; ++b) {
+                    memcpy(ab.split_bands(c)[b],
+                           &bands[c * num_bands + b][i * kFrameSize],
+                           kFrameSize * sizeof(float));
+                }
+            }
+            ns.Analyze(ab);
+            ns.Process(&ab);
+            for (size_t c = 0; c < num_channels; ++c) {
+                for (size_t b = 0; b < num_bands; ++b) {
+                    memcpy(&reference[c * num_bands + b][i * kFrameSize],
+                           ab.split_bands_const(c)[b],
+                           kFrameSize * sizeof(float));
+                }
+            }
+        }
+        frame_result.seconds += NowSeconds() - start;
+        frame_result.num_frames += total_frames;
+    }
+
+    const double delay_ms = AlgorithmicDelayMs<NoiseSuppressor>();
+    PrintHeader();
+    PrintRow("per-frame calls", 10, frame_result, delay_ms);
+    bool exact = true;
+    for (size_t block_frames : {size_t{1}, size_t{10}, size_t{100},
+                                total_frames}) {
+        std::vector<std::vector<float>> output = bands;
+        std::vector<float *> pointers(num_signals);
+        BenchResult result;
+        for (int r = 0; r < repeats; ++r) {
+            output = bands;
+            NoiseSuppressor ns(BenchConfig(), sample_rate, num_channels);
+            const double start = NowSeconds();
+            for (size_t i = 0; i < total_frames; i += block_frames) {
+                for (size_t k = 0; k < num_signals; ++k) {
+                    pointers[k] = &output[k][i * kFrameSize];
+                }
+                ns.ProcessBlock(
+                    rtc::ArrayView<const float *const>(pointers.data(),
+                                                       num_signals),
+                    pointers, std::min(block_frames, total_frames - i));
+            }
+            result.seconds += NowSeconds() - start;
+            result.num_frames += total_frames;
+        }
+        exact = exact && output == reference;
+        char name[64];
+        snprintf(name, sizeof(name), "ProcessBlock(%zu)", block_frames);
+        PrintRow(name, 10, result, delay_ms);
+    }
+
+    // The same with the 16 bit overloads, on the bands rounded to 16 bits.
+    std::vector<std::vector<int16_t>> bands16(
+        num_signals, std::vector<int16_t>(total_frames * kFrameSize));
+    for (size_t k = 0; k < num_signals; ++k) {
+        FloatS16ToS16(bands[k].data(), bands[k].size(), bands16[k].data());
+    }
+    std::vector<const int16_t *> inputs16(num_signals);
+    std::vector<int16_t *> outputs16(num_signals);
+    auto frame_pointers = [&](std::vector<std::vector<int16_t>> *signals,
+                              size_t i) {
+        for (size_t k = 0; k < num_signals; ++k) {
+            outputs16[k] = &(*signals)[k][i * kFrameSize];
+            inputs16[k] = outputs16[k];
+        }
+    };
+
+    std::vector<std::vector<int16_t>> reference16;
+    BenchResult frame16_result;
+    for (int r = 0; r < repeats; ++r) {
+        reference16 = bands16;
+        NoiseSuppressor ns(BenchConfig(), sample_rate, num_channels);
+        const double start = NowSeconds();
+        for (size_t i = 0; i < total_frames; ++i) {
+            frame_pointers(&reference16, i);
+            ns.Analyze(inputs16);
+            ns.Process(inputs16, outputs16);
+        }
+        frame16_result.seconds += NowSeconds() - start;
+        frame16_result.num_frames += total_frames;
+    }
+    PrintRow("int16 per-frame calls", 10, frame16_result, delay_ms);
+
+    for (size_t block_frames : {size_t{1}, size_t{10}, size_t{100},
+                                total_frames}) {
+        std::vector<std::vector<int16_t>> output16;
+        BenchResult result;
+        for (int r = 0; r < repeats; ++r) {
+            output16 = bands16;
+            NoiseSuppressor ns(BenchConfig(), sample_rate, num_channels);
+            const double start = NowSeconds();
+            for (size_t i = 0; i < total_frames; i += block_frames) {
+                frame_pointers(&output16, i);
+                ns.ProcessBlock(inputs16, outputs16,
+                                std::min(block_frames, total_frames - i));
+            }
+            result.seconds += NowSeconds() - start;
+            result.num_frames += total_frames;
+        }
+        exact = exact && output16 == reference16;
+        char name[64];
+        snprintf(name, sizeof(name), "int16 ProcessBlock(%zu)", block_frames);
+        PrintRow(name, 10, result, delay_ms);
+    }
+
+    // AnalyzeBlock must leave the same state as per-frame Analyze calls, which
+    // shows in the output of processing the file again afterwards.
+    BenchResult analyze_result;
+    for (int r = 0; r < repeats; ++r) {
+        std::vector<std::vector<int16_t>> frame_analyzed = bands16;
+        std::vector<std::vector<int16_t>> block_analyzed = bands16;
+        NoiseSuppressor frame_ns(BenchConfig(), sample_rate, num_channels);
+        for (size_t i = 0; i < total_frames; ++i) {
+            frame_pointers(&frame_analyzed, i);
+            frame_ns.Analyze(inputs16);
+        }
+        frame_pointers(&frame_analyzed, 0);
+        frame_ns.ProcessBlock(inputs16, outputs16, total_frames);
+
+        NoiseSuppressor block_ns(BenchConfig(), sample_rate, num_channels);
+        frame_pointers(&block_analyzed, 0);
+        const double start = NowSeconds();
+        block_ns.AnalyzeBlock(inputs16, total_frames);
+        analyze_result.seconds += NowSeconds() - start;
+        analyze_result.num_frames += total_frames;
+        block_ns.ProcessBlock(inputs16, outputs16, total_frames);
+
+        exact = exact && frame_analyzed == block_analyzed;
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "int16 AnalyzeBlock(%zu)", total_frames);
+    PrintRow(name, 10, analyze_result, delay_ms);
+
+    printf("bit-exact: %s\n", exact ? "yes" : "no");
+    return exact ? 0 : 1;
+}
+
+// Compares causal processing with the two-pass offline mode on the file,
+// serially and on thread pools, which take the analysis chunks and, for
+// multichannel files, the channels of the second pass. The objective
+// deltas are measured on the lowest band over the first three seconds, where
+// the causal estimates are still adapting, and over the rest of the file.
+int BenchTwoPass(const AudioFileFlt &af, int repeats)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t total_frames =
+        af.getNumSamplesPerChannel() / (sample_rate / 100);
+    constexpr size_t kFrameSize = NoiseSuppressor::kNsFrameSize;
+    const std::vector<std::vector<float>> bands = SplitIntoBands(af);
+    const size_t num_bands = bands.size() / num_channels;
+
+    auto run = [&](const char *name, NsThreadPool *pool, bool two_pass,
+                   std::vector<std::vector<float>> *output) {
+        std::vector<float *> pointers(bands.size());
+        BenchResult result;
+        for (int r = 0; r < repeats; ++r) {
+            *output = bands;
+            for (size_t k = 0; k < bands.size(); ++k) {
+                pointers[k] = (*output)[k].data();
+            }
+            rtc::ArrayView<const float *const> input(pointers.data(),
+                                                     pointers.size());
+            const double start = NowSeconds();
+            if (two_pass) {
+                SuppressNoiseTwoPass<Ns10msLayout>(
+                    BenchConfig(), sample_rate, num_channels, input,
+                    pointers, total_frames, pool);
+            } else {
+                NoiseSuppressor ns(BenchConfig(), sample_rate, num_channels);
+                ns.ProcessBlock(input, pointers, total_frames);
+            }
+            result.seconds += NowSeconds() - start;
+            result.num_frames += total_frames;
+        }
+        PrintRow(name, 10, result, AlgorithmicDelayMs<NoiseSuppressor>());
+    };
+
+    std::vector<std::vector<std::vector<float>>> outputs(4);
+    const char *names[] = {"causal ProcessBlock", "two-pass serial",
+                           "two-pass 1+1 threads", "two-pass 3+1 threads"};
+    NsThreadPool pool1(1);
+    NsThreadPool pool3(3);
+    PrintHeader();
+    run(names[0], nullptr, false, &outputs[0]);
+    run(names[1], nullptr, true, &outputs[1]);
+    run(names[2], &pool1, true, &outputs[2]);
+    run(names[3], &pool3, true, &outputs[3]);
+
+    // Quality of the lowest band, split at three seconds.
+    const size_t split = std::min<size_t>(300, total_frames / 2) * kFrameSize;
+    auto segment = [&](const std::vector<std::vector<float>> &signals,
+                       size_t begin, size_t end) {
+        std::vector<std::vector<float>> channels;
+        for (size_t c = 0; c < num_channels; ++c) {
+            const std::vector<float> &band0 = signals[c * num_bands];
+            channels.emplace_back(band0.begin() + begin, band0.begin() + end);
+        }
+        return channels;
+    };
+    const size_t length = total_frames * kFrameSize;
+    const size_t band_rate = NoiseSuppressor::kBandRateHz;
+    printf("\n%-24s %14s %14s %14s %14s\n", "variant", "start_segsnr",
+           "start_noise_db", "rest_segsnr", "rest_noise_db");
+    for (size_t k = 0; k < outputs.size(); ++k) {
+        EngineResult start;
+        EngineResult rest;
+        ComputeObjectiveDeltas(segment(bands, 0, split),
+                               segment(outputs[k], 0, split), band_rate,
+                               &start);
+        ComputeObjectiveDeltas(segment(bands, split, length),
+                               segment(outputs[k], split, length), band_rate,
+                               &rest);
+        printf("%-24s %14.2f %14.2f %14.2f %14.2f\n", names[k],
+               start.seg_snr_db, start.noise_attenuation_db, rest.seg_snr_db,
+               rest.noise_attenuation_db);
+    }
+    return 0;
+}
+
+// Compares the split-band suppressor with the full-band suppressor on the
+// file at 48 kHz. The split-band time includes the band-split filters, which
+// the full-band suppressor does without. Prints the per-frame cost, the
+// algorithmic delay and the delay measured on the output, which includes the
+// band-split filters, and the objective deltas of each output.
+int BenchFullBand(const AudioFileFlt &af, int repeats)
+{
+    constexpr size_t kRate = 48000;
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t samples = sample_rate / 100;
+    const size_t total_frames = af.getNumSamplesPerChannel() / samples;
+
+    auto run = [&](auto *ns, bool split, std::vector<std::vector<float>> *out) {
+        AudioBuffer ab(sample_rate, num_channels, kRate, num_channels,
+                       sample_rate, num_channels);
+        VAFrameFlt frame(sample_rate);
+        frame.buf.assign(num_channels, std::vector<float>(samples));
+        out->assign(num_channels, std::vector<float>());
+        BenchResult result;
+        for (size_t i = 0; i < total_frames; ++i) {
+            for (size_t c = 0; c < num_channels; ++c) {
+                memcpy(frame.buf[c].data(), &af.samples[c][samples * i],
+                       samples * sizeof(float));
+            }
+            ab.CopyFrom(&frame);
+            const double start = NowSeconds();
+            const uint64_t start_cycles = ReadCycles();
+            if (split) {
+                ab.SplitIntoFrequencyBands();
+            }
+            ns->Analyze(ab);
+            ns->Process(&ab);
+            if (split) {
+                ab.MergeFrequencyBands();
+            }
+            result.cycles += ReadCycles() - start_cycles;
+            result.seconds += NowSeconds() - start;
+            ab.CopyTo(&frame);
+            for (size_t c = 0; c < num_channels; ++c) {
+                (*out)[c].insert((*out)[c].end(), frame.buf[c].begin(),
+                                 frame.buf[c].end());
+            }
+        }
+        result.num_frames = total_frames;
+        return result;
+    };
+
+    std::vector<std::vector<float>> input(num_channels);
+    for (size_t c = 0; c < num_channels; ++c) {
+        input[c].assign(af.samples[c].begin(),
+                        af.samples[c].begin() + total_frames * samples);
+    }
+    auto print = [&](const char *name, double delay_ms,
+                     const BenchResult &result,
+                     const std::vector<std::vector<float>> &output) {
+        EngineResult deltas;
+        ComputeObjectiveDeltas(input, output, sample_rate, &deltas);
+        const size_t measured_delay =
+            EstimateDelay(input[0], output[0], sample_rate);
+        printf("%-12s %10.2f %12.0f %10.1f %10.2f %12.2f %10.2f %10.2f "
+               "%10.2f %10.2f\n",
+               name, 1e6 * result.seconds / result.num_frames,
+               static_cast<double>(result.cycles) / result.num_frames,
+               result.num_frames * 0.01 / result.seconds, delay_ms,
+               1000.0 * measured_delay / sample_rate, deltas.seg_snr_db,
+               deltas.attenuation_db, deltas.noise_attenuation_db,
+               LogKurtosisRatio(input, output, measured_delay));
+    };
+
+    BenchResult split_result;
+    BenchResult full_result;
+    std::vector<std::vector<float>> split_out;
+    std::vector<std::vector<float>> full_out;
+    for (int r = 0; r < repeats; ++r) {
+        NoiseSuppressor split_ns(BenchConfig(), kRate, num_channels);
+        const BenchResult split = run(&split_ns, true, &split_out);
+        FullBandNoiseSuppressor full_ns(BenchConfig(), kRate, num_channels);
+        const BenchResult full = run(&full_ns, false, &full_out);
+        split_result.seconds += split.seconds;
+        split_result.cycles += split.cycles;
+        split_result.num_frames += split.num_frames;
+        full_result.seconds += full.seconds;
+        full_result.cycles += full.cycles;
+        full_result.num_frames += full.num_frames;
+    }
+
+    printf("%-12s %10s %12s %10s %10s %12s %10s %10s %10s %10s\n", "variant",
+           "us/frame", "cycles/frame", "xRT", "delay_ms", "measured_ms",
+           "segSNR_dB", "atten_dB", "noise_dB", "musical");
+    print("split-band", AlgorithmicDelayMs<NoiseSuppressor>(), split_result,
+          split_out);
+    print("full-band", AlgorithmicDelayMs<FullBandNoiseSuppressor>(),
+          full_result, full_out);
+    return 0;
+}
+
+class SilenceResamplerCallback : public SincResamplerCallback {
+public:
+    void Run(size_t frames, float *destination) override
+    {
+        memset(destination, 0, frames * sizeof(float));
+    }
+};
+
+// Compares one PushSincResampler per channel with one
+// MultiChannelPushSincResampler for 2 to 16 channels of noise, resampling
+// 10 ms frames from 48 to 16 kHz.
+// Prints the construction time with the kernel already cached, the time to
+// compute a kernel, as on a cache miss or in SetRatio(), and the time per
+// frame.
+int BenchResampler(int repeats)
+{
+    constexpr size_t kSourceFrames = 480;
+    constexpr size_t kDestinationFrames = 160;
+    constexpr size_t kNumFrames = 1000;
+    constexpr int kNumConstructions = 1000;
+
+    SilenceResamplerCallback silence;
+    SincResampler sinc(3.0, SincResampler::kDefaultRequestSize, &silence);
+    double kernel_seconds = NowSeconds();
+    for (int k = 0; k < kNumConstructions; ++k) {
+        // A new ratio every time, so that each kernel is computed.
+        sinc.SetRatio(3.0 + 1e-6 * (k + 1));
+    }
+    kernel_seconds = (NowSeconds() - kernel_seconds) / kNumConstructions;
+    printf("kernel computation (cache miss or SetRatio): %.2f us\n\n",
+           1e6 * kernel_seconds);
+
+    printf("%-10s %-14s %16s %14s\n", "channels", "variant", "construct_us",
+           "us/frame");
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> noise(-1.f, 1.f);
+    for (size_t num_channels : {2, 4, 8, 16}) {
+        ChannelBuffer<float> input(kSourceFrames * kNumFrames, num_channels);
+        for (size_t c = 0; c < num_channels; ++c) {
+            std::generate(input.channels()[c],
+                          input.channels()[c] + kSourceFrames * kNumFrames,
+                          [&] { return noise(rng); });
+        }
+        ChannelBuffer<float> output(kDestinationFrames, num_channels);
+
+        // Separate resamplers.
+        double construct = NowSeconds();
+        for (int k = 0; k < kNumConstructions; ++k) {
+            std::vector<std::unique_ptr<PushSincResampler>> resamplers;
+            for (size_t c = 0; c < num_channels; ++c) {
+                resamplers.emplace_back(
+                    new PushSincResampler(kSourceFrames, kDestinationFrames));
+            }
+        }
+        construct = (NowSeconds() - construct) / kNumConstructions;
+        double process = 0.0;
+        for (int r = 0; r < repeats; ++r) {
+            std::vector<std::unique_ptr<PushSincResampler>> resamplers;
+            for (size_t c = 0; c < num_channels; ++c) {
+                resamplers.emplace_back(
+                    new PushSincResampler(kSourceFrames, kDestinationFrames));
+            }
+            const double start = NowSeconds();
+            for (size_t i = 0; i < kNumFrames; ++i) {
+                for (size_t c = 0; c < num_channels; ++c) {
+                    resamplers[c]->Resample(
+                        input.channels()[c] + i * kSourceFrames,
+                        kSourceFrames, output.channels()[c],
+                        kDestinationFrames);
+                }
+            }
+            process += NowSeconds() - start;
+        }
+        printf("%-10zu %-14s %16.2f %14.2f\n", num_channels, "per channel",
+               1e6 * construct, 1e6 * process / (repeats * kNumFrames));
+
+        // One multichannel resampler.
+        construct = NowSeconds();
+        for (int k = 0; k < kNumConstructions; ++k) {
+            MultiChannelPushSincResampler resampler(
+                kSourceFrames, kDestinationFrames, num_channels);
+        }
+        construct = (NowSeconds() - construct) / kNumConstructions;
+        process = 0.0;
+        std::vector<const float *> frame(num_channels);
+        for (int r = 0; r < repeats; ++r) {
+            MultiChannelPushSincResampler resampler(
+                kSourceFrames, kDestinationFrames, num_channels);
+            const double start = NowSeconds();
+            for (size_t i = 0; i < kNumFrames; ++i) {
+                for (size_t c = 0; c < num_channels; ++c) {
+                    frame[c] = input.channels()[c] + i * kSourceFrames;
+                }
+                resampler.Resample(frame, kSourceFrames,
+                                   rtc::ArrayView<float *const>(
+                                       output.channels(), num_channels),
+                                   kDestinationFrames);
+            }
+            process += NowSeconds() - start;
+        }
+        printf("%-10zu %-14s %16.2f %14.2f\n", num_channels, "multichannel",
+               1e6 * construct, 1e6 * process / (repeats * kNumFrames));
+    }
+    return 0;
+}
+
+// Compares PushSincResampler, one per channel, MultiChannelPushSincResampler
+// and PolyphaseResampler at the integer rate ratios of AudioBuffer.
+int BenchPolyphase(int repeats)
+{
+    struct Rates {
+        int source_hz;
+        int destination_hz;
+    };
+    const Rates kRates[] = {
+        {48000, 16000}, {32000, 16000}, {16000, 48000}, {16000, 32000}};
+    constexpr size_t kNumFrames = 1000;
+
+    printf("%-16s %-10s %14s %14s %14s %10s\n", "rates", "channels",
+           "push_sinc_us", "multi_sinc_us", "polyphase_us", "speedup");
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> noise(-32768.f, 32767.f);
+    for (const Rates &rates : kRates) {
+        const size_t source_frames = rates.source_hz / 100;
+        const size_t destination_frames = rates.destination_hz / 100;
+        for (size_t num_channels : {1, 2, 8}) {
+            ChannelBuffer<float> input(source_frames * kNumFrames,
+                                       num_channels);
+            for (size_t c = 0; c < num_channels; ++c) {
+                std::generate(input.channels()[c],
+                              input.channels()[c] +
+                                  source_frames * kNumFrames,
+                              [&] { return noise(rng); });
+            }
+            ChannelBuffer<float> output(destination_frames, num_channels);
+            std::vector<const float *> frame(num_channels);
+            auto run = [&](MultiChannelPushResampler *resampler) {
+                const double start = NowSeconds();
+                for (size_t i = 0; i < kNumFrames; ++i) {
+                    for (size_t c = 0; c < num_channels; ++c) {
+                        frame[c] = input.channels()[c] + i * source_frames;
+                    }
+                    resampler->Resample(frame, source_frames,
+                                        rtc::ArrayView<float *const>(
+                                            output.channels(), num_channels),
+                                        destination_frames);
+                }
+                return NowSeconds() - start;
+            };
+
+            double push_sinc = 0.0;
+            double multi_sinc = 0.0;
+            double polyphase = 0.0;
+            for (int r = 0; r < repeats; ++r) {
+                std::vector<std::unique_ptr<PushSincResampler>> resamplers;
+                for (size_t c = 0; c < num_channels; ++c) {
+                    resamplers.emplace_back(new PushSincResampler(
+                        source_frames, destination_frames));
+                }
+                const double start = NowSeconds();
+                for (size_t i = 0; i < kNumFrames; ++i) {
+                    for (size_t c = 0; c < num_channels; ++c) {
+                        resamplers[c]->Resample(
+                            input.channels()[c] + i * source_frames,
+                            source_frames, output.channels()[c],
+                            destination_frames);
+                    }
+                }
+                push_sinc += NowSeconds() - start;
+
+                MultiChannelPushSincResampler multichannel(
+                    source_frames, destination_frames, num_channels);
+                multi_sinc += run(&multichannel);
+                PolyphaseResampler polyphase_resampler(
+                    source_frames, destination_frames, num_channels);
+                polyphase += run(&polyphase_resampler);
+            }
+            char name[32];
+            snprintf(name, sizeof(name), "%dk->%dk", rates.source_hz / 1000,
+                     rates.destination_hz / 1000);
+            const double scale = 1e6 / (repeats * kNumFrames);
+            printf("%-16s %-10zu %14.2f %14.2f %14.2f %9.2fx\n", name,
+                   num_channels, scale * push_sinc, scale * multi_sinc,
+                   scale * polyphase, push_sinc / polyphase);
+        }
+    }
+    return 0;
+}
+
+// Prints the memory used by suppressors of several layouts, rates and channel
+// counts, in total and per channel, with the share of the feature histograms.
+int BenchMemory()
+{
+    printf("%-24s %12s %14s %16s\n", "variant", "bytes", "bytes/channel",
+           "histogram bytes");
+    auto row = [](const char *name, size_t bytes, size_t num_channels) {
+        printf("%-24s %12zu %14zu %16zu\n", name, bytes, bytes / num_channels,
+               num_channels * sizeof(Histograms));
+    };
+    row("10 ms 16 kHz mono",
+        NoiseSuppressor(BenchConfig(), 16000, 1).MemoryUsage(), 1);
+    row("10 ms 48 kHz stereo",
+        NoiseSuppressor(BenchConfig(), 48000, 2).MemoryUsage(), 2);
+    row("10 ms 16 kHz 32 ch",
+        NoiseSuppressor(BenchConfig(), 16000, 32).MemoryUsage(), 32);
+    row("5 ms 16 kHz mono",
+        LowLatencyNoiseSuppressor(BenchConfig(), 16000, 1).MemoryUsage(), 1);
+    row("full-band 48 kHz mono",
+        FullBandNoiseSuppressor(BenchConfig(), 48000, 1).MemoryUsage(), 1);
+    printf("int bins would take %zu histogram bytes per channel\n",
+           3 * kHistogramSize * sizeof(int));
+    return 0;
+}
+
+// Compares the complexity levels of NsConfig: the time per frame, the real
+// time factor, which is the number of streams that one core can run, and the
+// quality, both absolute and as the error relative to the output at kFull.
+int BenchComplexity(const AudioFileFlt &af, int repeats)
+{
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    const size_t samples = sample_rate / 100;
+    const size_t total_frames = af.getNumSamplesPerChannel() / samples;
+    const struct {
+        const char *name;
+        NsConfig::Complexity complexity;
+    } kLevels[] = {{"full", NsConfig::Complexity::kFull},
+                   {"medium", NsConfig::Complexity::kMedium},
+                   {"low", NsConfig::Complexity::kLow}};
+
+    // RunSuppressor stores the output frame by frame; split it per channel.
+    auto split_channels = [&](const std::vector<float> &output) {
+        std::vector<std::vector<float>> channels(num_channels);
+        for (size_t i = 0; i < total_frames; ++i) {
+            for (size_t c = 0; c < num_channels; ++c) {
+                const float *frame =
+                    &output[(i * num_channels + c) * samples];
+                channels[c].insert(channels[c].end(), frame,
+                                   frame + samples);
+            }
+        }
+        return channels;
+    };
+    std::vector<std::vector<float>> input(num_channels);
+    for (size_t c = 0; c < num_channels; ++c) {
+        input[c].assign(af.samples[c].begin(),
+                        af.samples[c].begin() + total_frames * samples);
+    }
+
+    printf("%-10s %12s %10s %10s %12s %12s %14s\n", "level", "us/frame",
+           "xRT", "speedup", "seg_snr_db", "noise_db", "vs_full_db");
+    double full_seconds = 0.0;
+    std::vector<float> full_output;
+    for (const auto &level : kLevels) {
+        NsConfig cfg = BenchConfig();
+        cfg.complexity = level.complexity;
+        std::unique_ptr<NoiseSuppressor> ns =
+            NoiseSuppressor::Create(cfg, sample_rate, num_channels);
+        std::vector<float> output;
+        const BenchResult result =
+            RunSuppressor(ns.get(), af, 10, repeats, &output);
+        if (level.complexity == NsConfig::Complexity::kFull) {
+            full_seconds = result.seconds;
+            full_output = output;
+        }
+
+        double error_energy = 0.0;
+        double energy = 0.0;
+        for (size_t n = 0; n < output.size(); ++n) {
+            const double diff = output[n] - full_output[n];
+            error_energy += diff * diff;
+            energy += full_output[n] * full_output[n];
+        }
+        EngineResult quality;
+        ComputeObjectiveDeltas(input, split_channels(output), sample_rate,
+                               &quality);
+        const double audio_seconds = result.num_frames / 100.0;
+        printf("%-10s %12.2f %10.1f %9.2fx %12.2f %12.2f %14.1f\n",
+               level.name, 1e6 * result.seconds / result.num_frames,
+               audio_seconds / result.seconds, full_seconds / result.seconds,
+               quality.seg_snr_db, quality.noise_attenuation_db,
+               error_energy > 0.0 ? 10.0 * log10(error_energy / energy)
+                                  : -INFINITY);
+    }
+    return 0;
+}
+
+// Prints the time and the hardware events per frame of each processing stage:
+// the FFT and inverse FFT, the estimators, the Wiener filter and gains, the
+// band-split filter banks, the resamplers and the whole frame. The stages run
+// on the samples of the file chunked to the frame size of each stage.
+int BenchStages(const AudioFileFlt &af, int repeats)
+{
+    using Fft = NrFft<Ns10msLayout>;
+    constexpr size_t kFftSize = NoiseSuppressor::kFftSize;
+    constexpr size_t kFrameSize = NoiseSuppressor::kNsFrameSize;
+    constexpr size_t kBins = NoiseSuppressor::kFftSizeBy2Plus1;
+    const size_t sample_rate = af.getSampleRate();
+    const size_t num_channels = af.getNumChannels();
+    // Enough samples for the largest frames, 441 at 44.1 kHz and 480 at
+    // 48 kHz.
+    const size_t total_frames = af.getNumSamplesPerChannel() / 480;
+    const std::array<float, kFftSize> window =
+        NoiseSuppressor::FilterBankWindow();
+
+    PerfCounters counters;
+    std::vector<const float *> frame(num_channels);
+    auto load_frame = [&](size_t frame_size, size_t i) {
+        for (size_t c = 0; c < num_channels; ++c) {
+            frame[c] = af.samples[c].data() + i * frame_size;
+        }
+        return frame.data();
+    };
+
+    PerfRegion fft_region;
+    PerfRegion estimator_region;
+    PerfRegion filter_region;
+    PerfRegion split3_region;
+    PerfRegion split2_region;
+    PerfRegion polyphase_region;
+    PerfRegion sinc_region;
+    PerfRegion full_region;
+    for (int r = 0; r < repeats; ++r) {
+        NoiseSuppressor ns(BenchConfig(), 16000, num_channels);
+        Fft fft;
+        std::vector<std::array<float, kFftSize>> real(num_channels);
+        std::vector<std::array<float, kFftSize>> imag(num_channels);
+        std::vector<float *> real_ptrs(num_channels);
+        std::vector<float *> imag_ptrs(num_channels);
+        for (size_t c = 0; c < num_channels; ++c) {
+            real_ptrs[c] = real[c].data();
+            imag_ptrs[c] = imag[c].data();
+        }
+        std::array<float, kFftSize> extended_frame;
+        std::array<float, kFftSize> time_frame;
+        std::array<float, kBins> gains;
+        for (size_t i = 0; i < total_frames; ++i) {
+            const float *const *x = load_frame(kFrameSize, i);
+            counters.Start();
+            for (size_t c = 0; c < num_channels; ++c) {
+                for (size_t k = 0; k < kFftSize; ++k) {
+                    extended_frame[k] = x[c][k] * window[k];
+                }
+                fft.Fft(extended_frame, real[c], imag[c]);
+                fft.Ifft(real[c], imag[c], time_frame);
+            }
+            counters.Stop(&fft_region);
+
+            counters.Start();
+            ns.AnalyzeSpectrum(
+                rtc::ArrayView<const float *const>(real_ptrs.data(),
+                                                   num_channels),
+                rtc::ArrayView<const float *const>(imag_ptrs.data(),
+                                                   num_channels));
+            counters.Stop(&estimator_region);
+
+            counters.Start();
+            ns.ProcessSpectrum(real_ptrs, imag_ptrs, gains);
+            counters.Stop(&filter_region);
+        }
+
+        AudioBuffer ab48(48000, num_channels, 48000, num_channels, 48000,
+                         num_channels);
+        AudioBuffer ab32(32000, num_channels, 32000, num_channels, 32000,
+                         num_channels);
+        for (size_t i = 0; i < total_frames; ++i) {
+            ab48.CopyFrom(load_frame(480, i));
+            counters.Start();
+            ab48.SplitIntoFrequencyBands();
+            ab48.MergeFrequencyBands();
+            counters.Stop(&split3_region);
+
+            ab32.CopyFrom(load_frame(320, i));
+            counters.Start();
+            ab32.SplitIntoFrequencyBands();
+            ab32.MergeFrequencyBands();
+            counters.Stop(&split2_region);
+        }
+
+        PolyphaseResampler polyphase(480, 160, num_channels);
+        MultiChannelPushSincResampler sinc(441, 160, num_channels);
+        ChannelBuffer<float> resampled(160, num_channels);
+        const rtc::ArrayView<float *const> output(resampled.channels(),
+                                                  num_channels);
+        for (size_t i = 0; i < total_frames; ++i) {
+            load_frame(480, i);
+            counters.Start();
+            polyphase.Resample(frame, 480, output, 160);
+            counters.Stop(&polyphase_region);
+
+            load_frame(441, i);
+            counters.Start();
+            sinc.Resample(frame, 441, output, 160);
+            counters.Stop(&sinc_region);
+        }
+
+        const size_t samples = sample_rate / 100;
+        AudioBuffer ab(sample_rate, num_channels, sample_rate, num_channels,
+                       sample_rate, num_channels);
+        NoiseSuppressor full(BenchConfig(), sample_rate, num_channels);
+        ChannelBuffer<float> out(samples, num_channels);
+        for (size_t i = 0; i < total_frames; ++i) {
+            const float *const *in = load_frame(samples, i);
+            counters.Start();
+            ab.CopyFrom(in);
+            if (ab.num_bands() > 1) {
+                ab.SplitIntoFrequencyBands();
+            }
+            full.Analyze(ab);
+            full.Process(&ab);
+            if (ab.num_bands() > 1) {
+                ab.MergeFrequencyBands();
+            }
+            ab.CopyTo(out.channels());
+            counters.Stop(&full_region);
+        }
+    }
+
+    printf("%-22s %10s %10s %10s %6s %10s %10s %10s\n", "stage", "us/frame",
+           "cycles", "instr", "IPC", "L1D_miss", "LLC_miss", "br_miss");
+    auto print_count = [&](const PerfRegion &region, PerfEvent event) {
+        if (counters.available(event)) {
+            printf(" %10.0f",
+                   static_cast<double>(region.counts[event]) /
+                       region.num_runs);
+        } else {
+            printf(" %10s", "-");
+        }
+    };
+    auto row = [&](const char *name, const PerfRegion &region) {
+        printf("%-22s %10.2f", name, 1e6 * region.seconds / region.num_runs);
+        print_count(region, kPerfCycles);
+        print_count(region, kPerfInstructions);
+        if (counters.available(kPerfCycles) &&
+            counters.available(kPerfInstructions) &&
+            region.counts[kPerfCycles] > 0) {
+            printf(" %6.2f", static_cast<double>(
+                                 region.counts[kPerfInstructions]) /
+                                 region.counts[kPerfCycles]);
+        } else {
+            printf(" %6s", "-");
+        }
+        print_count(region, kPerfL1dMisses);
+        print_count(region, kPerfLlcMisses);
+        print_count(region, kPerfBranchMisses);
+        printf("\n");
+    };
+    row("fft+ifft", fft_region);
+    row("estimators", estimator_region);
+    row("wiener filter", filter_region);
+    row("3-band filter bank", split3_region);
+    row("2-band filter bank", split2_region);
+    row("polyphase 48k->16k", polyphase_region);
+    row("sinc 44.1k->16k", sinc_region);
+    char name[32];
+    snprintf(name, sizeof(name), "full frame %zu kHz", sample_rate / 1000);
+    row(name, full_region);
+    if (!counters.status().empty()) {
+        printf("perf counters: %s\n", counters.status().c_str());
+    }
+    return 0;
+}
+
+void PrintUsage(const char *name)
+{
+    printf("Usage: %s <mode> [wav file] [repeats]\n", name);
+    printf("       %s engines [wav file pattern] [repeats]\n", name);
+    printf("       %s equivalence [wav file pattern] [long-run frames]\n",
+           name);
+    printf("       %s memory\n", name);
+    printf("       %s resampler [repeats]\n", name);
+    printf("       %s polyphase [repeats]\n", name);
+    printf("Modes:\n");
+    printf("  layouts   10 ms vs 5 ms frame layouts, with algorithmic delay\n");
+    printf("  special   generic vs channel/band specialized processing\n");
+    printf("  stream    streaming front end at several chunk sizes\n");
+    printf("  rates     16 kHz vs 48 kHz processing rate, with resampling\n");
+    printf("  bypass    with and without bypass of silent and noise-free "
+           "frames\n");
+    printf("  threads   32 and 64 channel arrays, serial vs on a thread pool\n");
+    printf("  scheduler streams an NsScheduler runs without deadline misses\n");
+    printf("  ring      frame handoff between threads, NsFrameRing vs mutex\n");
+    printf("  rtcheck   allocations and locks in the per-frame processing\n");
+    printf("  legacy    legacy float suppressor, C vs SSE2 functions\n");
+    printf("  spectrum  time-domain vs spectral-domain suppressor entry points\n");
+    printf("  fullband  split-band vs full-band 48 kHz processing\n");
+    printf("  block     per-frame calls vs ProcessBlock on blocks of frames\n");
+    printf("  twopass   causal vs two-pass offline processing, with quality\n");
+    printf("  engines   new vs legacy suppressor at every level, as CSV\n");
+    printf("  equivalence  optimized kernels and pipeline vs references\n");
+    printf("  memory    memory used per suppressor and per channel\n");
+    printf("  resampler per-channel vs multichannel sinc resampling\n");
+    printf("  polyphase sinc vs polyphase resampling at integer ratios\n");
+    printf("  silence   per-frame cost in a minute of silence vs the file\n");
+    printf("  stages    time and hardware events per frame of each stage\n");
+    printf("  complexity  cost and quality of the NsConfig complexity levels\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    const std::string mode = argv[1];
+    char defaultFileIn[] = "../assets/audio_with_noise_16k_stereo.wav";
+    const char *fileIn = argc >= 3 ? argv[2] : defaultFileIn;
+    const int repeats = argc >= 4 ? atoi(argv[3]) : 5;
+
+    if (mode == "engines") {
+        return BenchEngines(argc >= 3 ? argv[2] : "../assets/*.wav", repeats);
+    }
+    if (mode == "equivalence") {
+        const size_t long_run_frames =
+            argc >= 4 ? strtoul(argv[3], nullptr, 10) : 1 << 20;
+        return RunEquivalenceChecks(argc >= 3 ? argv[2] : "../assets/*.wav",
+                                    long_run_frames)
+                   ? 0
+                   : 1;
+    }
+
+    if (mode == "memory") {
+        return BenchMemory();
+    }
+    if (mode == "resampler") {
+        return BenchResampler(argc >= 3 ? atoi(argv[2]) : 5);
+    }
+    if (mode == "polyphase") {
+        return BenchPolyphase(argc >= 3 ? atoi(argv[2]) : 5);
+    }
+
+    AudioFileFlt af;
+    if (!af.load(fileIn)) {
+        printf("Could not load %s\n", fileIn);
+        return 1;
+    }
+    printf("In file name: %s (%u Hz, %d channels)\n", fileIn,
+           af.getSampleRate(), af.getNumChannels());
+
+    if (mode == "layouts") {
+        return BenchLayouts(af, repeats);
+    }
+    if (mode == "special") {
+        return BenchSpecializations(af, repeats);
+    }
+    if (mode == "stream") {
+        return BenchStream(af, repeats);
+    }
+    if (mode == "rates") {
+        return BenchRates(af, repeats);
+    }
+    if (mode == "bypass") {
+        return BenchBypass(af, repeats);
+    }
+    if (mode == "threads") {
+        return BenchThreads(af, repeats);
+    }
+    if (mode == "scheduler") {
+        return BenchScheduler(af, repeats);
+    }
+    if (mode == "ring") {
+        return BenchRing(af, repeats);
+    }
+    if (mode == "rtcheck") {
+        return BenchRtCheck(af, repeats);
+    }
+    if (mode == "legacy") {
+        return BenchLegacySimd(af, repeats);
+    }
+    if (mode == "spectrum") {
+        return BenchSpectrum(af, repeats);
+    }
+    if (mode == "fullband") {
+        return BenchFullBand(af, repeats);
+    }
+    if (mode == "block") {
+        return BenchBlock(af, repeats);
+    }
+    if (mode == "twopass") {
+        return BenchTwoPass(af, repeats);
+    }
+    if (mode == "silence") {
+        return BenchSilence(af);
+    }
+    if (mode == "stages") {
+        return BenchStages(af, repeats);
+    }
+    if (mode == "complexity") {
+        return BenchComplexity(af, repeats);
+    }
+
+    PrintUsage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,213 @@
+// Hardware event counters for the benchmarks.
+
+#include "perf_counters.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+double NowSeconds()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(__linux__)
+struct EventConfig {
+    uint32_t type;
+    uint64_t config;
+};
+
+EventConfig ConfigOf(PerfEvent event)
+{
+    switch (event) {
+    case kPerfCycles:
+        return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+    case kPerfInstructions:
+        return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+    case kPerfL1dMisses:
+        return {PERF_TYPE_HW_CACHE,
+                PERF_COUNT_HW_CACHE_L1D |
+                    (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+    case kPerfLlcMisses:
+        return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+    case kPerfBranchMisses:
+    default:
+        return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+    }
+}
+
+int OpenEvent(PerfEvent event, int group_fd)
+{
+    const EventConfig config = ConfigOf(event);
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = config.type;
+    attr.config = config.config;
+    attr.disabled = group_fd < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(
+        syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+#endif
+
+}  // namespace
+
+PerfCounters::PerfCounters()
+{
+    fds_.fill(-1);
+    group_index_.fill(0);
+#if defined(__linux__)
+    std::string failed;
+    int first_errno = 0;
+    for (int e = 0; e < kNumPerfEvents; ++e) {
+        const PerfEvent event = static_cast<PerfEvent>(e);
+        const int fd = OpenEvent(event, leader_fd_);
+        if (fd < 0) {
+            first_errno = first_errno ? first_errno : errno;
+            failed += failed.empty() ? "" : ", ";
+            failed += EventName(event);
+            continue;
+        }
+        if (leader_fd_ < 0) {
+            leader_fd_ = fd;
+        }
+        fds_[e] = fd;
+        group_index_[e] = num_open_++;
+    }
+    if (!failed.empty()) {
+        status_ = "not counted: " + failed + " (" + strerror(first_errno) +
+                  (first_errno == EACCES || first_errno == EPERM
+                       ? ", see /proc/sys/kernel/perf_event_paranoid"
+                       : "") +
+                  ")";
+    }
+    if (leader_fd_ < 0) {
+        return;
+    }
+    ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    // Some hypervisors accept the events but never schedule them on a
+    // counter; treat that as no counters at all.
+    PerfRegion probe;
+    Start();
+    volatile uint64_t sink = 0;
+    for (int i = 0; i < 100000; ++i) {
+        sink = sink + i;
+    }
+    Stop(&probe);
+    if (probe.counts[kPerfCycles] == 0 && probe.counts[kPerfInstructions] == 0) {
+        for (int &fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        leader_fd_ = -1;
+        num_open_ = 0;
+        status_ = "counters open but do not count (no PMU access)";
+        return;
+    }
+
+    std::array<uint64_t, kNumPerfEvents> overhead;
+    overhead.fill(UINT64_MAX);
+    for (int i = 0; i < 100; ++i) {
+        PerfRegion empty;
+        Start();
+        Stop(&empty);
+        for (int e = 0; e < kNumPerfEvents; ++e) {
+            overhead[e] = std::min(overhead[e], empty.counts[e]);
+        }
+    }
+    overhead_ = overhead;
+#else
+    status_ = "hardware counters are only read on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+bool PerfCounters::Read(std::array<uint64_t, kNumPerfEvents> *values)
+{
+    values->fill(0);
+#if defined(__linux__)
+    if (leader_fd_ < 0) {
+        return false;
+    }
+    // nr, time_enabled, time_running, then one value per event.
+    uint64_t buffer[3 + kNumPerfEvents];
+    const ssize_t size = read(leader_fd_, buffer, sizeof(buffer));
+    if (size < static_cast<ssize_t>((3 + num_open_) * sizeof(uint64_t)) ||
+        buffer[2] == 0) {
+        return false;
+    }
+    for (int e = 0; e < kNumPerfEvents; ++e) {
+        if (fds_[e] >= 0) {
+            (*values)[e] = buffer[3 + group_index_[e]];
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PerfCounters::Start()
+{
+    Read(&start_counts_);
+    start_seconds_ = NowSeconds();
+}
+
+void PerfCounters::Stop(PerfRegion *region)
+{
+    const double seconds = NowSeconds() - start_seconds_;
+    std::array<uint64_t, kNumPerfEvents> counts;
+    Read(&counts);
+    region->seconds += seconds;
+    for (int e = 0; e < kNumPerfEvents; ++e) {
+        const uint64_t count = counts[e] - start_counts_[e];
+        region->counts[e] += count > overhead_[e] ? count - overhead_[e] : 0;
+    }
+    ++region->num_runs;
+}
+
+const char *PerfCounters::EventName(PerfEvent event)
+{
+    switch (event) {
+    case kPerfCycles:
+        return "cycles";
+    case kPerfInstructions:
+        return "instructions";
+    case kPerfL1dMisses:
+        return "L1D misses";
+    case kPerfLlcMisses:
+        return "LLC misses";
+    case kPerfBranchMisses:
+        return "branch misses";
+    default:
+        return "";
+    }
+}
@@ -0,0 +1,77 @@
+// Hardware event counters for the benchmarks.
+//
+// On Linux, PerfCounters opens cycles, instructions, L1D read misses, last
+// level cache misses and branch misses of the calling thread with
+// perf_event_open(), as one group so that they count over the same
+// intervals. Only user-space events are counted, so the system calls that
+// read the counters at the region boundaries are not part of the counts.
+// Events that cannot be opened are left out. Where none can be opened, e.g.
+// in a container that forbids perf_event_open() or on a virtual machine
+// without a virtual PMU, the counters report why and only the wall clock
+// time of the regions is measured.
+
+#ifndef NS_BENCH_PERF_COUNTERS_H_
+#define NS_BENCH_PERF_COUNTERS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <string>
+
+enum PerfEvent {
+    kPerfCycles,
+    kPerfInstructions,
+    kPerfL1dMisses,
+    kPerfLlcMisses,
+    kPerfBranchMisses,
+    kNumPerfEvents
+};
+
+// Accumulated measurements of a region over one or more Start()/Stop() pairs.
+struct PerfRegion {
+    double seconds = 0.0;
+    std::array<uint64_t, kNumPerfEvents> counts{};
+    size_t num_runs = 0;
+};
+
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // Whether |event| is counted.
+    bool available(PerfEvent event) const { return fds_[event] >= 0; }
+    bool any_available() const { return num_open_ > 0; }
+
+    // Why some or all events are not counted; empty if all are.
+    const std::string &status() const { return status_; }
+
+    // Measures a region: the time and the events between Start() and Stop()
+    // are added to |region|. Regions do not nest. The counts of an empty
+    // region, the user-space part of reading the counters, are subtracted so
+    // that regions as short as one FFT can be measured.
+    void Start();
+    void Stop(PerfRegion *region);
+
+    static const char *EventName(PerfEvent event);
+
+private:
+    // Reads the current value of every open event into |values|.
+    bool Read(std::array<uint64_t, kNumPerfEvents> *values);
+
+    std::array<int, kNumPerfEvents> fds_;
+    // Position of each open event in the group read.
+    std::array<size_t, kNumPerfEvents> group_index_;
+    int leader_fd_ = -1;
+    size_t num_open_ = 0;
+    std::string status_;
+
+    std::array<uint64_t, kNumPerfEvents> overhead_{};
+    std::array<uint64_t, kNumPerfEvents> start_counts_{};
+    double start_seconds_ = 0.0;
+};
+
+#endif  // NS_BENCH_PERF_COUNTERS_H_
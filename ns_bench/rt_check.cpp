@@ -0,0 +1,140 @@
+// Allocator and mutex wrappers for the real-time safety checks.
+
+#include "rt_check.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t num, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+}
+
+namespace {
+
+// Plain thread locals of the executable need no allocation to access, so the
+// wrappers can use them.
+thread_local bool t_active = false;
+thread_local size_t t_allocations = 0;
+thread_local size_t t_allocated_bytes = 0;
+thread_local size_t t_frees = 0;
+thread_local size_t t_locks = 0;
+
+using MutexLockFunction = int (*)(pthread_mutex_t *);
+
+MutexLockFunction RealMutexLock()
+{
+    static MutexLockFunction real = reinterpret_cast<MutexLockFunction>(
+        dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+    return real;
+}
+
+inline void CountAllocation(size_t size)
+{
+    if (t_active) {
+        ++t_allocations;
+        t_allocated_bytes += size;
+    }
+}
+
+}  // namespace
+
+RtGuard::RtGuard()
+{
+    // Resolve the real lock function before counting starts.
+    RealMutexLock();
+    t_allocations = 0;
+    t_allocated_bytes = 0;
+    t_frees = 0;
+    t_locks = 0;
+    t_active = true;
+}
+
+RtGuard::~RtGuard()
+{
+    t_active = false;
+}
+
+RtViolations RtGuard::violations() const
+{
+    RtViolations v;
+    v.allocations = t_allocations;
+    v.allocated_bytes = t_allocated_bytes;
+    v.frees = t_frees;
+    v.locks = t_locks;
+    return v;
+}
+
+// ThreadSanitizer intercepts the same functions, so its builds keep the
+// C library ones and count nothing.
+#if !defined(__SANITIZE_THREAD__)
+extern "C" {
+
+void *malloc(size_t size)
+{
+    CountAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t num, size_t size)
+{
+    CountAllocation(num * size);
+    return __libc_calloc(num, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    CountAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    CountAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    CountAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    CountAllocation(size);
+    if (alignment % sizeof(void *) != 0 ||
+        (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void *p = __libc_memalign(alignment, size);
+    if (!p && size != 0) {
+        return ENOMEM;
+    }
+    *ptr = p;
+    return 0;
+}
+
+void free(void *ptr)
+{
+    if (t_active && ptr) {
+        ++t_frees;
+    }
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+    if (t_active) {
+        ++t_locks;
+    }
+    return RealMutexLock()(mutex);
+}
+
+}  // extern "C"
+#endif  // !defined(__SANITIZE_THREAD__)
@@ -0,0 +1,40 @@
+// Real-time safety checks for the benchmarks.
+//
+// The benchmark binary replaces the C allocator and pthread_mutex_lock() with
+// wrappers that forward to the C library. While an RtGuard is alive, the
+// wrappers count the calls made on its thread, so that a processing loop can
+// check that it neither allocates nor takes a lock, or so that the memory an
+// object allocates at construction can be measured. operator new and delete
+// are covered through malloc() and free(). System calls are not intercepted.
+// ThreadSanitizer builds (make tsan) leave the wrappers out, so nothing is
+// counted there.
+
+#ifndef NS_BENCH_RT_CHECK_H_
+#define NS_BENCH_RT_CHECK_H_
+
+#include <stddef.h>
+
+struct RtViolations {
+    size_t allocations = 0;
+    size_t frees = 0;
+    size_t locks = 0;
+    // Bytes requested by the allocations.
+    size_t allocated_bytes = 0;
+
+    bool any() const { return allocations + frees + locks > 0; }
+};
+
+// Counts the allocations, frees and mutex locks of the current thread during
+// its lifetime. Guards do not nest.
+class RtGuard {
+public:
+    RtGuard();
+    ~RtGuard();
+    RtGuard(const RtGuard &) = delete;
+    RtGuard &operator=(const RtGuard &) = delete;
+
+    // Calls counted so far.
+    RtViolations violations() const;
+};
+
+#endif  // NS_BENCH_RT_CHECK_H_
@@ -2,7 +2,8 @@
 
 #include <vector>
 #include <iostream>
-#include "modules/audio_processing/ns/noise_suppressor.h"
+#include <string>
+#include "modules/audio_processing/ns/noise_suppressor_for_rate.h"
 #include "AudioFile/AudioFile.h"
 #include "VAFrame/VAFrame.h"
 
@@ -13,27 +14,33 @@ using namespace webrtc;
 #define MIN(A, B)        ((A) < (B) ? (A) : (B))
 #endif
 
-using NSupressor = std::shared_ptr<NoiseSuppressor>;
+using NSupressor = std::shared_ptr<NoiseSuppressorForRate>;
 
-vector<vector<float>> nsProcess(NSupressor nsHandle, AudioFileFlt *audio_file, float gain)
+// processing_rate is the rate the suppressor runs at; the audio is resampled
+// to it and back when it differs from the file rate, in chunks of
+// NsChunkSizeMs(): 10 ms, or 20 and 40 ms at 22.05 and 11.025 kHz.
+vector<vector<float>> nsProcess(NSupressor nsHandle, AudioFileFlt *audio_file,
+                                int processing_rate, float gain)
 {
     int channelNum = audio_file->getNumChannels();
 	vector<vector<float>> output(channelNum);
 
 	int sample_rate = audio_file->getSampleRate();
 	int total_samples = audio_file->getNumSamplesPerChannel();
+    const int chunk_size_ms = NsChunkSizeMs(sample_rate);
 
     AudioBuffer ab(audio_file->getSampleRate(),
                    audio_file->getNumChannels(),
-                   audio_file->getSampleRate(),
+                   processing_rate,
                    audio_file->getNumChannels(),
                    audio_file->getSampleRate(),
-                   audio_file->getNumChannels()
+                   audio_file->getNumChannels(),
+                   chunk_size_ms
             );
 
 	//	load noise suppression module
-    // 每个Frame大小为10ms数据，与AudioBuffer保持一致
-	const int samples = sample_rate / 100;
+    // 每个Frame大小为chunk_size_ms数据，与AudioBuffer保持一致
+	const int samples = sample_rate * chunk_size_ms / 1000;
 	int total_frames = (total_samples / samples);			// 处理的帧数
 
 	for (int i = 0; i < total_frames; i++) {
@@ -52,16 +59,7 @@ vector<vector<float>> nsProcess(NSupressor nsHandle, AudioFileFlt *audio_file, f
             }
 		}
         ab.CopyFrom(&input_buffer);
-        if (ab.num_bands() > 1) {
-            ab.SplitIntoFrequencyBands();
-        }
-
-        nsHandle->Analyze(ab);
-        nsHandle->Process(&ab);
-
-        if (ab.num_bands() > 1) {
-            ab.MergeFrequencyBands();
-        }
+        nsHandle->ProcessChunk(&ab);
         ab.CopyTo(&output_buffer);
         for (int c = 0; c < channelNum; c++) {
             for (int i = 0; i < samples; i++) {
@@ -85,6 +83,10 @@ int main(int argc, char **argv)
     if (argc >= 3) {
         fileOut = argv[2];
     }
+    NsConfig cfg;
+    if (argc >= 4 && std::string(argv[3]) == "48k") {
+        cfg.processing_rate = NsConfig::ProcessingRate::k48kHz;
+    }
 
 	AudioFile<float> af;
     printf("In file name: %s\n", fileIn);
@@ -92,11 +94,14 @@ int main(int argc, char **argv)
     af.printSummary();
 
     NSupressor ns;
-    NsConfig cfg;
     cfg.target_level = NsConfig::SuppressionLevel::k18dB;
-    ns = std::make_unique<NoiseSuppressor>(cfg, af.getSampleRate(), af.getNumChannels());
-    // auto res = nsProcess(ns, &af, 4); // +6dB
-    auto res = nsProcess(ns, &af, 1); // +0dB
+    ns = std::make_shared<NoiseSuppressorForRate>(cfg, af.getSampleRate(),
+                                                  af.getNumChannels());
+    const int processing_rate = ns->processing_rate_hz();
+    printf("Processing rate: %d Hz%s\n", processing_rate,
+           ns->full_band() ? ", full band" : "");
+    // auto res = nsProcess(ns, &af, processing_rate, 4); // +6dB
+    auto res = nsProcess(ns, &af, processing_rate, 1); // +0dB
 
 	af.setAudioBuffer(res);
 	af.save(fileOut);